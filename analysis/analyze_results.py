@@ -6,15 +6,27 @@ import matplotlib.pyplot as plt
 import seaborn as sns
 from pathlib import Path
 import re
+import json
 from typing import Dict, List, Tuple
+from trace_reader import load_trace
+
+CRYPTO_STAGES = ['sign', 'verify', 'replay_check']
+SCALING_METRICS = [('wall_seconds', 'Wall Time (s)'), ('peak_rss_kb', 'Peak RSS (kB)'),
+                   ('events_per_sec', 'Events per Second'), ('crypto_ops_per_sec', 'Crypto Operations per Second')]
+SUPERLINEAR_EXPONENT = 1.2  # wall time growing faster than vehicles^1.2 is flagged
 
 class VanetAnalyzer:
-    def __init__(self, trace_file: str):
+    def __init__(self, trace_file: str, latency_dir: str = None):
         self.trace_file = Path(trace_file)
+        self.security_events = pd.DataFrame()
         self.data = self._load_trace_file()
+        self.latencies = self._load_latencies(Path(latency_dir)) if latency_dir else pd.DataFrame()
         
     def _load_trace_file(self) -> pd.DataFrame:
-        """Load and parse NS-3 trace file."""
+        """Load the binary trace, or an NS-3 ASCII trace given a .tr file."""
+        if self.trace_file.suffix != '.tr':
+            return self._load_binary_trace()
+        
         columns = ['event', 'time', 'node', 'x', 'y', 'z', 'packet_type', 'size', 'flags']
         data = []
         
@@ -36,6 +48,55 @@ class VanetAnalyzer:
         
         return pd.DataFrame(data)
     
+    def _load_binary_trace(self) -> pd.DataFrame:
+        """Map the routing layer's binary trace onto the ASCII trace columns."""
+        trace = load_trace(self.trace_file)
+        packets = trace[trace['event'].isin(['send', 'receive'])]
+        self.security_events = trace[trace['event'].isin(['reject', 'alert'])]
+        return pd.DataFrame({
+            'event': packets['event'].map({'send': 't', 'receive': 'r'}).astype(str),
+            'time': packets['time'],
+            'node': packets['node'].astype(int),
+            'x': packets['x'].astype(float),
+            'y': packets['y'].astype(float),
+            'z': 0.0,
+            'packet_type': packets['type'].astype(str),
+            'size': packets['size'].astype(int),
+            'flags': '',
+        })
+    
+    def _load_latencies(self, latency_dir: Path) -> pd.DataFrame:
+        """Load the per-vehicle stage latency histograms written by the scenario."""
+        frames = [pd.read_csv(f) for f in sorted(latency_dir.glob('*.csv'))]
+        frames = [f for f in frames if not f.empty]
+        if not frames:
+            return pd.DataFrame(columns=['node', 'stage', 'low_ns', 'high_ns', 'count'])
+        return pd.concat(frames, ignore_index=True)
+    
+    def calculate_latency_cdfs(self) -> Dict[str, Tuple[np.ndarray, np.ndarray]]:
+        """Merge all vehicles' histograms and return (latency in us, CDF) per stage."""
+        cdfs = {}
+        if self.latencies.empty:
+            return cdfs
+        
+        merged = self.latencies.groupby(['stage', 'high_ns'], as_index=False)['count'].sum()
+        for stage, buckets in merged.groupby('stage'):
+            buckets = buckets.sort_values('high_ns')
+            counts = buckets['count'].to_numpy(dtype=float)
+            cdfs[stage] = (buckets['high_ns'].to_numpy() / 1e3, np.cumsum(counts) / counts.sum())
+        return cdfs
+    
+    def calculate_latency_percentiles(self) -> Dict[str, Dict[str, float]]:
+        """Call count and p50/p99/p99.9 latency in microseconds per stage."""
+        percentiles = {}
+        calls = self.latencies.groupby('stage')['count'].sum() if not self.latencies.empty else {}
+        for stage, (latency_us, cdf) in self.calculate_latency_cdfs().items():
+            row = {'calls': int(calls[stage])}
+            for name, q in (('p50', 0.5), ('p99', 0.99), ('p999', 0.999)):
+                row[name] = float(latency_us[min(np.searchsorted(cdf, q), len(cdf) - 1)])
+            percentiles[stage] = row
+        return percentiles
+    
     def calculate_end_to_end_delay(self) -> Dict[str, float]:
         """Calculate average end-to-end delay for different packet types."""
         delays = {}
@@ -153,6 +214,32 @@ class VanetAnalyzer:
             plt.tight_layout()
             plt.savefig(output_dir / 'attack_effectiveness.png')
             plt.close()
+        
+        # Plot crypto latency CDFs next to packet delivery ratio
+        cdfs = self.calculate_latency_cdfs()
+        if cdfs:
+            fig, (ax_pdr, ax_crypto, ax_routing) = plt.subplots(1, 3, figsize=(18, 6))
+            ax_pdr.bar(pdrs.keys(), pdrs.values())
+            ax_pdr.set_title('Packet Delivery Ratio by Packet Type')
+            ax_pdr.set_xlabel('Packet Type')
+            ax_pdr.set_ylabel('PDR')
+            ax_pdr.tick_params(axis='x', rotation=45)
+            
+            for ax, title, crypto in ((ax_crypto, 'Crypto Latency CDF', True),
+                                      (ax_routing, 'Routing Stage Latency CDF', False)):
+                for stage, (latency_us, cdf) in cdfs.items():
+                    if (stage in CRYPTO_STAGES) == crypto:
+                        ax.step(latency_us, cdf, where='post', label=stage)
+                ax.set_xscale('log')
+                ax.set_title(title)
+                ax.set_xlabel('Latency (microseconds)')
+                ax.set_ylabel('CDF')
+                ax.grid(True, which='both', alpha=0.3)
+                ax.legend()
+            
+            plt.tight_layout()
+            plt.savefig(output_dir / 'crypto_latency_cdf.png')
+            plt.close()
     
     def generate_report(self, output_file: str):
         """Generate a comprehensive analysis report."""
@@ -160,6 +247,7 @@ class VanetAnalyzer:
         pdrs = self.calculate_packet_delivery_ratio()
         overhead = self.calculate_overhead()
         attacks = self.analyze_attack_effectiveness()
+        latencies = self.calculate_latency_percentiles()
         
         with open(output_file, 'w') as f:
             f.write("VANET Secure Routing Protocol Analysis Report\n")
@@ -197,18 +285,107 @@ class VanetAnalyzer:
             f.write(f"Total communication overhead: {sum(overhead.values()):,} bytes\n")
             if attacks:
                 f.write(f"Average attack detection rate: {np.mean(list(attacks.values())):.2%}\n")
+            
+            if latencies:
+                f.write("\n6. Stage Latencies (microseconds)\n")
+                f.write("--------------------------------\n")
+                for stage, row in latencies.items():
+                    f.write(f"{stage}: {row['calls']:,} calls, p50 {row['p50']:.1f}, "
+                            f"p99 {row['p99']:.1f}, p99.9 {row['p999']:.1f}\n")
+            
+            if not self.security_events.empty:
+                f.write("\n7. Rejections and Alerts\n")
+                f.write("------------------------\n")
+                counts = self.security_events.groupby(['event', 'reason'], observed=True).size()
+                for (event, reason), count in counts.items():
+                    f.write(f"{event} {reason}: {count:,}\n")
+
+def load_scaling_results(path: str) -> pd.DataFrame:
+    """Load a vanet_sweep CSV or JSON file; repeats of a point are reduced to their median."""
+    path = Path(path)
+    if path.suffix == '.json':
+        with open(path) as f:
+            runs = pd.DataFrame(json.load(f)['runs'])
+    else:
+        runs = pd.read_csv(path, dtype={'beacon_rate': str, 'status': str})
+    runs = runs[runs['status'] == 'ok']
+    return runs.groupby(['malicious_ratio', 'beacon_rate', 'vehicles'], as_index=False).median(numeric_only=True)
+
+def calculate_scaling_exponents(runs: pd.DataFrame, metric: str = 'wall_seconds') -> Dict[Tuple[float, str], Dict[str, float]]:
+    """Log-log slope of a metric against vehicle count per (malicious ratio, beacon rate) series.
+    
+    1 is linear growth. 'overall' fits the whole series, 'steepest' is the
+    largest slope between neighboring vehicle counts, where a blowup shows first.
+    """
+    exponents = {}
+    for (ratio, rate), series in runs.groupby(['malicious_ratio', 'beacon_rate']):
+        series = series[(series['vehicles'] > 0) & (series[metric] > 0)].sort_values('vehicles')
+        if len(series) < 2:
+            continue
+        x = np.log(series['vehicles'].to_numpy(dtype=float))
+        y = np.log(series[metric].to_numpy(dtype=float))
+        exponents[(ratio, rate)] = {
+            'overall': float(np.polyfit(x, y, 1)[0]),
+            'steepest': float(np.max(np.diff(y) / np.diff(x))),
+            'max_vehicles': int(series['vehicles'].max()),
+        }
+    return exponents
+
+def plot_scaling(runs: pd.DataFrame, output_dir: str):
+    """Plot each sweep metric against vehicle count on log-log axes, one line per series."""
+    output_dir = Path(output_dir)
+    output_dir.mkdir(parents=True, exist_ok=True)
+    
+    fig, axes = plt.subplots(2, 2, figsize=(14, 10))
+    for ax, (metric, title) in zip(axes.flat, SCALING_METRICS):
+        for (ratio, rate), series in runs.groupby(['malicious_ratio', 'beacon_rate']):
+            series = series.sort_values('vehicles')
+            label = f"{ratio:.0%} malicious, {rate}{'' if rate == 'adaptive' else ' Hz'} beacons"
+            ax.plot(series['vehicles'], series[metric], marker='o', label=label)
+        ax.set_xscale('log')
+        ax.set_yscale('log')
+        ax.set_title(title)
+        ax.set_xlabel('Vehicles')
+        ax.grid(True, which='both', alpha=0.3)
+    axes.flat[0].legend()
+    
+    plt.tight_layout()
+    plt.savefig(output_dir / 'scaling_curves.png')
+    plt.close()
+
+def write_scaling_report(runs: pd.DataFrame, output_file: str, append: bool = False):
+    """Write per-series scaling exponents, flagging super-linear wall time growth."""
+    with open(output_file, 'a' if append else 'w') as f:
+        f.write("\n8. Scaling\n" if append else "VANET Scenario Scaling Report\n")
+        f.write("----------\n" if append else "=============================\n\n")
+        for metric in ('wall_seconds', 'peak_rss_kb'):
+            for (ratio, rate), exponent in calculate_scaling_exponents(runs, metric).items():
+                flag = ''
+                if metric == 'wall_seconds' and exponent['steepest'] > SUPERLINEAR_EXPONENT:
+                    flag = '  SUPER-LINEAR'
+                f.write(f"{metric} {ratio:.0%} malicious, {rate} beacons: exponent {exponent['overall']:.2f}, "
+                        f"steepest {exponent['steepest']:.2f} up to {exponent['max_vehicles']:,} vehicles{flag}\n")
 
 def main():
     import argparse
     parser = argparse.ArgumentParser(description='Analyze VANET simulation results')
-    parser.add_argument('trace_file', help='Path to NS-3 trace file')
+    parser.add_argument('trace_file', nargs='?', help='Binary trace prefix or segment, or an NS-3 ASCII .tr file')
     parser.add_argument('--output-dir', default='results', help='Output directory for plots')
     parser.add_argument('--report-file', default='results/report.txt', help='Output file for analysis report')
+    parser.add_argument('--latency-dir', help='Directory of per-vehicle stage latency CSVs')
+    parser.add_argument('--scaling-file', help='CSV or JSON results of a vanet_sweep run')
     args = parser.parse_args()
+    if not args.trace_file and not args.scaling_file:
+        parser.error('a trace file, --scaling-file or both are required')
     
-    analyzer = VanetAnalyzer(args.trace_file)
-    analyzer.plot_results(args.output_dir)
-    analyzer.generate_report(args.report_file)
+    if args.trace_file:
+        analyzer = VanetAnalyzer(args.trace_file, args.latency_dir)
+        analyzer.plot_results(args.output_dir)
+        analyzer.generate_report(args.report_file)
+    if args.scaling_file:
+        runs = load_scaling_results(args.scaling_file)
+        plot_scaling(runs, args.output_dir)
+        write_scaling_report(runs, args.report_file, append=bool(args.trace_file))
 
 if __name__ == '__main__':
     main() 
\ No newline at end of file
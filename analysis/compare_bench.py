@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import sys
+from pathlib import Path
+from typing import Dict
+
+def load_results(path: Path) -> Dict[str, float]:
+    """Map benchmark name to CPU time in ns, preferring the median aggregate."""
+    with open(path) as f:
+        report = json.load(f)
+
+    units = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+    results = {}
+    for bench in report.get('benchmarks', []):
+        if bench.get('error_occurred'):
+            continue
+        name = bench.get('run_name', bench['name'])
+        aggregate = bench.get('aggregate_name')
+        if aggregate not in (None, 'median'):
+            continue
+        if aggregate is None and name in results:
+            continue
+        results[name] = bench['cpu_time'] * units.get(bench.get('time_unit', 'ns'), 1.0)
+    return results
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two vanet_bench JSON reports')
+    parser.add_argument('baseline', help='JSON report of the reference build')
+    parser.add_argument('candidate', help='JSON report of the build under test')
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help='Relative slowdown reported as a regression (default 0.10)')
+    args = parser.parse_args()
+
+    baseline = load_results(Path(args.baseline))
+    candidate = load_results(Path(args.candidate))
+
+    regressions = 0
+    print(f"{'benchmark':<48} {'baseline':>14} {'candidate':>14} {'change':>9}")
+    for name in sorted(baseline.keys() | candidate.keys()):
+        if name not in baseline or name not in candidate:
+            side = 'candidate' if name in baseline else 'baseline'
+            print(f"{name:<48} {'missing in ' + side:>39}")
+            continue
+        change = candidate[name] / baseline[name] - 1.0
+        marker = ''
+        if change > args.threshold:
+            marker = '  REGRESSION'
+            regressions += 1
+        print(f"{name:<48} {baseline[name]:>12.1f}ns {candidate[name]:>12.1f}ns "
+              f"{change:>+8.1%}{marker}")
+
+    if regressions:
+        print(f"\n{regressions} benchmark(s) slower by more than {args.threshold:.0%}")
+        sys.exit(1)
+
+if __name__ == '__main__':
+    main()
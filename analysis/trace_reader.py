@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Reader for the binary packet traces written by vanet::routing::TraceSink.
+
+Each segment file holds a 64-byte header followed by one column per field
+(see src/routing/trace-sink.h). Columns are mapped straight into numpy
+arrays, so loading a trace does no per-record parsing.
+"""
+
+from pathlib import Path
+from typing import List, Union
+
+import numpy as np
+import pandas as pd
+
+MAGIC = 0x43525456  # "VTRC"
+VERSION = 1
+HEADER_SIZE = 64
+
+COLUMNS = [
+    ('time_ns', '<u8'),
+    ('node', '<u4'),
+    ('peer', '<u4'),
+    ('sequence', '<u4'),
+    ('x', '<f4'),
+    ('y', '<f4'),
+    ('size', '<u2'),
+    ('event', 'u1'),
+    ('type', 'u1'),
+    ('reason', 'u1'),
+]
+
+EVENTS = ['send', 'receive', 'reject', 'alert']
+MESSAGE_TYPES = ['hello', 'rreq', 'rrep', 'rerr', 'data']
+REASONS = ['none', 'malformed', 'stale_or_replayed', 'bad_signature',
+           'sybil', 'position_falsification', 'black_hole']
+
+_HEADER = np.dtype([
+    ('magic', '<u4'), ('version', '<u2'), ('columns', '<u2'),
+    ('capacity', '<u4'), ('count', '<u4'), ('index', '<u4'), ('reserved', '<u4'),
+    ('offsets', '<u4', (len(COLUMNS),)),
+])
+
+
+def segment_files(path: Union[str, Path]) -> List[Path]:
+    """Segments of a trace given one .vtr file, a directory or the sink prefix."""
+    path = Path(path)
+    if path.suffix == '.vtr':
+        return [path]
+    if path.is_dir():
+        return sorted(path.glob('*.vtr'))
+    return sorted(path.parent.glob(path.name + '-*.vtr'))
+
+
+def read_segment(path: Union[str, Path]) -> dict:
+    """Columns of one segment as numpy arrays backed by the mapped file."""
+    data = np.memmap(path, dtype=np.uint8, mode='r')
+    header = np.frombuffer(data, dtype=_HEADER, count=1)[0]
+    if header['magic'] != MAGIC or header['version'] != VERSION:
+        raise ValueError(f'{path}: not a version {VERSION} VANET trace segment')
+    if header['columns'] != len(COLUMNS):
+        raise ValueError(f'{path}: expected {len(COLUMNS)} columns, found {header["columns"]}')
+
+    count = int(header['count'])
+    return {name: np.frombuffer(data, dtype=dtype, count=count, offset=int(offset))
+            for (name, dtype), offset in zip(COLUMNS, header['offsets'])}
+
+
+def load_trace(path: Union[str, Path], labels: bool = True) -> pd.DataFrame:
+    """Load every segment of a trace into one DataFrame, ordered by segment.
+
+    With labels, event, type and reason are categorical names instead of
+    their numeric codes, and time is added in seconds.
+    """
+    segments = [read_segment(f) for f in segment_files(path)]
+    if not segments:
+        return pd.DataFrame({name: np.array([], dtype=dtype) for name, dtype in COLUMNS})
+
+    frame = pd.DataFrame({name: np.concatenate([s[name] for s in segments])
+                          for name, _ in COLUMNS})
+    if labels:
+        for column, names in (('event', EVENTS), ('type', MESSAGE_TYPES), ('reason', REASONS)):
+            codes = frame[column].to_numpy()
+            known = codes < len(names)
+            frame[column] = pd.Categorical.from_codes(np.where(known, codes, -1), names)
+        # Alerts are about a node, not a packet
+        frame.loc[frame['event'] == 'alert', 'type'] = np.nan
+        frame['time'] = frame['time_ns'] / 1e9
+    return frame
+
+
+if __name__ == '__main__':
+    import argparse
+    parser = argparse.ArgumentParser(description='Summarize a binary VANET trace')
+    parser.add_argument('trace', help='Segment file, directory or trace prefix (e.g. build/vanet-trace)')
+    args = parser.parse_args()
+
+    trace = load_trace(args.trace)
+    print(f'{len(trace):,} records')
+    if not trace.empty:
+        print(trace.groupby(['event', 'type'], observed=True).size().to_string())
@@ -5,7 +5,7 @@ setlocal enabledelayedexpansion
 echo Building project...
 if not exist build mkdir build
 cd build
-cmake .. -G "Visual Studio 17 2022" -A x64
+cmake .. -G "Visual Studio 17 2022" -A x64 -DVANET_INSTRUMENTATION=ON
 if errorlevel 1 (
     echo Build configuration failed!
     exit /b 1
@@ -19,7 +19,7 @@ if errorlevel 1 (
 
 :: Run simulation scenarios
 echo Running urban scenario simulation...
-Release\urban-scenario.exe --numVehicles=50 --numMalicious=5 --simTime=300
+Release\urban-scenario.exe --numVehicles=50 --numMalicious=5 --simTime=300 --latencyDir=..\results\latency
 if errorlevel 1 (
     echo Simulation failed!
     exit /b 1
@@ -32,9 +32,10 @@ if not exist results mkdir results
 :: Analyze results
 echo Analyzing results...
 python analysis\analyze_results.py ^
-    build\vanet-trace.tr ^
+    build\vanet-trace ^
     --output-dir results ^
-    --report-file results\report.txt
+    --report-file results\report.txt ^
+    --latency-dir results\latency
 if errorlevel 1 (
     echo Analysis failed!
     exit /b 1
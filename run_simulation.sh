@@ -4,7 +4,7 @@
 echo "Building project..."
 mkdir -p build
 cd build
-cmake ..
+cmake .. -DVANET_INSTRUMENTATION=ON
 make -j$(nproc)
 
 if [ $? -ne 0 ]; then
@@ -17,7 +17,8 @@ echo "Running urban scenario simulation..."
 ./waf --run "scenarios/urban-scenario \
     --numVehicles=50 \
     --numMalicious=5 \
-    --simTime=300"
+    --simTime=300 \
+    --latencyDir=../results/latency"
 
 if [ $? -ne 0 ]; then
     echo "Simulation failed!"
@@ -27,13 +28,52 @@ fi
 # Create results directory
 mkdir -p ../results
 
+# Optional MPI strong-scaling sweep (requires ns-3 built with --enable-mpi)
+if [ "${MPI_SCALING:-0}" = "1" ]; then
+    echo "Running distributed scaling sweep..."
+    rm -f ../results/mpi_scaling.csv
+    for ranks in 8 16 32 64; do
+        ./waf --run "scenarios/urban-scenario \
+            --distributed=1 \
+            --numVehicles=10000 \
+            --simTime=60 \
+            --scalingCsv=../results/mpi_scaling.csv" \
+            --command-template="mpirun -np $ranks %s"
+
+        if [ $? -ne 0 ]; then
+            echo "Distributed run with $ranks ranks failed!"
+            exit 1
+        fi
+    done
+fi
+
+# Optional single-process scaling sweep over vehicles, attackers and beacon rates
+SCALING_ARGS=""
+if [ "${SCALING_SWEEP:-0}" = "1" ]; then
+    echo "Running scaling sweep..."
+    ./vanet_sweep \
+        --command='./waf --run "scenarios/urban-scenario {args} --traceFormat=none"' \
+        --vehicles=50,100,200,500,1000,2000,5000 \
+        --malicious=0,0.1,0.2 \
+        --beaconRates=adaptive,10 \
+        --simTime=30 \
+        --output=../results/scaling
+
+    if [ $? -ne 0 ]; then
+        echo "Some scaling runs failed, see results/scaling.csv and results/scaling.log"
+    fi
+    SCALING_ARGS="--scaling-file results/scaling.csv"
+fi
+
 # Analyze results
 echo "Analyzing results..."
 cd ..
 python3 analysis/analyze_results.py \
-    build/vanet-trace.tr \
+    build/vanet-trace \
     --output-dir results \
-    --report-file results/report.txt
+    --report-file results/report.txt \
+    --latency-dir results/latency \
+    $SCALING_ARGS
 
 if [ $? -ne 0 ]; then
     echo "Analysis failed!"
@@ -0,0 +1,318 @@
+// Scaling sweep over the urban scenario. Runs it once per point of a grid
+// of vehicle counts, malicious ratios and beacon rates, and collects wall
+// time, peak RSS, events/s and crypto operations/s of every run into one
+// CSV and one JSON file for analysis/analyze_results.py --scaling-file.
+//
+//   vanet_sweep --command='./waf --run "scenarios/urban-scenario {args}"'
+//       --vehicles=50,100,200,500,1000,2000,5000 --malicious=0,0.1
+//       --beaconRates=adaptive,10 --simTime=30 --output=results/scaling
+//
+// Each run's scenario options and --metricsFile replace {args}, or are
+// appended if the command has none. Scenario output goes to
+// <output>.log. A failed or timed-out run is recorded with its status and
+// the sweep goes on; both files are rewritten after every run.
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct SweepConfig {
+    std::string command = "./urban-scenario {args}";
+    std::vector<uint32_t> vehicles = {50, 100, 200, 500, 1000, 2000, 5000};
+    std::vector<double> malicious = {0.0, 0.1};
+    std::vector<std::string> beaconRates = {"adaptive", "10"};
+    double simTime = 30.0;
+    uint32_t repeats = 1;
+    double timeout = 3600.0;  // seconds per run, 0 for none
+    std::string output = "results/scaling";
+    std::string extraArgs;
+};
+
+struct RunResult {
+    uint32_t vehicles;
+    uint32_t malicious;
+    double maliciousRatio;
+    std::string beaconRate;
+    uint32_t repeat;
+    std::string status;
+    double wallSeconds;
+    uint64_t peakRssKb;
+    std::map<std::string, double> metrics;
+
+    double metric(const std::string& key) const {
+        auto it = metrics.find(key);
+        return it == metrics.end() ? 0.0 : it->second;
+    }
+    double cryptoOps() const {
+        return metric("signatures") + metric("verifications") + metric("session_tags");
+    }
+    double perSecond(double count) const { return wallSeconds > 0 ? count / wallSeconds : 0.0; }
+};
+
+template <typename T>
+bool parseList(const std::string& text, std::vector<T>& out) {
+    out.clear();
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        std::istringstream value(item);
+        T parsed;
+        if (!(value >> parsed) || !value.eof()) {
+            return false;
+        }
+        out.push_back(parsed);
+    }
+    return !out.empty();
+}
+
+bool parseArgs(int argc, char* argv[], SweepConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            std::cerr << "Expected --name=value, got " << arg << std::endl;
+            return false;
+        }
+        std::string name = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+        bool ok = true;
+        if (name == "command") {
+            config.command = value;
+        } else if (name == "vehicles") {
+            ok = parseList(value, config.vehicles);
+        } else if (name == "malicious") {
+            ok = parseList(value, config.malicious);
+        } else if (name == "beaconRates") {
+            ok = parseList(value, config.beaconRates);
+        } else if (name == "simTime") {
+            ok = (std::istringstream(value) >> config.simTime) && config.simTime > 0;
+        } else if (name == "repeats") {
+            ok = (std::istringstream(value) >> config.repeats) && config.repeats > 0;
+        } else if (name == "timeout") {
+            ok = static_cast<bool>(std::istringstream(value) >> config.timeout);
+        } else if (name == "output") {
+            config.output = value;
+        } else if (name == "extraArgs") {
+            config.extraArgs = value;
+        } else {
+            std::cerr << "Unknown option --" << name << std::endl;
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Bad value for --" << name << ": " << value << std::endl;
+            return false;
+        }
+    }
+    for (double ratio : config.malicious) {
+        if (ratio < 0.0 || ratio > 1.0) {
+            std::cerr << "Malicious ratios must be within [0, 1]" << std::endl;
+            return false;
+        }
+    }
+    for (const auto& rate : config.beaconRates) {
+        double hz = 0.0;
+        if (rate != "adaptive" && !((std::istringstream(rate) >> hz) && hz > 0)) {
+            std::cerr << "Beacon rates are Hz or \"adaptive\", got " << rate << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string scenarioArgs(const SweepConfig& config, const RunResult& run, const std::string& metricsFile) {
+    std::ostringstream args;
+    args << "--numVehicles=" << run.vehicles << " --numMalicious=" << run.malicious
+         << " --simTime=" << config.simTime;
+    if (run.beaconRate == "adaptive") {
+        args << " --adaptiveBeacons=true";
+    } else {
+        args << " --adaptiveBeacons=false --beaconRate=" << run.beaconRate;
+    }
+    args << " --metricsFile=" << metricsFile;
+    if (!config.extraArgs.empty()) {
+        args << " " << config.extraArgs;
+    }
+    return args.str();
+}
+
+std::map<std::string, double> readMetrics(const std::string& path) {
+    std::map<std::string, double> metrics;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            metrics[line.substr(0, eq)] = std::atof(line.c_str() + eq + 1);
+        }
+    }
+    return metrics;
+}
+
+// Runs the command through the shell in its own process group, so that a
+// timeout also stops whatever the shell started
+void execute(const SweepConfig& config, const std::string& command, const std::string& logFile,
+             RunResult& run) {
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        run.status = "fork_failed";
+        return;
+    }
+    if (pid == 0) {
+        setpgid(0, 0);
+        int log = open(logFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (log >= 0) {
+            dup2(log, STDOUT_FILENO);
+            dup2(log, STDERR_FILENO);
+            close(log);
+        }
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage{};
+    bool timedOut = false;
+    while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (config.timeout > 0 && elapsed > config.timeout && !timedOut) {
+            kill(-pid, SIGKILL);
+            timedOut = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    // Used when the scenario does not report its own
+    run.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.peakRssKb = static_cast<uint64_t>(usage.ru_maxrss);
+    if (timedOut) {
+        run.status = "timeout";
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        run.status = WIFEXITED(status) ? "exit_" + std::to_string(WEXITSTATUS(status))
+                                       : "signal_" + std::to_string(WTERMSIG(status));
+    } else {
+        run.status = "ok";
+    }
+}
+
+void writeCsv(const std::string& path, const SweepConfig& config, const std::vector<RunResult>& runs) {
+    std::ofstream csv(path);
+    csv << "vehicles,malicious,malicious_ratio,beacon_rate,repeat,status,sim_time,wall_seconds,"
+           "peak_rss_kb,events,events_per_sec,signatures,verifications,session_tags,crypto_ops,"
+           "crypto_ops_per_sec,beacons,beacon_bytes\n";
+    for (const auto& run : runs) {
+        csv << run.vehicles << "," << run.malicious << "," << run.maliciousRatio << "," << run.beaconRate << ","
+            << run.repeat << "," << run.status << "," << config.simTime << "," << run.wallSeconds << ","
+            << run.peakRssKb << "," << run.metric("events") << "," << run.perSecond(run.metric("events")) << ","
+            << run.metric("signatures") << "," << run.metric("verifications") << ","
+            << run.metric("session_tags") << "," << run.cryptoOps() << "," << run.perSecond(run.cryptoOps())
+            << "," << run.metric("beacons") << "," << run.metric("beacon_bytes") << "\n";
+    }
+}
+
+void writeJson(const std::string& path, const SweepConfig& config, const std::vector<RunResult>& runs) {
+    std::ofstream json(path);
+    json << "{\n  \"sim_time\": " << config.simTime << ",\n  \"runs\": [";
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const RunResult& run = runs[i];
+        json << (i ? "," : "") << "\n    {\"vehicles\": " << run.vehicles << ", \"malicious\": " << run.malicious
+             << ", \"malicious_ratio\": " << run.maliciousRatio << ", \"beacon_rate\": \"" << run.beaconRate
+             << "\", \"repeat\": " << run.repeat << ", \"status\": \"" << run.status
+             << "\", \"wall_seconds\": " << run.wallSeconds << ", \"peak_rss_kb\": " << run.peakRssKb
+             << ", \"events\": " << run.metric("events")
+             << ", \"events_per_sec\": " << run.perSecond(run.metric("events"))
+             << ", \"signatures\": " << run.metric("signatures")
+             << ", \"verifications\": " << run.metric("verifications")
+             << ", \"session_tags\": " << run.metric("session_tags")
+             << ", \"crypto_ops\": " << run.cryptoOps()
+             << ", \"crypto_ops_per_sec\": " << run.perSecond(run.cryptoOps())
+             << ", \"beacons\": " << run.metric("beacons")
+             << ", \"beacon_bytes\": " << run.metric("beacon_bytes") << "}";
+    }
+    json << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SweepConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 2;
+    }
+
+    std::filesystem::path parent = std::filesystem::path(config.output).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+    
+    std::vector<RunResult> runs;
+    const std::string metricsFile = config.output + ".metrics";
+    const std::string logFile = config.output + ".log";
+    std::remove(logFile.c_str());
+    size_t total = config.vehicles.size() * config.malicious.size() * config.beaconRates.size() * config.repeats;
+
+    for (uint32_t vehicles : config.vehicles) {
+        for (double ratio : config.malicious) {
+            for (const auto& rate : config.beaconRates) {
+                for (uint32_t repeat = 0; repeat < config.repeats; ++repeat) {
+                    RunResult run{vehicles, static_cast<uint32_t>(std::lround(ratio * vehicles)), ratio, rate,
+                                  repeat, "", 0.0, 0, {}};
+                    std::string args = scenarioArgs(config, run, metricsFile);
+                    std::string command = config.command;
+                    size_t slot = command.find("{args}");
+                    if (slot == std::string::npos) {
+                        command += " " + args;
+                    } else {
+                        command.replace(slot, 6, args);
+                    }
+
+                    std::remove(metricsFile.c_str());
+                    execute(config, command, logFile, run);
+                    run.metrics = readMetrics(metricsFile);
+                    if (run.status == "ok" && run.metrics.empty()) {
+                        run.status = "no_metrics";
+                    }
+                    // The scenario's own figures leave out shell and build tool overhead
+                    if (run.metric("wall_seconds") > 0) {
+                        run.wallSeconds = run.metric("wall_seconds");
+                    }
+                    if (run.metric("peak_rss_kb") > 0) {
+                        run.peakRssKb = static_cast<uint64_t>(run.metric("peak_rss_kb"));
+                    }
+                    runs.push_back(run);
+
+                    std::cout << "[" << runs.size() << "/" << total << "] vehicles=" << vehicles
+                              << " malicious=" << run.malicious << " beacons=" << rate << " " << run.status
+                              << " wall=" << run.wallSeconds << "s rss=" << run.peakRssKb << "kB events/s="
+                              << static_cast<uint64_t>(run.perSecond(run.metric("events"))) << std::endl;
+                    writeCsv(config.output + ".csv", config, runs);
+                    writeJson(config.output + ".json", config, runs);
+                }
+            }
+        }
+    }
+    std::remove(metricsFile.c_str());
+
+    for (const auto& run : runs) {
+        if (run.status != "ok") {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -5,34 +5,187 @@
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/applications-module.h"
 #include "ns3/netanim-module.h"
+#include "../src/crypto/key-provisioning.h"
 #include "../src/routing/secure-routing.h"
+#include "../src/routing/state-codec.h"
+#include "../src/routing/trace-sink.h"
+#include <cmath>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <sys/resource.h>
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
 
 using namespace ns3;
 using namespace vanet;
 
 NS_LOG_COMPONENT_DEFINE("VanetSecureRoutingSimulation");
 
+constexpr double MAP_SIZE = 1000.0;  // meters, square urban area
+constexpr std::chrono::seconds SIM_EPOCH(1767225600);  // simulator time zero, 2026-01-01 UTC
+
+// Simulator time as the protocol clock, so timeouts follow simulated time
+// and runs are reproducible. Protocol instances cache it once per event.
+class SimulatorClock : public crypto::Clock {
+public:
+    TimePoint now() const override {
+        return TimePoint(SIM_EPOCH) + std::chrono::microseconds(Simulator::Now().GetMicroSeconds());
+    }
+};
+
+static const SimulatorClock simulatorClock;
+
+// Applies a comma-separated list of message types (hello, rreq, rrep, rerr,
+// data, or all) to the trace sink's capture filter
+static bool SetTraceTypes(routing::TraceSink& sink, const std::string& list) {
+    static const std::pair<const char*, routing::MessageType> names[] = {
+        {"hello", routing::MessageType::HELLO},
+        {"rreq", routing::MessageType::ROUTE_REQUEST},
+        {"rrep", routing::MessageType::ROUTE_REPLY},
+        {"rerr", routing::MessageType::ROUTE_ERROR},
+        {"data", routing::MessageType::DATA},
+    };
+    
+    sink.captureNone();
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        bool all = item == "all";
+        bool known = all;
+        for (const auto& name : names) {
+            if (all || item == name.first) {
+                sink.capture(name.second, true);
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Fixed-capacity node storage constructed in place. Nodes are never moved
+// or copied, so the addresses handed to the scheduler stay valid for the
+// whole run, and they sit contiguously for the mobility sweep.
+template <typename T>
+class NodePool {
+public:
+    explicit NodePool(size_t capacity) : slots(new Slot[capacity]), capacity(capacity), count(0) {}
+    ~NodePool() {
+        while (count > 0) {
+            data()[--count].~T();
+        }
+    }
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        NS_ABORT_MSG_IF(count == capacity, "Node pool full at " << capacity << " nodes");
+        T* node = new (&slots[count]) T(std::forward<Args>(args)...);
+        ++count;
+        return *node;
+    }
+    
+    size_t size() const { return count; }
+    T& operator[](size_t i) { return data()[i]; }
+    T* begin() { return data(); }
+    T* end() { return data() + count; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + count; }
+    
+private:
+    struct alignas(T) Slot {
+        unsigned char bytes[sizeof(T)];
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    size_t count;
+    
+    T* data() { return std::launder(reinterpret_cast<T*>(slots.get())); }
+    const T* data() const { return std::launder(reinterpret_cast<const T*>(slots.get())); }
+};
+
 class VanetNode {
 public:
-    VanetNode(const std::string& id, Ptr<Node> node)
+    VanetNode(const std::string& id, Ptr<Node> node, crypto::ByteView identity)
         : id(id), node(node), router(id) {
         
+        router.setClock(simulatorClock);
         routing::VehicleInfo info;
         info.id = id;
         Vector pos = node->GetObject<MobilityModel>()->GetPosition();
-        info.position = {pos.x, pos.y, pos.z, 
-                        std::chrono::system_clock::now()};
+        info.position = {pos.x, pos.y, pos.z, simulatorClock.now()};
         
-        router.initializeVehicle(info);
+        router.initializeVehicle(info, identity);
     }
     
     void UpdatePosition() {
         Vector pos = node->GetObject<MobilityModel>()->GetPosition();
-        routing::Position newPos = {
-            pos.x, pos.y, pos.z,
-            std::chrono::system_clock::now()
-        };
+        routing::Position newPos = {pos.x, pos.y, pos.z, simulatorClock.now()};
         router.updatePosition(newPos);
+        router.refillSigningPool();
+    }
+    
+    // Sign on the shared engine; each result is delivered by a simulator
+    // event a fixed delay after submission, so runs stay reproducible
+    void EnableCryptoOffload(crypto::CryptoEngine* engine, Time latency) {
+        router.setCryptoEngine(engine, [engine, latency](uint64_t ticket) {
+            Simulator::Schedule(latency, &crypto::CryptoEngine::deliverThrough, engine, ticket);
+        });
+    }
+    
+    void EnableTrace(routing::TraceSink* sink) {
+        router.setTraceSink(sink);
+    }
+    
+    // Precompute signing nonces up front and top them up after every move;
+    // the first fill touches only this node, so nodes may fill in parallel
+    void EnablePresigning(uint32_t depth) {
+        router.enablePresigning(depth);
+        router.refillSigningPool();
+    }
+    
+    // HMAC-authenticated HELLO and DATA hops between established neighbors
+    void EnableSessions() {
+        router.setSessionMode(true);
+    }
+    
+    crypto::SigningPool::Stats GetSigningPoolStats() const {
+        return router.getSigningPoolStats();
+    }
+    
+    // One mobility tick: move, which also runs the protocol's due timers,
+    // then beacon with the new position if one is due. A zero
+    // beaconInterval leaves the rate to the adaptive controller; otherwise
+    // a full beacon goes out every beaconInterval, rounded to ticks.
+    void Tick(Time now, Time beaconInterval) {
+        UpdatePosition();
+        if (beaconInterval.IsZero()) {
+            router.sendBeaconIfDue();
+        } else if (now >= nextBeacon) {
+            router.sendBeacon();
+            nextBeacon = now + beaconInterval;
+        }
+    }
+    
+    const routing::BeaconStats& GetBeaconStats() const {
+        return router.getBeaconStats();
+    }
+    
+    const crypto::CryptoModule::OperationStats& GetCryptoOperationStats() const {
+        return router.getCryptoOperationStats();
+    }
+    
+    const crypto::CryptoModule::SessionStats& GetSessionStats() const {
+        return router.getSessionStats();
     }
     
     void SendData(const std::string& destId, const std::vector<uint8_t>& data) {
@@ -40,19 +193,419 @@ public:
     }
     
     void ReceiveData(Ptr<Packet> packet) {
-        uint8_t buffer[packet->GetSize()];
-        packet->CopyData(buffer, packet->GetSize());
-        std::vector<uint8_t> data(buffer, buffer + packet->GetSize());
+        // ns-3 packets have no contiguous view of their bytes, so they are
+        // copied once into a buffer that only grows and parsed in place
+        uint32_t size = packet->GetSize();
+        if (rxBuffer.size() < size) {
+            rxBuffer.resize(size);
+        }
+        packet->CopyData(rxBuffer.data(), size);
         
-        router.receiveMessage(data);
+        router.receiveMessage(crypto::ByteView(rxBuffer.data(), size));
+    }
+    
+    // Per-stage latency histogram rows of this vehicle
+    void WriteLatencies(std::ostream& out) const {
+        crypto::Instrumentation::writeCsvHeader(out);
+        router.getInstrumentation().writeCsv(out, id);
     }
     
+    const std::string& GetId() const { return id; }
+    
 private:
     std::string id;
     Ptr<Node> node;
     routing::SecureRoutingProtocol router;
+    std::vector<uint8_t> rxBuffer;
+    Time nextBeacon;
+};
+
+// Moves every vehicle in a single simulator event per tick, sweeping the
+// nodes in storage order, rather than one event per vehicle. The event
+// queue holds one mobility event however many vehicles there are, and each
+// protocol instance only touches the timers and grid cells that are due.
+class MobilityTicker {
+public:
+    MobilityTicker(NodePool<VanetNode>& nodes, Time interval, Time beaconInterval)
+        : nodes(nodes), interval(interval), beaconInterval(beaconInterval), ticks(0) {}
+    
+    void Start(Time at) {
+        Simulator::Schedule(at, &MobilityTicker::Tick, this);
+    }
+    
+    uint64_t GetTicks() const { return ticks; }
+    
+private:
+    NodePool<VanetNode>& nodes;
+    Time interval;
+    Time beaconInterval;
+    uint64_t ticks;
+    
+    void Tick() {
+        Time now = Simulator::Now();
+        for (auto& node : nodes) {
+            node.Tick(now, beaconInterval);
+        }
+        ++ticks;
+        Simulator::Schedule(interval, &MobilityTicker::Tick, this);
+    }
+};
+
+#ifdef NS3_MPI
+// Splits the map into cols x rows rectangular regions, one per MPI rank
+struct RegionPartition {
+    uint32_t cols;
+    uint32_t rows;
+    
+    explicit RegionPartition(uint32_t ranks) {
+        cols = static_cast<uint32_t>(std::sqrt(static_cast<double>(ranks)));
+        while (ranks % cols != 0) {
+            --cols;
+        }
+        rows = ranks / cols;
+    }
+    
+    uint32_t rankOf(double x, double y) const {
+        auto cell = [](double v, uint32_t n) {
+            int64_t i = static_cast<int64_t>(std::floor(v / (MAP_SIZE / n)));
+            return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(i, 0), n - 1));
+        };
+        return cell(y, rows) * cols + cell(x, cols);
+    }
 };
 
+// Random-waypoint motion kept by the scenario rather than an ns-3 mobility
+// model, so a vehicle carries its trajectory with it when it changes rank.
+// Each vehicle has its own generator; runs are identical for any rank count.
+struct VehicleMotion {
+    uint32_t index;
+    double x, y;
+    double wx, wy;
+    double speed;
+    uint64_t rng;
+    
+    double uniform() {
+        rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(rng >> 11) * (1.0 / 9007199254740992.0);
+    }
+    
+    void pickWaypoint() {
+        wx = uniform() * MAP_SIZE;
+        wy = uniform() * MAP_SIZE;
+        speed = 20.0 + uniform() * 30.0;  // m/s, as in the single-process mode
+    }
+    
+    void advance(double dt) {
+        double remaining = speed * dt;
+        while (remaining > 0) {
+            double dist = std::hypot(wx - x, wy - y);
+            if (dist > remaining) {
+                x += (wx - x) * remaining / dist;
+                y += (wy - y) * remaining / dist;
+                return;
+            }
+            x = wx;
+            y = wy;
+            remaining -= dist;
+            pickWaypoint();
+        }
+    }
+    
+    void write(routing::ByteWriter& out) const {
+        out.u32(index);
+        out.f64(x);
+        out.f64(y);
+        out.f64(wx);
+        out.f64(wy);
+        out.f64(speed);
+        out.u64(rng);
+    }
+    
+    void read(routing::ByteReader& in) {
+        index = in.u32();
+        x = in.f64();
+        y = in.f64();
+        wx = in.f64();
+        wy = in.f64();
+        speed = in.f64();
+        rng = in.u64();
+    }
+};
+
+// One MPI rank's share of the map. Every rank runs its own ns-3 simulator
+// over a fixed pool of wifi nodes. At each sync interval all ranks move
+// their vehicles, then hand vehicles that left their region, with the
+// serialized protocol state, to the new owner in one MPI_Alltoallv. The
+// collective is also the barrier that keeps ranks in lock step.
+//
+// ns-3's DistributedSimulatorImpl and NullMessageSimulatorImpl only carry
+// point-to-point links across ranks and fix a node's rank at creation, so
+// they can neither share a wifi channel nor move vehicles between ranks.
+// Radio traffic across a region border is not modeled.
+class RegionRank {
+public:
+    struct Stats {
+        uint64_t migratedIn;
+        uint64_t migratedOut;
+        uint64_t beacons;
+    };
+    
+    RegionRank(uint32_t rank, uint32_t size, uint32_t numVehicles, uint32_t poolSize,
+               Time interval, Time stopTime, uint32_t seed, uint32_t presignDepth, bool sessions,
+               bool adaptiveBeacons)
+        : rank(rank), size(size), partition(size), interval(interval), stopTime(stopTime),
+          presignDepth(presignDepth), sessions(sessions), adaptiveBeacons(adaptiveBeacons), stats{0, 0, 0} {
+        pool.Create(poolSize);
+        
+        YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+        YansWifiPhyHelper phy;
+        phy.SetChannel(channel.Create());
+        WifiMacHelper mac;
+        WifiHelper wifi;
+        wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                    "DataMode", StringValue("OfdmRate6Mbps"),
+                                    "ControlMode", StringValue("OfdmRate6Mbps"));
+        wifi.Install(phy, mac, pool);
+        InternetStackHelper internet;
+        internet.Install(pool);
+        
+        MobilityHelper mobility;
+        mobility.SetMobilityModel("ns3::ConstantVelocityMobilityModel");
+        mobility.Install(pool);
+        for (uint32_t slot = poolSize; slot-- > 0;) {
+            Park(slot);
+            freeSlots.push_back(slot);
+        }
+        
+        // Every rank draws every vehicle's start so ownership is consistent
+        for (uint32_t i = 0; i < numVehicles; ++i) {
+            VehicleMotion motion;
+            motion.index = i;
+            motion.rng = (static_cast<uint64_t>(seed) << 32) ^ (i * 0x9E3779B97F4A7C15ULL);
+            motion.x = motion.uniform() * MAP_SIZE;
+            motion.y = motion.uniform() * MAP_SIZE;
+            motion.pickWaypoint();
+            if (partition.rankOf(motion.x, motion.y) == rank) {
+                Adopt(motion, crypto::ByteView());
+            }
+        }
+    }
+    
+    void Start() {
+        Simulator::Schedule(interval, &RegionRank::Step, this);
+    }
+    
+    size_t VehicleCount() const { return vehicles.size(); }
+    const Stats& GetStats() const { return stats; }
+    
+private:
+    struct Vehicle {
+        VehicleMotion motion;
+        std::unique_ptr<routing::SecureRoutingProtocol> router;
+        uint32_t slot;
+    };
+    
+    uint32_t rank;
+    uint32_t size;
+    RegionPartition partition;
+    Time interval;
+    Time stopTime;
+    uint32_t presignDepth;
+    bool sessions;
+    bool adaptiveBeacons;
+    NodeContainer pool;
+    std::vector<uint32_t> freeSlots;
+    std::vector<Vehicle> vehicles;
+    Stats stats;
+    
+    void Park(uint32_t slot) {
+        // Far outside the map and from every other parked node
+        auto mobility = pool.Get(slot)->GetObject<ConstantVelocityMobilityModel>();
+        mobility->SetPosition(Vector(-1.0e6 - slot * 1.0e3, -1.0e6, 0.0));
+        mobility->SetVelocity(Vector(0.0, 0.0, 0.0));
+    }
+    
+    void Place(const Vehicle& vehicle) {
+        const VehicleMotion& m = vehicle.motion;
+        auto mobility = pool.Get(vehicle.slot)->GetObject<ConstantVelocityMobilityModel>();
+        mobility->SetPosition(Vector(m.x, m.y, 0.0));
+        double dist = std::hypot(m.wx - m.x, m.wy - m.y);
+        double scale = dist > 0 ? m.speed / dist : 0.0;
+        mobility->SetVelocity(Vector((m.wx - m.x) * scale, (m.wy - m.y) * scale, 0.0));
+    }
+    
+    void Adopt(const VehicleMotion& motion, crypto::ByteView state) {
+        NS_ABORT_MSG_IF(freeSlots.empty(), "Rank " << rank << " ran out of pool nodes; raise --poolSlack");
+        
+        Vehicle vehicle;
+        vehicle.motion = motion;
+        vehicle.slot = freeSlots.back();
+        freeSlots.pop_back();
+        
+        std::string id = "vehicle_" + std::to_string(motion.index);
+        vehicle.router = std::make_unique<routing::SecureRoutingProtocol>(id);
+        vehicle.router->setClock(simulatorClock);
+        if (state.empty()) {
+            routing::VehicleInfo info;
+            info.id = id;
+            info.position = {motion.x, motion.y, 0.0, simulatorClock.now()};
+            info.speed = motion.speed;
+            info.direction = 0.0;
+            info.trustScore = 1.0;
+            vehicle.router->initializeVehicle(info);
+        } else {
+            NS_ABORT_MSG_IF(!vehicle.router->importState(state), "Corrupt state for " << id);
+            ++stats.migratedIn;
+        }
+        if (presignDepth > 0) {
+            vehicle.router->enablePresigning(presignDepth);
+            vehicle.router->refillSigningPool();
+        }
+        // Sessions are not migrated; the new rank's neighbors set up their own
+        vehicle.router->setSessionMode(sessions);
+        
+        Place(vehicle);
+        vehicles.push_back(std::move(vehicle));
+    }
+    
+    void Step() {
+        double dt = interval.GetSeconds();
+        std::vector<std::vector<uint8_t>> outgoing(size);
+        
+        for (size_t i = 0; i < vehicles.size();) {
+            Vehicle& vehicle = vehicles[i];
+            vehicle.motion.advance(dt);
+            vehicle.router->updatePosition({vehicle.motion.x, vehicle.motion.y, 0.0, simulatorClock.now()});
+            
+            uint32_t owner = partition.rankOf(vehicle.motion.x, vehicle.motion.y);
+            if (owner == rank) {
+                Place(vehicle);
+                if (!adaptiveBeacons) {
+                    vehicle.router->sendBeacon();
+                    ++stats.beacons;
+                } else if (vehicle.router->sendBeaconIfDue()) {
+                    ++stats.beacons;
+                }
+                ++i;
+                continue;
+            }
+            
+            // Crossed a region border: ship motion and protocol state
+            routing::ByteWriter out(outgoing[owner]);
+            vehicle.motion.write(out);
+            std::vector<uint8_t> state;
+            vehicle.router->exportState(state);
+            out.bytes(state);
+            ++stats.migratedOut;
+            
+            Park(vehicle.slot);
+            freeSlots.push_back(vehicle.slot);
+            vehicles[i] = std::move(vehicles.back());
+            vehicles.pop_back();
+        }
+        
+        Exchange(outgoing);
+        
+        // Idle until the next step: replace the nonces this step's beacons used
+        for (auto& vehicle : vehicles) {
+            vehicle.router->refillSigningPool();
+        }
+        
+        if (Simulator::Now() + interval <= stopTime) {
+            Simulator::Schedule(interval, &RegionRank::Step, this);
+        }
+    }
+    
+    void Exchange(const std::vector<std::vector<uint8_t>>& outgoing) {
+        std::vector<int> sendCounts(size), recvCounts(size), sendOffsets(size), recvOffsets(size);
+        std::vector<uint8_t> sendBuffer;
+        for (uint32_t r = 0; r < size; ++r) {
+            sendOffsets[r] = static_cast<int>(sendBuffer.size());
+            sendCounts[r] = static_cast<int>(outgoing[r].size());
+            sendBuffer.insert(sendBuffer.end(), outgoing[r].begin(), outgoing[r].end());
+        }
+        
+        MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+        int total = 0;
+        for (uint32_t r = 0; r < size; ++r) {
+            recvOffsets[r] = total;
+            total += recvCounts[r];
+        }
+        std::vector<uint8_t> recvBuffer(total);
+        MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendOffsets.data(), MPI_BYTE,
+                      recvBuffer.data(), recvCounts.data(), recvOffsets.data(), MPI_BYTE,
+                      MPI_COMM_WORLD);
+        
+        // Ranks are drained in order so adoption order is deterministic
+        routing::ByteReader in(crypto::ByteView(recvBuffer.data(), recvBuffer.size()));
+        while (!in.atEnd() && in.ok()) {
+            VehicleMotion motion;
+            motion.read(in);
+            crypto::ByteView state = in.bytes();
+            if (in.ok()) {
+                Adopt(motion, state);
+            }
+        }
+    }
+};
+
+// Scaling run: one region per rank; rank 0 reports the slowest rank's wall
+// time, optionally appending a CSV row for run_simulation.sh
+int RunDistributed(uint32_t numVehicles, double simTime, double syncInterval,
+                   double poolSlack, uint32_t seed, uint32_t presignDepth, bool sessions,
+                   bool adaptiveBeacons, const std::string& scalingCsv) {
+    MPI_Init(nullptr, nullptr);
+    int rank = 0;
+    int size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    
+    // Protocol snapshots carry NodeIds, so all ranks intern in the same order
+    for (uint32_t i = 0; i < numVehicles; ++i) {
+        routing::NodeRegistry::instance().intern("vehicle_" + std::to_string(i));
+    }
+    
+    uint32_t perRank = (numVehicles + size - 1) / size;
+    uint32_t poolSize = std::min(numVehicles, static_cast<uint32_t>(perRank * poolSlack) + 32);
+    
+    auto wallStart = std::chrono::steady_clock::now();
+    {
+        RegionRank region(rank, size, numVehicles, poolSize, Seconds(syncInterval), Seconds(simTime), seed,
+                          presignDepth, sessions, adaptiveBeacons);
+        region.Start();
+        Simulator::Stop(Seconds(simTime));
+        Simulator::Run();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        
+        double maxWall = 0.0;
+        uint64_t local[3] = {region.VehicleCount(), region.GetStats().migratedOut, region.GetStats().beacons};
+        uint64_t totals[3] = {0, 0, 0};
+        MPI_Reduce(&wall, &maxWall, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce(local, totals, 3, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+        
+        if (rank == 0) {
+            NS_LOG_INFO("ranks=" << size << " vehicles=" << totals[0] << " migrations=" << totals[1]
+                        << " beacons=" << totals[2] << " wall=" << maxWall << "s");
+            if (!scalingCsv.empty()) {
+                std::ifstream existing(scalingCsv);
+                bool header = !existing.good() || existing.peek() == std::ifstream::traits_type::eof();
+                existing.close();
+                std::ofstream csv(scalingCsv, std::ios::app);
+                if (header) {
+                    csv << "ranks,vehicles,sim_time,wall_seconds,migrations,beacons\n";
+                }
+                csv << size << "," << totals[0] << "," << simTime << "," << maxWall << ","
+                    << totals[1] << "," << totals[2] << "\n";
+            }
+        }
+        Simulator::Destroy();
+    }
+    
+    MPI_Finalize();
+    return 0;
+}
+#endif
+
 int main(int argc, char *argv[]) {
     // Enable logging
     LogComponentEnable("VanetSecureRoutingSimulation", LOG_LEVEL_INFO);
@@ -61,13 +614,68 @@ int main(int argc, char *argv[]) {
     uint32_t numVehicles = 50;
     uint32_t numMalicious = 5;
     double simTime = 300.0; // seconds
+    uint32_t cryptoThreads = crypto::CryptoEngine::defaultWorkerCount();
+    double cryptoLatency = 50.0; // microseconds from submit to delivery
+    bool distributed = false;
+    double syncInterval = 1.0; // seconds between rank exchanges
+    double poolSlack = 3.0;    // pool nodes per rank, relative to an even share
+    uint32_t seed = 1;
+    std::string scalingCsv;
+    std::string latencyDir;
+    std::string traceFormat = "binary";
+    std::string traceTypes = "all";
+    bool animation = false;
+    uint32_t presignDepth = 16;
+    bool sessions = false;
+    bool adaptiveBeacons = true;
+    double beaconRate = 10.0;  // Hz, without adaptive beaconing
+    double tickInterval = 0.1; // seconds between mobility ticks
+    std::string metricsFile;
+    std::string keyFile;
     
     CommandLine cmd;
     cmd.AddValue("numVehicles", "Number of vehicles", numVehicles);
     cmd.AddValue("numMalicious", "Number of malicious nodes", numMalicious);
     cmd.AddValue("simTime", "Simulation time in seconds", simTime);
+    cmd.AddValue("cryptoThreads", "Crypto worker threads (0 signs inline)", cryptoThreads);
+    cmd.AddValue("cryptoLatency", "Simulated crypto latency in microseconds", cryptoLatency);
+    cmd.AddValue("distributed", "Partition the map across MPI ranks", distributed);
+    cmd.AddValue("syncInterval", "Seconds between rank exchanges (distributed)", syncInterval);
+    cmd.AddValue("poolSlack", "Pool nodes per rank relative to an even share (distributed)", poolSlack);
+    cmd.AddValue("seed", "Mobility seed (distributed)", seed);
+    cmd.AddValue("scalingCsv", "Append a scaling row to this CSV (distributed)", scalingCsv);
+    cmd.AddValue("latencyDir", "Write per-vehicle stage latency CSVs here", latencyDir);
+    cmd.AddValue("traceFormat", "Packet trace: binary (vanet-trace-*.vtr), ascii (vanet-trace.tr) or none",
+                 traceFormat);
+    cmd.AddValue("traceTypes", "Message types in the binary trace: all, or a list of hello,rreq,rrep,rerr,data",
+                 traceTypes);
+    cmd.AddValue("animation", "Write a NetAnim trace to vanet-animation.xml", animation);
+    cmd.AddValue("presignDepth", "Precomputed ECDSA nonces per vehicle for inline signing (0 disables)",
+                 presignDepth);
+    cmd.AddValue("sessions", "Authenticate HELLO and DATA hops between established neighbors with HMAC",
+                 sessions);
+    cmd.AddValue("adaptiveBeacons", "Rate beacons by motion and channel load, with delta beacons in between",
+                 adaptiveBeacons);
+    cmd.AddValue("beaconRate", "Beacons per second when not adaptive", beaconRate);
+    cmd.AddValue("tickInterval", "Seconds between position updates of all vehicles", tickInterval);
+    cmd.AddValue("metricsFile", "Write run metrics (wall time, peak RSS, events, crypto operations) here",
+                 metricsFile);
+    cmd.AddValue("keyFile", "Load vehicle keys from this file, or generate them and save them here",
+                 keyFile);
     cmd.Parse(argc, argv);
     
+    if (distributed) {
+        if (syncInterval <= 0) {
+            NS_FATAL_ERROR("--syncInterval must be positive");
+        }
+#ifdef NS3_MPI
+        return RunDistributed(numVehicles, simTime, syncInterval, poolSlack, seed, presignDepth,
+                              sessions, adaptiveBeacons, scalingCsv);
+#else
+        NS_FATAL_ERROR("Distributed mode needs ns-3 built with MPI support");
+#endif
+    }
+    
     // Create nodes
     NodeContainer vehicles;
     vehicles.Create(numVehicles);
@@ -103,18 +711,55 @@ int main(int argc, char *argv[]) {
     
     mobility.Install(vehicles);
     
+    // Keys for the whole fleet, generated on every core unless an earlier
+    // run saved enough of them
+    crypto::FleetKeys fleetKeys;
+    if (keyFile.empty() || !fleetKeys.load(keyFile) || fleetKeys.size() < numVehicles) {
+        if (!fleetKeys.generate(numVehicles, crypto::SignatureAlgorithm::ECDSA)) {
+            NS_FATAL_ERROR("Failed to generate vehicle keys");
+        }
+        if (!keyFile.empty() && !fleetKeys.save(keyFile)) {
+            NS_FATAL_ERROR("Cannot write vehicle keys to " << keyFile);
+        }
+    }
+    
     // Create VANET nodes
-    std::vector<VanetNode> vanetNodes;
+    NodePool<VanetNode> vanetNodes(numVehicles);
     for (uint32_t i = 0; i < numVehicles; ++i) {
-        std::string id = "vehicle_" + std::to_string(i);
-        vanetNodes.emplace_back(id, vehicles.Get(i));
+        vanetNodes.emplace("vehicle_" + std::to_string(i), vehicles.Get(i), fleetKeys.identity(i));
     }
     
-    // Schedule position updates
-    for (uint32_t i = 0; i < numVehicles; ++i) {
-        Simulator::Schedule(Seconds(1.0), &VanetNode::UpdatePosition, &vanetNodes[i]);
+    // Offload signing to worker threads
+    std::unique_ptr<crypto::CryptoEngine> cryptoEngine;
+    if (cryptoThreads > 0) {
+        cryptoEngine = std::make_unique<crypto::CryptoEngine>(cryptoThreads);
+        for (auto& vanetNode : vanetNodes) {
+            vanetNode.EnableCryptoOffload(cryptoEngine.get(), MicroSeconds(cryptoLatency));
+        }
+    } else {
+        if (presignDepth > 0) {
+            crypto::parallelFor(vanetNodes.size(), 0, [&](size_t i) {
+                vanetNodes[i].EnablePresigning(presignDepth);
+            });
+        }
+        for (auto& vanetNode : vanetNodes) {
+            if (sessions) {
+                vanetNode.EnableSessions();
+            }
+        }
     }
     
+    // Position updates and beacons of all vehicles, one event per tick
+    if (!adaptiveBeacons && beaconRate <= 0) {
+        NS_FATAL_ERROR("--beaconRate must be positive without adaptive beaconing");
+    }
+    if (tickInterval <= 0) {
+        NS_FATAL_ERROR("--tickInterval must be positive");
+    }
+    Time beaconInterval = adaptiveBeacons ? Time() : Seconds(1.0 / beaconRate);
+    MobilityTicker ticker(vanetNodes, Seconds(tickInterval), beaconInterval);
+    ticker.Start(Seconds(1.0));
+    
     // Set up malicious nodes
     std::set<uint32_t> maliciousIndices;
     while (maliciousIndices.size() < numMalicious) {
@@ -137,15 +782,106 @@ int main(int argc, char *argv[]) {
     }
     
     // Enable packet tracing
-    AsciiTraceHelper ascii;
-    phy.EnableAsciiAll(ascii.CreateFileStream("vanet-trace.tr"));
+    std::unique_ptr<routing::TraceSink> traceSink;
+    if (traceFormat == "binary") {
+        traceSink = std::make_unique<routing::TraceSink>("vanet-trace");
+        if (!traceSink->ok()) {
+            NS_FATAL_ERROR("Cannot create the vanet-trace segments");
+        }
+        if (!SetTraceTypes(*traceSink, traceTypes)) {
+            NS_FATAL_ERROR("Unknown message type in --traceTypes=" << traceTypes);
+        }
+        for (auto& vanetNode : vanetNodes) {
+            vanetNode.EnableTrace(traceSink.get());
+        }
+    } else if (traceFormat == "ascii") {
+        AsciiTraceHelper ascii;
+        phy.EnableAsciiAll(ascii.CreateFileStream("vanet-trace.tr"));
+    } else if (traceFormat != "none") {
+        NS_FATAL_ERROR("Unknown --traceFormat=" << traceFormat);
+    }
     
-    // Enable animation
-    AnimationInterface anim("vanet-animation.xml");
+    // Enable animation; like the ASCII trace it costs more than the run itself
+    std::unique_ptr<AnimationInterface> anim;
+    if (animation) {
+        anim = std::make_unique<AnimationInterface>("vanet-animation.xml");
+    }
     
     // Run simulation
     Simulator::Stop(Seconds(simTime));
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    if (cryptoEngine) {
+        cryptoEngine->drain();
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    if (traceSink) {
+        traceSink->close();
+        NS_LOG_INFO("Traced " << traceSink->recorded() << " records in " << traceSink->segments() << " segments");
+    }
+    if (!cryptoEngine && presignDepth > 0) {
+        uint64_t precomputed = 0, consumed = 0, misses = 0, refillNanos = 0;
+        for (const auto& vanetNode : vanetNodes) {
+            auto pool = vanetNode.GetSigningPoolStats();
+            precomputed += pool.precomputed;
+            consumed += pool.consumed;
+            misses += pool.misses;
+            refillNanos += pool.refillNanos;
+        }
+        double refillRate = refillNanos ? precomputed * 1e9 / refillNanos : 0.0;
+        NS_LOG_INFO("Signing pool: " << consumed << " signatures presigned, " << misses << " misses, "
+                    << precomputed << " nonces precomputed at " << static_cast<uint64_t>(refillRate) << "/s");
+    }
+    
+    routing::BeaconStats beacons{0, 0, 0, 0, 0, 0};
+    uint64_t signatures = 0, verifications = 0, sessionTags = 0;
+    for (const auto& vanetNode : vanetNodes) {
+        const auto& node = vanetNode.GetBeaconStats();
+        beacons.fullBeacons += node.fullBeacons;
+        beacons.deltaBeacons += node.deltaBeacons;
+        beacons.suppressed += node.suppressed;
+        beacons.bytesSent += node.bytesSent;
+        signatures += vanetNode.GetCryptoOperationStats().signatures;
+        verifications += vanetNode.GetCryptoOperationStats().verifications;
+        const auto& sessionStats = vanetNode.GetSessionStats();
+        sessionTags += sessionStats.tagged + sessionStats.reauthenticated + sessionStats.tagsVerified;
+    }
+    NS_LOG_INFO("Beacons: " << beacons.fullBeacons << " full, " << beacons.deltaBeacons << " delta, "
+                << beacons.suppressed << " checks suppressed, " << beacons.bytesSent << " bytes");
+    
+    // One run of a sweep (scenarios/scaling-sweep.cpp); peak RSS is in kilobytes
+    if (!metricsFile.empty()) {
+        struct rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        std::ofstream out(metricsFile);
+        out << "vehicles=" << numVehicles << "\n"
+            << "malicious=" << numMalicious << "\n"
+            << "sim_time=" << simTime << "\n"
+            << "wall_seconds=" << wall << "\n"
+            << "peak_rss_kb=" << usage.ru_maxrss << "\n"
+            << "events=" << Simulator::GetEventCount() << "\n"
+            << "ticks=" << ticker.GetTicks() << "\n"
+            << "signatures=" << signatures << "\n"
+            << "verifications=" << verifications << "\n"
+            << "session_tags=" << sessionTags << "\n"
+            << "beacons=" << beacons.fullBeacons + beacons.deltaBeacons << "\n"
+            << "beacon_bytes=" << beacons.bytesSent << "\n";
+        if (!out) {
+            NS_FATAL_ERROR("Cannot write --metricsFile=" << metricsFile);
+        }
+    }
+    
+    // One histogram file per vehicle for analysis/analyze_results.py
+    if (!latencyDir.empty()) {
+        if (!crypto::INSTRUMENTATION_ENABLED) {
+            NS_LOG_INFO("Built without VANET_INSTRUMENTATION, latency files will be empty");
+        }
+        std::filesystem::create_directories(latencyDir);
+        for (const auto& vanetNode : vanetNodes) {
+            std::ofstream out(latencyDir + "/" + vanetNode.GetId() + ".csv");
+            vanetNode.WriteLatencies(out);
+        }
+    }
     Simulator::Destroy();
     
     return 0;
@@ -0,0 +1,95 @@
+#ifndef VANET_BYTE_VIEW_H
+#define VANET_BYTE_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace vanet {
+namespace crypto {
+
+// Non-owning view over contiguous bytes. Stands in for std::span<const
+// uint8_t> while the tree builds as C++17; the viewed buffer must outlive it.
+class ByteView {
+public:
+    constexpr ByteView() : ptr(nullptr), len(0) {}
+    constexpr ByteView(const uint8_t* data, size_t size) : ptr(data), len(size) {}
+    template <typename Alloc>
+    ByteView(const std::vector<uint8_t, Alloc>& bytes) : ptr(bytes.data()), len(bytes.size()) {}
+
+    // Raw object representation, as used for timestamp/sequence fields
+    template <typename T>
+    static ByteView of(const T& value) {
+        return ByteView(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+    }
+
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const uint8_t* begin() const { return ptr; }
+    const uint8_t* end() const { return ptr + len; }
+    uint8_t operator[](size_t i) const { return ptr[i]; }
+
+    ByteView subview(size_t offset, size_t count) const {
+        return ByteView(ptr + offset, count);
+    }
+
+    std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(begin(), end()); }
+
+    bool operator==(const ByteView& other) const {
+        return len == other.len && (len == 0 || std::memcmp(ptr, other.ptr, len) == 0);
+    }
+    bool operator!=(const ByteView& other) const { return !(*this == other); }
+    bool operator<(const ByteView& other) const {
+        size_t common = len < other.len ? len : other.len;
+        int cmp = common ? std::memcmp(ptr, other.ptr, common) : 0;
+        return cmp < 0 || (cmp == 0 && len < other.len);
+    }
+
+private:
+    const uint8_t* ptr;
+    size_t len;
+};
+
+// Scatter-gather list of views fed to the digest one segment at a time,
+// so signed input never has to be concatenated into a temporary buffer
+class ByteSegments {
+public:
+    static constexpr size_t MAX_SEGMENTS = 4;
+
+    ByteSegments() : count(0) {}
+    ByteSegments(ByteView a) : ByteSegments() { add(a); }
+    ByteSegments(ByteView a, ByteView b, ByteView c) : ByteSegments() {
+        add(a);
+        add(b);
+        add(c);
+    }
+
+    void add(ByteView segment) {
+        if (count < MAX_SEGMENTS) {
+            segments[count++] = segment;
+        }
+    }
+
+    const ByteView* begin() const { return segments; }
+    const ByteView* end() const { return segments + count; }
+    size_t size() const { return count; }
+
+    size_t totalSize() const {
+        size_t total = 0;
+        for (const auto& segment : *this) {
+            total += segment.size();
+        }
+        return total;
+    }
+
+private:
+    ByteView segments[MAX_SEGMENTS];
+    size_t count;
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_BYTE_VIEW_H
@@ -0,0 +1,21 @@
+#include "clock.h"
+
+namespace vanet {
+namespace crypto {
+
+namespace {
+
+class SystemClock : public Clock {
+public:
+    TimePoint now() const override { return std::chrono::system_clock::now(); }
+};
+
+} // namespace
+
+const Clock& Clock::system() {
+    static const SystemClock clock;
+    return clock;
+}
+
+} // namespace crypto
+} // namespace vanet
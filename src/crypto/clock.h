@@ -0,0 +1,63 @@
+#ifndef VANET_CLOCK_H
+#define VANET_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+namespace vanet {
+namespace crypto {
+
+// Source of "now" for message timestamps, freshness and replay windows,
+// certificate validity and routing timeouts. Modules that are not given a
+// clock use the wall clock; a simulation passes its own so that timeouts
+// follow simulated time, however fast it runs.
+class Clock {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    virtual ~Clock() = default;
+    virtual TimePoint now() const = 0;
+
+    uint64_t nowMillis() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now().time_since_epoch()).count();
+    }
+    time_t nowSeconds() const { return std::chrono::system_clock::to_time_t(now()); }
+
+    static const Clock& system();
+};
+
+// Time set by the owner, e.g. tests stepping through a timeout
+class ManualClock : public Clock {
+public:
+    explicit ManualClock(TimePoint start = TimePoint()) : current(start) {}
+
+    TimePoint now() const override { return current; }
+    void set(TimePoint time) { current = time; }
+    void advance(std::chrono::system_clock::duration step) { current += step; }
+
+private:
+    TimePoint current;
+};
+
+// Reads its source once per event: now() returns the time of the last
+// refresh(), so everything one packet or timer does sees the same instant
+// and the source is not consulted again on the way.
+class EventClock final : public Clock {
+public:
+    explicit EventClock(const Clock& source = Clock::system())
+        : source(&source), current(source.now()) {}
+
+    TimePoint now() const override { return current; }
+    TimePoint refresh() { return current = source->now(); }
+    void setSource(const Clock& clock) { source = &clock; refresh(); }
+
+private:
+    const Clock* source;
+    TimePoint current;
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_CLOCK_H
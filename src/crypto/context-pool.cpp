@@ -0,0 +1,88 @@
+#include "context-pool.h"
+#include "crypto-module.h"
+#include <openssl/opensslv.h>
+
+namespace vanet {
+namespace crypto {
+
+namespace {
+
+constexpr int HASH_ALGORITHM_COUNT = static_cast<int>(HashAlgorithm::SHA3_256) + 1;
+
+struct DigestTable {
+    const EVP_MD* digests[HASH_ALGORITHM_COUNT];
+
+    DigestTable() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        digests[static_cast<int>(HashAlgorithm::SHA256)] = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+        digests[static_cast<int>(HashAlgorithm::MD5)] = EVP_MD_fetch(nullptr, "MD5", nullptr);
+        digests[static_cast<int>(HashAlgorithm::SHA1)] = EVP_MD_fetch(nullptr, "SHA1", nullptr);
+        digests[static_cast<int>(HashAlgorithm::BLAKE2B)] = EVP_MD_fetch(nullptr, "BLAKE2B-512", nullptr);
+        digests[static_cast<int>(HashAlgorithm::SHA3_256)] = EVP_MD_fetch(nullptr, "SHA3-256", nullptr);
+#else
+        digests[static_cast<int>(HashAlgorithm::SHA256)] = EVP_sha256();
+        digests[static_cast<int>(HashAlgorithm::MD5)] = EVP_md5();
+        digests[static_cast<int>(HashAlgorithm::SHA1)] = EVP_sha1();
+        digests[static_cast<int>(HashAlgorithm::BLAKE2B)] = EVP_blake2b512();
+        digests[static_cast<int>(HashAlgorithm::SHA3_256)] = EVP_sha3_256();
+#endif
+    }
+
+    ~DigestTable() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        for (const EVP_MD* md : digests) {
+            EVP_MD_free(const_cast<EVP_MD*>(md));
+        }
+#endif
+    }
+};
+
+struct ThreadContexts {
+    EVP_MD_CTX* digest = EVP_MD_CTX_new();
+    EVP_MD_CTX* sign = EVP_MD_CTX_new();
+    EVP_MD_CTX* verify = EVP_MD_CTX_new();
+
+    ~ThreadContexts() {
+        EVP_MD_CTX_free(digest);
+        EVP_MD_CTX_free(sign);
+        EVP_MD_CTX_free(verify);
+    }
+};
+
+ThreadContexts& threadContexts() {
+    thread_local ThreadContexts contexts;
+    return contexts;
+}
+
+EVP_MD_CTX* ready(EVP_MD_CTX* ctx) {
+    if (ctx) {
+        EVP_MD_CTX_reset(ctx);
+    }
+    return ctx;
+}
+
+} // namespace
+
+const EVP_MD* ContextPool::digest(HashAlgorithm algo) {
+    static const DigestTable table;
+    int index = static_cast<int>(algo);
+    if (index < 0 || index >= HASH_ALGORITHM_COUNT) {
+        return nullptr;
+    }
+    return table.digests[index];
+}
+
+EVP_MD_CTX* ContextPool::digestContext() {
+    return ready(threadContexts().digest);
+}
+
+EVP_MD_CTX* ContextPool::signContext() {
+    return ready(threadContexts().sign);
+}
+
+EVP_MD_CTX* ContextPool::verifyContext() {
+    return ready(threadContexts().verify);
+}
+
+} // namespace crypto
+} // namespace vanet
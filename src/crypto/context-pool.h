@@ -0,0 +1,30 @@
+#ifndef VANET_CONTEXT_POOL_H
+#define VANET_CONTEXT_POOL_H
+
+#include <openssl/evp.h>
+
+namespace vanet {
+namespace crypto {
+
+enum class HashAlgorithm;
+
+// Reusable OpenSSL state for the hot paths. Digests are fetched once per
+// process (with OpenSSL 3 an implicit fetch is a provider lookup on every
+// init), and each thread keeps its own EVP_MD_CTX objects which are reset
+// rather than freed between uses.
+class ContextPool {
+public:
+    // Pre-fetched digest for the algorithm; nullptr if unsupported
+    static const EVP_MD* digest(HashAlgorithm algo);
+
+    // Per-thread contexts, reset and ready for an *Init call. Owned by the
+    // pool and valid until the calling thread exits.
+    static EVP_MD_CTX* digestContext();
+    static EVP_MD_CTX* signContext();
+    static EVP_MD_CTX* verifyContext();
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_CONTEXT_POOL_H
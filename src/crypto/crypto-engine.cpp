@@ -0,0 +1,254 @@
+#include "crypto-engine.h"
+
+namespace vanet {
+namespace crypto {
+
+constexpr size_t THREAD_KEY_CACHE = 256;  // Prepared keys kept per thread
+constexpr int IDLE_SPINS = 64;            // Polls before a worker sleeps
+
+CryptoEngine::ThreadState::~ThreadState() {
+    clear();
+}
+
+void CryptoEngine::ThreadState::clear() {
+    for (auto& entry : signers) {
+        entry.second.reset();
+        EVP_PKEY_free(entry.first);
+    }
+    for (auto& entry : verifiers) {
+        entry.second.reset();
+        EVP_PKEY_free(entry.first);
+    }
+    signers.clear();
+    verifiers.clear();
+}
+
+size_t CryptoEngine::defaultWorkerCount() {
+    // Leave one core for the simulator thread
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+CryptoEngine::CryptoEngine(size_t workerCount, size_t maxInFlight)
+    : nextTicket(1), nextDelivery(1), nextQueue(0), pending(0), sleepers(0), stopping(false),
+      submitted(0), delivered(0), helped(0), stolen(0) {
+    size_t slots = 2;
+    while (slots < maxInFlight) {
+        slots <<= 1;
+    }
+    slotMask = slots - 1;
+    jobs.reset(new Job[slots]);
+    for (size_t i = 0; i < slots; ++i) {
+        jobs[i].key = nullptr;
+        jobs[i].ready.store(false, std::memory_order_relaxed);
+    }
+
+    // Every queue can hold all in-flight tickets, so pushes never fail
+    for (size_t i = 0; i < workerCount; ++i) {
+        queues.push_back(std::make_unique<MpmcQueue<uint64_t>>(slots));
+    }
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&CryptoEngine::workerLoop, this, i);
+    }
+}
+
+CryptoEngine::~CryptoEngine() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (uint64_t ticket = nextDelivery; ticket < nextTicket; ++ticket) {
+        EVP_PKEY_free(slot(ticket).key);
+    }
+}
+
+uint64_t CryptoEngine::submitSign(const SignatureBackend* backend, EVP_PKEY* key,
+                                  const ByteSegments& input, Completion done) {
+    if (inFlight() >= slotMask) {
+        deliverThrough(nextDelivery);
+    }
+    Job& job = slot(nextTicket);
+    job.operation = Operation::SIGN;
+    job.backend = backend;
+    job.key = key;
+    job.input.clear();
+    for (const auto& segment : input) {
+        job.input.insert(job.input.end(), segment.begin(), segment.end());
+    }
+    job.signature.clear();
+    return submit(job, std::move(done));
+}
+
+uint64_t CryptoEngine::submitVerify(EVP_PKEY* key, const ByteSegments& input, ByteView signature,
+                                    Completion done) {
+    if (inFlight() >= slotMask) {
+        deliverThrough(nextDelivery);
+    }
+    Job& job = slot(nextTicket);
+    job.operation = Operation::VERIFY;
+    job.backend = nullptr;
+    job.key = key;
+    job.input.clear();
+    for (const auto& segment : input) {
+        job.input.insert(job.input.end(), segment.begin(), segment.end());
+    }
+    job.signature.assign(signature.begin(), signature.end());
+    return submit(job, std::move(done));
+}
+
+uint64_t CryptoEngine::submit(Job& job, Completion done) {
+    uint64_t ticket = nextTicket++;
+    EVP_PKEY_up_ref(job.key);
+    job.done = std::move(done);
+    job.ok = false;
+    job.ready.store(false, std::memory_order_relaxed);
+    ++submitted;
+
+    if (queues.empty()) {
+        execute(ticket, callerState);
+        return ticket;
+    }
+
+    pending.fetch_add(1);
+    queues[nextQueue]->tryPush(ticket);
+    nextQueue = (nextQueue + 1) % queues.size();
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+    return ticket;
+}
+
+bool CryptoEngine::takeJob(size_t home, uint64_t& ticket) {
+    size_t count = queues.size();
+    for (size_t i = 0; i < count; ++i) {
+        size_t queue = (home + i) % count;
+        if (queues[queue]->tryPop(ticket)) {
+            pending.fetch_sub(1);
+            if (i != 0 && home < count) {
+                stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void CryptoEngine::execute(uint64_t ticket, ThreadState& state) {
+    Job& job = slot(ticket);
+    ByteSegments input{ByteView(job.input)};
+    bool ok = false;
+
+    if (job.operation == Operation::SIGN) {
+        auto it = state.signers.find(job.key);
+        if (it == state.signers.end() && job.backend) {
+            if (state.signers.size() + state.verifiers.size() >= THREAD_KEY_CACHE) {
+                state.clear();
+            }
+            auto signer = job.backend->makeSigner(job.key);
+            if (signer) {
+                EVP_PKEY_up_ref(job.key);
+                it = state.signers.emplace(job.key, std::move(signer)).first;
+            }
+        }
+        ok = it != state.signers.end() && it->second->sign(input, job.signature);
+    } else {
+        auto it = state.verifiers.find(job.key);
+        if (it == state.verifiers.end()) {
+            const SignatureBackend* backend = SignatureBackend::forKey(job.key);
+            if (state.signers.size() + state.verifiers.size() >= THREAD_KEY_CACHE) {
+                state.clear();
+            }
+            auto verifier = backend ? backend->makeVerifier(job.key) : nullptr;
+            if (verifier) {
+                EVP_PKEY_up_ref(job.key);
+                it = state.verifiers.emplace(job.key, std::move(verifier)).first;
+            }
+        }
+        ok = it != state.verifiers.end() && it->second->verify(input, job.signature);
+    }
+
+    job.ok = ok;
+    job.ready.store(true, std::memory_order_release);
+}
+
+void CryptoEngine::deliverThrough(uint64_t ticket) {
+    while (nextDelivery <= ticket && nextDelivery < nextTicket) {
+        Job& job = slot(nextDelivery);
+        while (!job.ready.load(std::memory_order_acquire)) {
+            // Work on queued jobs instead of idling
+            uint64_t other;
+            if (takeJob(queues.size(), other)) {
+                execute(other, callerState);
+                ++helped;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        deliver(job, nextDelivery);
+    }
+}
+
+size_t CryptoEngine::poll() {
+    size_t count = 0;
+    while (nextDelivery < nextTicket && slot(nextDelivery).ready.load(std::memory_order_acquire)) {
+        deliver(slot(nextDelivery), nextDelivery);
+        ++count;
+    }
+    return count;
+}
+
+void CryptoEngine::drain() {
+    deliverThrough(nextTicket - 1);
+}
+
+void CryptoEngine::deliver(Job& job, uint64_t ticket) {
+    // Retire the slot first so a completion may submit new work. At most
+    // slotMask jobs are in flight, so that work never lands in this slot.
+    ++nextDelivery;
+    ++delivered;
+    EVP_PKEY* key = job.key;
+    job.key = nullptr;
+    Completion done = std::move(job.done);
+    job.done = nullptr;
+    if (done) {
+        Result result{ticket, job.operation, job.ok, ByteView(job.input), ByteView(job.signature)};
+        done(result);
+    }
+    EVP_PKEY_free(key);
+}
+
+CryptoEngine::Stats CryptoEngine::stats() const {
+    return Stats{submitted, delivered, stolen.load(std::memory_order_relaxed), helped};
+}
+
+void CryptoEngine::workerLoop(size_t index) {
+    ThreadState state;
+    int idle = 0;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        uint64_t ticket;
+        if (takeJob(index, ticket)) {
+            execute(ticket, state);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        wake.wait(lock, [this] { return pending.load() > 0 || stopping.load(); });
+        sleepers.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,135 @@
+#ifndef VANET_CRYPTO_ENGINE_H
+#define VANET_CRYPTO_ENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <openssl/evp.h>
+#include "byte-view.h"
+#include "mpmc-queue.h"
+#include "signature-backend.h"
+
+namespace vanet {
+namespace crypto {
+
+// Runs sign and verify jobs on a pool of worker threads. Jobs go round-robin
+// onto per-worker lock-free queues; idle workers steal from the others, and
+// the submitting thread helps out while it waits for a result.
+//
+// Completions never run on workers. They run on the submitting thread, in
+// submission order, from deliverThrough()/poll()/drain(). A simulator that
+// delivers each ticket from an event scheduled at submit time therefore sees
+// the same results at the same simulated times on any number of threads.
+// Submission and delivery must both happen on one thread.
+class CryptoEngine {
+public:
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT = 4096;
+
+    enum class Operation { SIGN, VERIFY };
+
+    // Views are only valid during the completion call
+    struct Result {
+        uint64_t ticket;
+        Operation operation;
+        bool ok;
+        ByteView input;       // signed bytes, segments concatenated
+        ByteView signature;   // produced (SIGN) or checked (VERIFY)
+    };
+    using Completion = std::function<void(const Result&)>;
+
+    struct Stats {
+        uint64_t submitted;
+        uint64_t delivered;
+        uint64_t stolen;      // jobs run by a worker other than the one queued to
+        uint64_t helped;      // jobs run by the submitting thread
+    };
+
+    // workers == 0 runs every job inline at submit time. Submitting with
+    // maxInFlight jobs undelivered first delivers the oldest one; maxInFlight
+    // is rounded up to a power of two, minus one.
+    explicit CryptoEngine(size_t workers = defaultWorkerCount(),
+                          size_t maxInFlight = DEFAULT_MAX_IN_FLIGHT);
+    ~CryptoEngine();  // undelivered completions are dropped
+
+    CryptoEngine(const CryptoEngine&) = delete;
+    CryptoEngine& operator=(const CryptoEngine&) = delete;
+
+    // The key is referenced until the job is delivered. Tickets start at 1.
+    uint64_t submitSign(const SignatureBackend* backend, EVP_PKEY* key,
+                        const ByteSegments& input, Completion done);
+    uint64_t submitVerify(EVP_PKEY* key, const ByteSegments& input, ByteView signature,
+                          Completion done);
+
+    // Delivers every job up to and including ticket, waiting if needed
+    void deliverThrough(uint64_t ticket);
+    // Delivers finished jobs up to the first unfinished one; returns the count
+    size_t poll();
+    void drain();
+
+    size_t workerCount() const { return workers.size(); }
+    size_t inFlight() const { return static_cast<size_t>(nextTicket - nextDelivery); }
+    Stats stats() const;
+
+    static size_t defaultWorkerCount();
+
+private:
+    struct Job {
+        Operation operation;
+        const SignatureBackend* backend;
+        EVP_PKEY* key;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> signature;
+        Completion done;
+        bool ok;
+        std::atomic<bool> ready;
+    };
+
+    // Signers/verifiers prepared by one thread, each holding a key reference
+    struct ThreadState {
+        std::unordered_map<EVP_PKEY*, std::unique_ptr<Signer>> signers;
+        std::unordered_map<EVP_PKEY*, std::unique_ptr<Verifier>> verifiers;
+
+        ~ThreadState();
+        void clear();
+    };
+
+    size_t slotMask;
+    std::unique_ptr<Job[]> jobs;
+    std::vector<std::unique_ptr<MpmcQueue<uint64_t>>> queues;
+    std::vector<std::thread> workers;
+
+    uint64_t nextTicket;
+    uint64_t nextDelivery;
+    size_t nextQueue;
+    ThreadState callerState;
+
+    std::atomic<size_t> pending;
+    std::atomic<size_t> sleepers;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    uint64_t submitted;
+    uint64_t delivered;
+    uint64_t helped;
+    std::atomic<uint64_t> stolen;
+
+    uint64_t submit(Job& job, Completion done);
+    Job& slot(uint64_t ticket) { return jobs[ticket & slotMask]; }
+    bool takeJob(size_t home, uint64_t& ticket);
+    void execute(uint64_t ticket, ThreadState& state);
+    void deliver(Job& job, uint64_t ticket);
+    void workerLoop(size_t index);
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_CRYPTO_ENGINE_H
@@ -1,19 +1,35 @@
 #include "crypto-module.h"
+#include "context-pool.h"
+#include "signature-backend.h"
 #include <chrono>
+#include <cstdio>
 #include <algorithm>
 #include <stdexcept>
 #include <cstring>
+#include <ctime>
+#include <mutex>
 
 namespace vanet {
 namespace crypto {
 
 // Constants for security parameters
-constexpr size_t MAX_MESSAGE_HISTORY = 1000;  // Maximum number of messages to store for replay prevention
+constexpr size_t REPLAY_WINDOW_SLOTS = 1024;  // Senders tracked at once for replay prevention
+constexpr uint32_t REPLAY_TIME_BUCKETS = 5;   // Replay slots expire after this many buckets
 constexpr uint64_t MESSAGE_TIMEOUT = 5000;    // Message timeout in milliseconds
-constexpr size_t MIN_KEY_SIZE = 2048;         // Minimum RSA key size in bits
 constexpr size_t MAX_CERT_CHAIN = 5;          // Maximum depth of certificate chain
+constexpr size_t KEY_CACHE_CAPACITY = 256;    // Parsed sender credentials kept in the LRU
+constexpr size_t CHAIN_CACHE_CAPACITY = 1024; // Validated certificate fingerprints remembered
+constexpr size_t EXPECTED_REVOCATIONS = 4096; // Revocation filter sized for this many entries
+constexpr size_t SESSION_CAPACITY = 256;      // Neighbor sessions kept at once
+constexpr uint64_t SESSION_LIFETIME_MS = 60000; // Sessions are renegotiated after this
 
-CryptoModule::CryptoModule() : privateKey(nullptr), publicKey(nullptr), certificate(nullptr) {
+CryptoModule::CryptoModule()
+    : privateKey(nullptr), publicKey(nullptr), certificate(nullptr),
+      signatureBackend(nullptr), presignDepth(0), keyCache(KEY_CACHE_CAPACITY),
+      trustStore(sharedTrustStore()),
+      replayWindow(REPLAY_WINDOW_SLOTS, MESSAGE_TIMEOUT / REPLAY_TIME_BUCKETS, REPLAY_TIME_BUCKETS),
+      nextSequence(0), instrumentation(nullptr), clock(&Clock::system()), lastSignedMs(0), sessionStats{0, 0, 0, 0},
+      operationStats{0, 0} {
     initializeOpenSSL();
 }
 
@@ -22,265 +38,585 @@ CryptoModule::~CryptoModule() {
 }
 
 void CryptoModule::initializeOpenSSL() {
-    OpenSSL_add_all_algorithms();
-    ERR_load_crypto_strings();
+    // Library state is process-wide: set up by the first module, and left
+    // to OpenSSL's own cleanup at exit rather than torn down under the
+    // modules still alive
+    static std::once_flag once;
+    std::call_once(once, [] {
+        OpenSSL_add_all_algorithms();
+        ERR_load_crypto_strings();
+    });
 }
 
 void CryptoModule::cleanupOpenSSL() {
+    keyCache.clear();
+    sessions.reset();
+    signingPool.reset();
+    signer.reset();
     if (privateKey) EVP_PKEY_free(privateKey);
     if (publicKey) EVP_PKEY_free(publicKey);
     if (certificate) X509_free(certificate);
-    EVP_cleanup();
-    ERR_free_strings();
+}
+
+std::shared_ptr<TrustStore> CryptoModule::sharedTrustStore() {
+    static const std::shared_ptr<TrustStore> store =
+        std::make_shared<TrustStore>(MAX_CERT_CHAIN, CHAIN_CACHE_CAPACITY, EXPECTED_REVOCATIONS);
+    return store;
+}
+
+void CryptoModule::setTrustStore(std::shared_ptr<TrustStore> store) {
+    trustStore = store ? std::move(store) : sharedTrustStore();
+    // Certificate verdicts cached with the keys came from the old store
+    keyCache.clear();
 }
 
 bool CryptoModule::generateKeyPair(SignatureAlgorithm algo) {
-    EVP_PKEY_CTX* ctx = nullptr;
+    const SignatureBackend* backend = SignatureBackend::forAlgorithm(algo);
+    if (!backend) {
+        return false;
+    }
     
-    if (algo == SignatureAlgorithm::RSA_PSS) {
-        ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
-        if (!ctx) return false;
-        
-        if (EVP_PKEY_keygen_init(ctx) <= 0) {
-            EVP_PKEY_CTX_free(ctx);
-            return false;
-        }
-        
-        if (EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, MIN_KEY_SIZE) <= 0) {
-            EVP_PKEY_CTX_free(ctx);
-            return false;
-        }
-    } else { // ECDSA
-        ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
-        if (!ctx) return false;
-        
-        if (EVP_PKEY_keygen_init(ctx) <= 0) {
-            EVP_PKEY_CTX_free(ctx);
-            return false;
-        }
-        
-        if (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, NID_secp256k1) <= 0) {
-            EVP_PKEY_CTX_free(ctx);
-            return false;
-        }
+    EVP_PKEY* key = backend->generateKey();
+    if (!key) {
+        return false;
     }
     
-    EVP_PKEY* key = nullptr;
-    if (EVP_PKEY_keygen(ctx, &key) <= 0) {
-        EVP_PKEY_CTX_free(ctx);
+    return replaceKey(key, backend, backend->makeSigner(key));
+}
+
+bool CryptoModule::replaceKey(EVP_PKEY* key, const SignatureBackend* backend,
+                              std::unique_ptr<Signer> newSigner) {
+    if (!newSigner) {
+        EVP_PKEY_free(key);
         return false;
     }
     
     if (privateKey) EVP_PKEY_free(privateKey);
     privateKey = key;
-    EVP_PKEY_CTX_free(ctx);
+    signatureBackend = backend;
+    signer = std::move(newSigner);
+    ownCredential.clear();
+    if (certificate && X509_check_private_key(certificate, key) != 1) {
+        X509_free(certificate);
+        certificate = nullptr;
+    }
+    // Nonces precomputed for the old key are useless; start over for the new one
+    signingPool = presignDepth ? SigningPool::create(key, presignDepth) : nullptr;
+    // Peers know this node by its old credential; sessions start over
+    if (sessions) {
+        enableSessions(true);
+    }
+    return true;
+}
+
+bool CryptoModule::enablePresigning(size_t poolDepth) {
+    presignDepth = poolDepth;
+    signingPool = poolDepth && privateKey ? SigningPool::create(privateKey, poolDepth) : nullptr;
+    return !poolDepth || signingPool;
+}
+
+bool CryptoModule::enableSessions(bool enabled) {
+    sessions = enabled ? std::make_unique<SessionTable>(SESSION_CAPACITY, SESSION_LIFETIME_MS) : nullptr;
+    lastSignedMs = 0;
+    if (sessions && !sessions->valid()) {
+        sessions.reset();
+        return false;
+    }
     return true;
 }
 
+size_t CryptoModule::refillSigningPool(size_t maxEntries) {
+    return signingPool ? signingPool->refill(maxEntries) : 0;
+}
+
+SigningPool::Stats CryptoModule::getSigningPoolStats() const {
+    return signingPool ? signingPool->stats() : SigningPool::Stats{0, 0, 0, 0, 0, 0};
+}
+
 std::vector<uint8_t> CryptoModule::hashMessage(const std::vector<uint8_t>& message, HashAlgorithm algo) {
-    const EVP_MD* md;
-    switch (algo) {
-        case HashAlgorithm::SHA256:
-            md = EVP_sha256();
-            break;
-        case HashAlgorithm::MD5:
-            md = EVP_md5();
-            break;
-        case HashAlgorithm::SHA1:
-            md = EVP_sha1();
-            break;
-        case HashAlgorithm::BLAKE2B:
-            md = EVP_blake2b512();
-            break;
-        case HashAlgorithm::SHA3_256:
-            md = EVP_sha3_256();
-            break;
-        default:
-            throw std::invalid_argument("Unsupported hash algorithm");
-    }
-
-    EVP_MD_CTX* mdctx = EVP_MD_CTX_new();
+    const EVP_MD* md = ContextPool::digest(algo);
+    if (!md) {
+        throw std::invalid_argument("Unsupported hash algorithm");
+    }
+
+    EVP_MD_CTX* mdctx = ContextPool::digestContext();
     std::vector<uint8_t> hash(EVP_MAX_MD_SIZE);
     unsigned int hashLen;
 
-    EVP_DigestInit_ex(mdctx, md, nullptr);
-    EVP_DigestUpdate(mdctx, message.data(), message.size());
-    EVP_DigestFinal_ex(mdctx, hash.data(), &hashLen);
-    EVP_MD_CTX_free(mdctx);
+    if (!mdctx ||
+        EVP_DigestInit_ex(mdctx, md, nullptr) <= 0 ||
+        EVP_DigestUpdate(mdctx, message.data(), message.size()) <= 0 ||
+        EVP_DigestFinal_ex(mdctx, hash.data(), &hashLen) <= 0) {
+        throw std::runtime_error("Failed to hash message");
+    }
 
     hash.resize(hashLen);
     return hash;
 }
 
-std::vector<uint8_t> CryptoModule::signMessage(const std::vector<uint8_t>& message) {
+bool CryptoModule::exportIdentity(std::vector<uint8_t>& out) const {
     if (!privateKey) {
-        throw std::runtime_error("Private key not loaded");
+        return false;
+    }
+    
+    unsigned char* der = nullptr;
+    int derLen = i2d_PrivateKey(privateKey, &der);
+    if (derLen <= 0) {
+        return false;
+    }
+    
+    // Sequence counter (little-endian) followed by the DER private key
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(nextSequence >> (8 * i)));
     }
+    out.insert(out.end(), der, der + derLen);
+    OPENSSL_free(der);
+    return true;
+}
 
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx) {
-        throw std::runtime_error("Failed to create signature context");
+bool CryptoModule::importIdentity(ByteView identity) {
+    if (identity.size() <= 4) {
+        return false;
+    }
+    
+    const unsigned char* der = identity.data() + 4;
+    EVP_PKEY* key = d2i_AutoPrivateKey(nullptr, &der, static_cast<long>(identity.size() - 4));
+    const SignatureBackend* keyBackend = key ? SignatureBackend::forKey(key) : nullptr;
+    const SignatureBackend* backend = keyBackend ? SignatureBackend::forAlgorithm(keyBackend->algorithm()) : nullptr;
+    if (!replaceKey(key, backend, backend ? backend->makeSigner(key) : nullptr)) {
+        return false;
     }
+    
+    nextSequence = 0;
+    for (int i = 0; i < 4; ++i) {
+        nextSequence |= static_cast<uint32_t>(identity[i]) << (8 * i);
+    }
+    return true;
+}
 
-    if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, privateKey) <= 0) {
-        EVP_MD_CTX_free(ctx);
-        throw std::runtime_error("Failed to initialize signature");
+bool CryptoModule::loadCertificate(const std::string& certPath) {
+    FILE* file = fopen(certPath.c_str(), "rb");
+    if (!file) {
+        return false;
     }
+    X509* cert = PEM_read_X509(file, nullptr, nullptr, nullptr);
+    fclose(file);
+    
+    // The certificate is sent as the credential for our signatures
+    if (!cert || (privateKey && X509_check_private_key(cert, privateKey) != 1)) {
+        X509_free(cert);
+        return false;
+    }
+    if (certificate) X509_free(certificate);
+    certificate = cert;
+    ownCredential.clear();
+    return true;
+}
 
-    size_t sigLen;
-    if (EVP_DigestSignUpdate(ctx, message.data(), message.size()) <= 0 ||
-        EVP_DigestSignFinal(ctx, nullptr, &sigLen) <= 0) {
-        EVP_MD_CTX_free(ctx);
-        throw std::runtime_error("Failed to calculate signature length");
+std::vector<uint8_t> CryptoModule::signMessage(const std::vector<uint8_t>& message) {
+    return signSegments(ByteSegments(message));
+}
+
+std::vector<uint8_t> CryptoModule::signSegments(const ByteSegments& segments) {
+    if (!privateKey || !signer) {
+        throw std::runtime_error("Private key not loaded");
     }
 
-    std::vector<uint8_t> signature(sigLen);
-    if (EVP_DigestSignFinal(ctx, signature.data(), &sigLen) <= 0) {
-        EVP_MD_CTX_free(ctx);
+    std::vector<uint8_t> signature;
+    ScopedStageTimer timer(instrumentation, Stage::SIGN);
+    ++operationStats.signatures;
+    if (!activeSigner()->sign(segments, signature)) {
         throw std::runtime_error("Failed to create signature");
     }
-
-    EVP_MD_CTX_free(ctx);
-    signature.resize(sigLen);
     return signature;
 }
 
 bool CryptoModule::verifySignature(const std::vector<uint8_t>& message,
                                  const std::vector<uint8_t>& signature,
                                  const std::vector<uint8_t>& publicKey) {
-    EVP_PKEY* key = nullptr;
-    const unsigned char* pubKeyData = publicKey.data();
-    key = d2i_PUBKEY(nullptr, &pubKeyData, publicKey.size());
-    
-    if (!key) {
+    return verifySegments(ByteSegments(message), signature, publicKey);
+}
+
+bool CryptoModule::verifySegments(const ByteSegments& segments, ByteView signature, ByteView senderCert) {
+    KeyCache::Entry* sender = resolveSender(senderCert);
+    if (!sender) {
         return false;
     }
 
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    bool result = false;
+    return verifyWithKey(*sender, segments, signature);
+}
 
-    if (EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, key) > 0 &&
-        EVP_DigestVerifyUpdate(ctx, message.data(), message.size()) > 0 &&
-        EVP_DigestVerifyFinal(ctx, signature.data(), signature.size()) > 0) {
-        result = true;
+CryptoModule::SecureMessage CryptoModule::createSecureMessage(const std::vector<uint8_t>& payload) {
+    return createSecureMessage(ByteView(payload));
+}
+
+CryptoModule::SecureMessage CryptoModule::createSecureMessage(ByteView payload) {
+    return createSecureMessage(payload, std::pmr::get_default_resource());
+}
+
+CryptoModule::SecureMessage CryptoModule::createSecureMessage(ByteView payload,
+                                                              std::pmr::memory_resource* resource) {
+    if (!privateKey || !signer) {
+        throw std::runtime_error("Private key not loaded");
     }
 
-    EVP_PKEY_free(key);
-    EVP_MD_CTX_free(ctx);
-    return result;
+    SecureMessage msg{SecureMessage::allocator_type(resource)};
+    msg.payload.assign(payload.begin(), payload.end());
+    msg.timestamp = clock->nowMillis();
+    
+    msg.sequenceNumber = ++nextSequence;
+    
+    signInto(msg);
+    return msg;
 }
 
-CryptoModule::SecureMessage CryptoModule::createSecureMessage(const std::vector<uint8_t>& payload) {
-    SecureMessage msg;
+void CryptoModule::signInto(SecureMessage& msg) {
+    if (sessions) {
+        ByteView offer = sessions->offer();
+        msg.sessionOffer.assign(offer.begin(), offer.end());
+        lastSignedMs = msg.timestamp;
+    }
+    
+    // Create signature over payload + timestamp + sequence number (+ offer)
+    StageTimer timer(instrumentation, Stage::SIGN);
+    ++operationStats.signatures;
+    if (!activeSigner()->sign(SecureMessageView(msg).signedSegments(), signatureScratch)) {
+        throw std::runtime_error("Failed to create signature");
+    }
+    timer.stop();
+    msg.signature.assign(signatureScratch.begin(), signatureScratch.end());
+    
+    ByteView credential = ownCredentialDer();
+    msg.senderCert.assign(credential.begin(), credential.end());
+}
+
+CryptoModule::SecureMessage CryptoModule::createSessionMessage(ByteView payload,
+                                                               std::pmr::memory_resource* resource) {
+    if (!sessions) {
+        return createSecureMessage(payload, resource);
+    }
+    if (!privateKey || !signer) {
+        throw std::runtime_error("Private key not loaded");
+    }
+    
+    SecureMessage msg{SecureMessage::allocator_type(resource)};
+    msg.payload.assign(payload.begin(), payload.end());
+    msg.timestamp = clock->nowMillis();
+    msg.sequenceNumber = ++nextSequence;
+    
+    sessions->expire(msg.timestamp);
+    bool reauthenticate = sessions->size() == 0 || msg.timestamp - lastSignedMs >= REAUTH_INTERVAL_MS;
+    if (reauthenticate) {
+        signInto(msg);
+    }
+    
+    ScopedStageTimer timer(instrumentation, Stage::SIGN);
+    if (sessions->tagAll(SecureMessageView(msg).signedSegments(), msg.timestamp, msg.sessionTags) > 0) {
+        ++(reauthenticate ? sessionStats.reauthenticated : sessionStats.tagged);
+    }
+    return msg;
+}
+
+uint64_t CryptoModule::createSecureMessageAsync(ByteView payload, CryptoEngine& engine,
+                                                SignedCallback done) {
+    if (!privateKey || !signer) {
+        throw std::runtime_error("Private key not loaded");
+    }
+    
+    SecureMessageView msg;
     msg.payload = payload;
-    msg.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
-    
-    static uint32_t sequence = 0;
-    msg.sequenceNumber = ++sequence;
-    
-    // Create signature over payload + timestamp + sequence number
-    std::vector<uint8_t> toSign = payload;
-    toSign.insert(toSign.end(), 
-                 reinterpret_cast<uint8_t*>(&msg.timestamp),
-                 reinterpret_cast<uint8_t*>(&msg.timestamp) + sizeof(msg.timestamp));
-    toSign.insert(toSign.end(),
-                 reinterpret_cast<uint8_t*>(&msg.sequenceNumber),
-                 reinterpret_cast<uint8_t*>(&msg.sequenceNumber) + sizeof(msg.sequenceNumber));
-    
-    msg.signature = signMessage(toSign);
-    
-    // Add certificate if available
-    if (certificate) {
+    msg.timestamp = clock->nowMillis();
+    msg.sequenceNumber = ++nextSequence;
+    msg.senderCert = ownCredentialDer();
+    
+    // Offloaded work is timed from submission to delivery
+    size_t payloadSize = payload.size();
+    StageTimer timer(instrumentation, Stage::SIGN);
+    ++operationStats.signatures;
+    return engine.submitSign(signatureBackend, privateKey, msg.signedSegments(),
+        [msg, payloadSize, done, timer](const CryptoEngine::Result& result) mutable {
+            timer.stop();
+            SecureMessageView signedMsg = msg;
+            signedMsg.payload = result.input.subview(0, payloadSize);
+            signedMsg.signature = result.signature;
+            done(result.ok, signedMsg);
+        });
+}
+
+uint64_t CryptoModule::verifySecureMessageAsync(const SecureMessageView& message, CryptoEngine& engine,
+                                                VerifiedCallback done) {
+    KeyCache::Entry* sender = nullptr;
+    uint64_t nowMs = clock->nowMillis();
+    if (isValidTimestamp(message.timestamp, nowMs) && !isReplayMessage(message, nowMs)) {
+        sender = resolveSender(message.senderCert);
+    }
+    if (!sender) {
+        done(false);
+        return 0;
+    }
+    
+    StageTimer timer(instrumentation, Stage::VERIFY);
+    ++operationStats.verifications;
+    return engine.submitVerify(sender->key, message.signedSegments(), message.signature,
+        [done, timer](const CryptoEngine::Result& result) mutable {
+            timer.stop();
+            done(result.ok);
+        });
+}
+
+size_t CryptoModule::signedWireSize(size_t payloadSize) {
+    size_t signatureSize = privateKey ? static_cast<size_t>(EVP_PKEY_size(privateKey)) : 0;
+    return payloadSize + signatureSize + sizeof(uint64_t) + sizeof(uint32_t) + ownCredentialDer().size();
+}
+
+ByteView CryptoModule::ownCredentialDer() {
+    // Certificate if available, otherwise the bare public key so that
+    // receivers still have something to verify against. Encoded once.
+    if (ownCredential.empty() && privateKey) {
         unsigned char* certBuf = nullptr;
-        int certLen = i2d_X509(certificate, &certBuf);
+        int certLen = certificate ? i2d_X509(certificate, &certBuf)
+                                  : i2d_PUBKEY(privateKey, &certBuf);
         if (certLen > 0) {
-            msg.senderCert.assign(certBuf, certBuf + certLen);
+            ownCredential.assign(certBuf, certBuf + certLen);
             OPENSSL_free(certBuf);
         }
     }
-    
-    return msg;
+    return ownCredential;
 }
 
-bool CryptoModule::verifySecureMessage(const SecureMessage& message) {
+bool CryptoModule::verifySecureMessage(const SecureMessageView& message) {
+    // One clock read covers every check of this message
+    uint64_t nowMs = clock->nowMillis();
+    
     // Check timestamp
-    if (!isValidTimestamp(message.timestamp)) {
+    if (!isValidTimestamp(message.timestamp, nowMs)) {
         return false;
     }
     
     // Check for replay
-    if (isReplayMessage(message)) {
+    if (isReplayMessage(message, nowMs)) {
         return false;
     }
     
-    // Verify certificate if present
-    if (!message.senderCert.empty()) {
-        const unsigned char* certData = message.senderCert.data();
-        X509* cert = d2i_X509(nullptr, &certData, message.senderCert.size());
-        if (!cert || !verifyCertificate(Certificate{/*...*/})) {
-            X509_free(cert);
-            return false;
+    if (isSessionTagged(message)) {
+        ScopedStageTimer timer(instrumentation, Stage::VERIFY);
+        if (sessions->check(message.signedSegments(), message.sessionTags, nowMs)) {
+            ++sessionStats.tagsVerified;
+            return true;
         }
-        X509_free(cert);
     }
     
-    // Verify signature
-    std::vector<uint8_t> toVerify = message.payload;
-    toVerify.insert(toVerify.end(),
-                   reinterpret_cast<const uint8_t*>(&message.timestamp),
-                   reinterpret_cast<const uint8_t*>(&message.timestamp) + sizeof(message.timestamp));
-    toVerify.insert(toVerify.end(),
-                   reinterpret_cast<const uint8_t*>(&message.sequenceNumber),
-                   reinterpret_cast<const uint8_t*>(&message.sequenceNumber) + sizeof(message.sequenceNumber));
+    // Verify certificate (if present) and signature
+    if (!verifySegments(message.signedSegments(), message.signature, message.senderCert)) {
+        return false;
+    }
     
-    return verifySignature(toVerify, message.signature, message.senderCert);
+    // The offer is signed, so the session is bound to the sender's credential
+    if (sessions && !message.sessionOffer.empty() &&
+        sessions->open(senderIdentity(message, nowMs), message.sessionOffer, nowMs)) {
+        ++sessionStats.opened;
+    }
+    return true;
 }
 
-bool CryptoModule::isReplayMessage(const SecureMessage& message) {
-    auto it = std::find_if(messageHistory.begin(), messageHistory.end(),
-        [&message](const MessageHistory& history) {
-            return history.timestamp == message.timestamp &&
-                   history.sequenceNumber == message.sequenceNumber;
-        });
-    return it != messageHistory.end();
+std::vector<bool> CryptoModule::verifySecureMessageBatch(const std::vector<SecureMessage>& messages) {
+    return verifySecureMessageBatch(std::vector<SecureMessageView>(messages.begin(), messages.end()));
 }
 
-void CryptoModule::updateMessageHistory(const SecureMessage& message) {
-    MessageHistory history;
-    history.timestamp = message.timestamp;
-    history.sequenceNumber = message.sequenceNumber;
-    history.messageHash = hashMessage(message.payload);
+std::vector<bool> CryptoModule::verifySecureMessageBatch(const std::vector<SecureMessageView>& messages) {
+    std::vector<bool> results(messages.size(), false);
+    
+    // Cheap checks first so the expensive ones only see plausible messages
+    std::vector<size_t> pending;
+    pending.reserve(messages.size());
+    uint64_t nowMs = clock->nowMillis();
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (!isValidTimestamp(messages[i].timestamp, nowMs) || isReplayMessage(messages[i], nowMs)) {
+            continue;
+        }
+        if (isSessionTagged(messages[i]) &&
+            sessions->check(messages[i].signedSegments(), messages[i].sessionTags, nowMs)) {
+            ++sessionStats.tagsVerified;
+            results[i] = true;
+            continue;
+        }
+        pending.push_back(i);
+    }
     
-    messageHistory.push_back(history);
+    // Group by sender credential so each key is parsed once per batch
+    std::sort(pending.begin(), pending.end(), [&messages](size_t a, size_t b) {
+        return messages[a].senderCert < messages[b].senderCert;
+    });
     
-    // Prune old messages if necessary
-    if (messageHistory.size() > MAX_MESSAGE_HISTORY) {
-        pruneMessageHistory();
+    size_t groupStart = 0;
+    while (groupStart < pending.size()) {
+        ByteView senderCert = messages[pending[groupStart]].senderCert;
+        size_t groupEnd = groupStart + 1;
+        while (groupEnd < pending.size() &&
+               messages[pending[groupEnd]].senderCert == senderCert) {
+            ++groupEnd;
+        }
+        
+        KeyCache::Entry* sender = resolveSender(senderCert);
+        if (sender) {
+            for (size_t k = groupStart; k < groupEnd; ++k) {
+                const auto& message = messages[pending[k]];
+                results[pending[k]] = verifyWithKey(*sender, message.signedSegments(), message.signature);
+                if (results[pending[k]] && sessions && !message.sessionOffer.empty() &&
+                    sessions->open(senderIdentity(message, nowMs), message.sessionOffer, nowMs)) {
+                    ++sessionStats.opened;
+                }
+            }
+        }
+        
+        groupStart = groupEnd;
     }
+    
+    return results;
 }
 
-void CryptoModule::pruneMessageHistory() {
-    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+KeyCache::Entry* CryptoModule::resolveSender(ByteView senderCert) {
+    KeyCache::Entry* entry = keyCache.lookup(senderCert);
+    if (!entry) {
+        return nullptr;
+    }
     
-    messageHistory.erase(
-        std::remove_if(messageHistory.begin(), messageHistory.end(),
-            [now](const MessageHistory& history) {
-                return (now - history.timestamp) > MESSAGE_TIMEOUT;
-            }),
-        messageHistory.end()
-    );
+    // Certificate checks are cached with the key until the cert expires or
+    // anything is revoked, through whichever module shares the store. Bare
+    // public keys have nothing to chain, so they only pass without anchors.
+    if (!entry->cert && trustStore->hasAnchors()) {
+        return nullptr;
+    }
+    if (entry->cert) {
+        time_t now = clock->nowSeconds();
+        if (!entry->certVerified || now > entry->verifiedUntil ||
+            entry->verifiedRevocations != trustStore->revocations()) {
+            Certificate cert = describeCertificate(entry->cert);
+            entry->certVerified = verifyCertificate(cert);
+            entry->verifiedUntil = cert.validUntil;
+            entry->verifiedRevocations = trustStore->revocations();
+        }
+        if (!entry->certVerified) {
+            return nullptr;
+        }
+    }
+    
+    return entry;
+}
+
+bool CryptoModule::verifyCertificate(const Certificate& cert) {
+    if (cert.der.empty() || isCertificateExpired(cert)) {
+        return false;
+    }
+    return trustStore->verify(cert.der, clock->nowSeconds());
 }
 
-bool CryptoModule::isValidTimestamp(uint64_t timestamp) const {
-    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+bool CryptoModule::isCertificateExpired(const Certificate& cert) const {
+    time_t now = clock->nowSeconds();
+    return now < cert.validFrom || now > cert.validUntil;
+}
+
+void CryptoModule::revokeCertificate(ByteView der) {
+    // Cached verdicts of every module on the store see the revocation count move
+    trustStore->revoke(der);
+}
+
+Certificate CryptoModule::describeCertificate(X509* cert) {
+    Certificate desc{};
+    
+    unsigned char* derBuf = nullptr;
+    int derLen = i2d_X509(cert, &derBuf);
+    if (derLen > 0) {
+        desc.der.assign(derBuf, derBuf + derLen);
+        OPENSSL_free(derBuf);
+    }
+    
+    char name[256];
+    X509_NAME_oneline(X509_get_subject_name(cert), name, sizeof(name));
+    desc.subject = name;
+    X509_NAME_oneline(X509_get_issuer_name(cert), name, sizeof(name));
+    desc.issuer = name;
+    
+    unsigned char* keyBuf = nullptr;
+    int keyLen = i2d_PUBKEY(X509_get0_pubkey(cert), &keyBuf);
+    if (keyLen > 0) {
+        desc.publicKey.assign(keyBuf, keyBuf + keyLen);
+        OPENSSL_free(keyBuf);
+    }
+    
+    const ASN1_BIT_STRING* sig = nullptr;
+    X509_get0_signature(&sig, nullptr, cert);
+    if (sig) {
+        desc.signature.assign(sig->data, sig->data + sig->length);
+    }
+    
+    struct tm tmBuf{};
+    if (ASN1_TIME_to_tm(X509_get0_notBefore(cert), &tmBuf)) {
+        desc.validFrom = timegm(&tmBuf);
+    }
+    if (ASN1_TIME_to_tm(X509_get0_notAfter(cert), &tmBuf)) {
+        desc.validUntil = timegm(&tmBuf);
+    }
     
-    return (now - timestamp) <= MESSAGE_TIMEOUT;
+    return desc;
+}
+
+bool CryptoModule::verifyWithKey(KeyCache::Entry& sender, const ByteSegments& segments,
+                                 ByteView signature) {
+    ScopedStageTimer timer(instrumentation, Stage::VERIFY);
+    ++operationStats.verifications;
+    // Verifiers are prepared once per cache entry and reused per message
+    if (!sender.verifier) {
+        const SignatureBackend* backend = SignatureBackend::forKey(sender.key);
+        if (!backend) {
+            return false;
+        }
+        sender.verifier = backend->makeVerifier(sender.key);
+        if (!sender.verifier) {
+            return false;
+        }
+    }
+    
+    return sender.verifier->verify(segments, signature);
+}
+
+bool CryptoModule::isReplayMessage(const SecureMessageView& message) {
+    return isReplayMessage(message, clock->nowMillis());
+}
+
+bool CryptoModule::isReplayMessage(const SecureMessageView& message, uint64_t nowMs) {
+    ScopedStageTimer timer(instrumentation, Stage::REPLAY_CHECK);
+    return replayWindow.isReplay(senderIdentity(message, nowMs), message.sequenceNumber, nowMs);
+}
+
+void CryptoModule::updateMessageHistory(const SecureMessageView& message) {
+    uint64_t nowMs = clock->nowMillis();
+    replayWindow.record(senderIdentity(message, nowMs), message.sequenceNumber, nowMs);
+}
+
+bool CryptoModule::isSessionTagged(const SecureMessageView& message) const {
+    // A session peer's tag stands in for its signature on messages that carry
+    // nothing else. One with a signed offer is re-authentication, checked to
+    // renew the session; one with a credential would be replay-checked under
+    // that credential rather than the session peer the tag stands for.
+    return sessions && !message.sessionTags.empty() && message.sessionOffer.empty() &&
+           message.signature.empty() && message.senderCert.empty();
+}
+
+uint64_t CryptoModule::senderIdentity(const SecureMessageView& message, uint64_t nowMs) const {
+    // Sequence numbers are per sender, and a sender is its credential.
+    // Messages authenticated by session tag alone name it by their session.
+    if (message.senderCert.empty() && sessions) {
+        uint64_t peer = sessions->peerOf(message.sessionTags, nowMs);
+        if (peer) {
+            return peer;
+        }
+    }
+    return KeyCache::hashDer(message.senderCert);
+}
+
+bool CryptoModule::isValidTimestamp(uint64_t timestamp, uint64_t nowMs) const {
+    return (nowMs - timestamp) <= MESSAGE_TIMEOUT;
 }
 
 } // namespace crypto
@@ -4,11 +4,22 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <openssl/evp.h>
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/err.h>
 #include <openssl/x509.h>
+#include "byte-view.h"
+#include "clock.h"
+#include "crypto-engine.h"
+#include "instrumentation.h"
+#include "key-cache.h"
+#include "replay-window.h"
+#include "session-table.h"
+#include "signature-backend.h"
+#include "signing-pool.h"
+#include "trust-store.h"
 
 namespace vanet {
 namespace crypto {
@@ -22,8 +33,10 @@ enum class HashAlgorithm {
 };
 
 enum class SignatureAlgorithm {
-    RSA_PSS,
-    ECDSA
+    RSA_PSS,     // RSA-2048, PSS padding
+    ECDSA,       // ECDSA secp256k1
+    ECDSA_P256,  // ECDSA NIST P-256
+    ED25519
 };
 
 struct Certificate {
@@ -33,6 +46,7 @@ struct Certificate {
     std::vector<uint8_t> signature;
     time_t validFrom;
     time_t validUntil;
+    std::vector<uint8_t> der;   // encoded certificate, for chain verification
 };
 
 class CryptoModule {
@@ -42,6 +56,12 @@ public:
 
     // Key management
     bool generateKeyPair(SignatureAlgorithm algo = SignatureAlgorithm::ECDSA);
+    const SignatureBackend* getSignatureBackend() const { return signatureBackend; }
+
+    // Signing identity (private key and message sequence counter) in a form
+    // that can be moved to another process, e.g. a vehicle changing MPI rank
+    bool exportIdentity(std::vector<uint8_t>& out) const;
+    bool importIdentity(ByteView identity);
     bool loadPrivateKey(const std::string& keyPath);
     bool loadPublicKey(const std::string& keyPath);
     bool loadCertificate(const std::string& certPath);
@@ -55,25 +75,169 @@ public:
                         const std::vector<uint8_t>& signature,
                         const std::vector<uint8_t>& publicKey);
 
-    // Certificate operations
+    // Scatter-gather variants: segments are digested in order, as if concatenated
+    std::vector<uint8_t> signSegments(const ByteSegments& segments);
+    bool verifySegments(const ByteSegments& segments, ByteView signature, ByteView senderCert);
+
+    // Certificate operations. Sender certificates must chain to a trust
+    // anchor through at most MAX_CERT_CHAIN certificates; results are cached
+    // per fingerprint until the chain expires (see TrustStore). Modules
+    // share one process-wide store, so a fleet under the same CA sets up
+    // anchors and validates each chain once; setTrustStore() gives a module
+    // its own, and nullptr goes back to the shared one. Once a store has
+    // anchors, senders presenting a bare public key are rejected.
     bool verifyCertificate(const Certificate& cert);
     bool isCertificateExpired(const Certificate& cert) const;
+    bool addTrustAnchor(ByteView der) { return trustStore->addTrustAnchor(der); }
+    bool addIntermediateCertificate(ByteView der) { return trustStore->addIntermediate(der); }
+    // Revoked certificates, and every leaf under a revoked CA, stop verifying at once
+    void revokeCertificate(ByteView der);
+    const TrustStore::Stats& getTrustStoreStats() const { return trustStore->stats(); }
+    void setTrustStore(std::shared_ptr<TrustStore> store);
+    static std::shared_ptr<TrustStore> sharedTrustStore();
     
     // Secure message packaging
+    // Buffers come from the allocator passed at construction, e.g. a
+    // MessageArena that is reset once the packet has been sent
     struct SecureMessage {
-        std::vector<uint8_t> payload;
-        std::vector<uint8_t> signature;
+        using allocator_type = std::pmr::polymorphic_allocator<uint8_t>;
+
+        std::pmr::vector<uint8_t> payload;
+        std::pmr::vector<uint8_t> signature;
         uint64_t timestamp;
         uint32_t sequenceNumber;
-        std::vector<uint8_t> senderCert;
+        std::pmr::vector<uint8_t> senderCert;
+        // Session mode only: the X25519 offer of a signed message, and the
+        // SessionTable entries of the neighbors it is authenticated to
+        std::pmr::vector<uint8_t> sessionOffer;
+        std::pmr::vector<uint8_t> sessionTags;
+
+        SecureMessage() : SecureMessage(allocator_type()) {}
+        explicit SecureMessage(const allocator_type& alloc)
+            : payload(alloc), signature(alloc), timestamp(0), sequenceNumber(0), senderCert(alloc),
+              sessionOffer(alloc), sessionTags(alloc) {}
+    };
+
+    // Borrowed form of SecureMessage, e.g. pointing straight into a received
+    // packet buffer. Verification and replay checks only need this form.
+    struct SecureMessageView {
+        ByteView payload;
+        ByteView signature;
+        uint64_t timestamp;
+        uint32_t sequenceNumber;
+        ByteView senderCert;
+        ByteView sessionOffer;
+        ByteView sessionTags;
+
+        SecureMessageView() : timestamp(0), sequenceNumber(0) {}
+        SecureMessageView(const SecureMessage& msg)
+            : payload(msg.payload), signature(msg.signature), timestamp(msg.timestamp),
+              sequenceNumber(msg.sequenceNumber), senderCert(msg.senderCert),
+              sessionOffer(msg.sessionOffer), sessionTags(msg.sessionTags) {}
+
+        // Signed input: payload + timestamp + sequence number, then the
+        // session offer if there is one. Session tags cover the same input.
+        ByteSegments signedSegments() const {
+            ByteSegments segments(payload, ByteView::of(timestamp), ByteView::of(sequenceNumber));
+            if (!sessionOffer.empty()) {
+                segments.add(sessionOffer);
+            }
+            return segments;
+        }
+
+        // Bytes on the air once serialized, timestamp and sequence number included
+        size_t wireSize() const {
+            return payload.size() + signature.size() + sizeof(timestamp) + sizeof(sequenceNumber) +
+                   senderCert.size() + sessionOffer.size() + sessionTags.size();
+        }
     };
 
     SecureMessage createSecureMessage(const std::vector<uint8_t>& payload);
-    bool verifySecureMessage(const SecureMessage& message);
+    SecureMessage createSecureMessage(ByteView payload);
+    SecureMessage createSecureMessage(ByteView payload, std::pmr::memory_resource* resource);
+    bool verifySecureMessage(const SecureMessageView& message);
+
+    // Offloaded variants. Timestamp, sequence number, replay and credential
+    // checks happen now on the calling thread; only the signature work runs on
+    // the engine. Callbacks run from the engine's delivery calls, and the
+    // views they get are only valid during the call. A message rejected
+    // before reaching the engine gets its callback immediately and ticket 0.
+    using SignedCallback = std::function<void(bool ok, const SecureMessageView& message)>;
+    using VerifiedCallback = std::function<void(bool ok)>;
+    uint64_t createSecureMessageAsync(ByteView payload, CryptoEngine& engine, SignedCallback done);
+    uint64_t verifySecureMessageAsync(const SecureMessageView& message, CryptoEngine& engine,
+                                      VerifiedCallback done);
+    // Wire size of a message signed by createSecureMessageAsync(), for
+    // callers that need it before delivery. Assumes the largest signature
+    // the key can make; DER-encoded ECDSA signatures come out a few bytes shorter.
+    size_t signedWireSize(size_t payloadSize);
+
+    // Verifies a whole beacon interval in one call. Messages are grouped by
+    // sender credential so each key is parsed once, and a single digest
+    // context is reused across the batch. Entry i of the result is the
+    // verdict for messages[i].
+    std::vector<bool> verifySecureMessageBatch(const std::vector<SecureMessage>& messages);
+    std::vector<bool> verifySecureMessageBatch(const std::vector<SecureMessageView>& messages);
+
+    // Symmetric fast path between neighbors. With sessions enabled, signed
+    // messages carry this node's key exchange offer, and verifying one with
+    // an offer opens a session with its sender (see SessionTable).
+    // createSessionMessage() authenticates to every open session with an
+    // HMAC tag and only signs every REAUTH_INTERVAL_MS, or while no session
+    // is open, so that new neighbors can join; messages that must be
+    // non-repudiable go through createSecureMessage(), which always signs.
+    // verifySecureMessage() accepts a valid tag from a session peer in
+    // place of the signature on messages that carry no offer, signature
+    // or credential; messages with an offer have their signature checked
+    // to renew the session. Sessions are dropped when
+    // the key changes.
+    static constexpr uint64_t REAUTH_INTERVAL_MS = 5000;
+    struct SessionStats {
+        uint64_t opened;          // sessions derived from verified offers
+        uint64_t tagged;          // session messages sent without a signature
+        uint64_t reauthenticated; // session messages that also carried a signature
+        uint64_t tagsVerified;    // messages accepted on a session tag
+    };
+    bool enableSessions(bool enabled);
+    bool sessionsEnabled() const { return sessions != nullptr; }
+    size_t openSessions() const { return sessions ? sessions->size() : 0; }
+    SecureMessage createSessionMessage(ByteView payload, std::pmr::memory_resource* resource);
+    const SessionStats& getSessionStats() const { return sessionStats; }
+
+    // Signatures made and checked, offloaded ones counted at submission
+    struct OperationStats {
+        uint64_t signatures;
+        uint64_t verifications;
+    };
+    const OperationStats& getOperationStats() const { return operationStats; }
+
+    // Parsed sender credential cache counters
+    const KeyCache::Stats& getKeyCacheStats() const { return keyCache.stats(); }
+
+    // Offline/online signing for ECDSA keys: up to poolDepth per-signature
+    // nonces are precomputed by refillSigningPool(), which the owner calls
+    // when idle, and signing takes one when available. The pool follows
+    // key changes. 0 turns it off; false if the key is not ECDSA.
+    bool enablePresigning(size_t poolDepth);
+    size_t refillSigningPool(size_t maxEntries = SIZE_MAX);
+    SigningPool::Stats getSigningPoolStats() const;
+
+    // Sign, verify and replay-check latencies go to this recorder when built
+    // with VANET_INSTRUMENTATION. Not owned; nullptr records nothing.
+    void setInstrumentation(Instrumentation* recorder) { instrumentation = recorder; }
+
+    // Time source for timestamps, freshness, replay windows and certificate
+    // validity. Not owned; nullptr goes back to the wall clock.
+    void setClock(const Clock* source) { clock = source ? source : &Clock::system(); }
 
     // Replay attack prevention
-    bool isReplayMessage(const SecureMessage& message);
-    void updateMessageHistory(const SecureMessage& message);
+    bool isReplayMessage(const SecureMessageView& message);
+    void updateMessageHistory(const SecureMessageView& message);
+    // Who a verified message came from, as replay windows are keyed: a hash
+    // of its credential, or of the session peer's for tagged messages
+    uint64_t senderIdentity(const SecureMessageView& message) const {
+        return senderIdentity(message, clock->nowMillis());
+    }
 
 private:
     // OpenSSL context and key storage
@@ -81,19 +245,48 @@ private:
     EVP_PKEY* publicKey;
     X509* certificate;
 
-    // Message history for replay prevention
-    struct MessageHistory {
-        uint64_t timestamp;
-        uint32_t sequenceNumber;
-        std::vector<uint8_t> messageHash;
-    };
-    std::vector<MessageHistory> messageHistory;
+    // Backend-prepared signing state for privateKey
+    const SignatureBackend* signatureBackend;
+    std::unique_ptr<Signer> signer;
+    // Used instead of signer when presigning is enabled
+    std::unique_ptr<SigningPool> signingPool;
+    size_t presignDepth;
+
+    // Parsed sender keys/certificates, keyed by DER hash
+    KeyCache keyCache;
+    std::shared_ptr<TrustStore> trustStore;
+
+    // Per-sender sequence windows for replay prevention
+    ReplayWindow replayWindow;
+    uint32_t nextSequence;
+
+    // Encoded own credential and signing scratch, reused for every message
+    std::vector<uint8_t> ownCredential;
+    std::vector<uint8_t> signatureScratch;
+
+    Instrumentation* instrumentation;
+    const Clock* clock;
+
+    // Neighbor sessions, nullptr unless enabled
+    std::unique_ptr<SessionTable> sessions;
+    uint64_t lastSignedMs;
+    SessionStats sessionStats;
+    OperationStats operationStats;
 
     // Helper functions
-    void initializeOpenSSL();
+    ByteView ownCredentialDer();
+    Signer* activeSigner() { return signingPool ? signingPool.get() : signer.get(); }
+    bool isSessionTagged(const SecureMessageView& message) const;
+    bool replaceKey(EVP_PKEY* key, const SignatureBackend* backend, std::unique_ptr<Signer> newSigner);
+    static void initializeOpenSSL();
     void cleanupOpenSSL();
-    bool isValidTimestamp(uint64_t timestamp) const;
-    void pruneMessageHistory();
+    bool isValidTimestamp(uint64_t timestamp, uint64_t nowMs) const;
+    bool isReplayMessage(const SecureMessageView& message, uint64_t nowMs);
+    uint64_t senderIdentity(const SecureMessageView& message, uint64_t nowMs) const;
+    void signInto(SecureMessage& msg);
+    KeyCache::Entry* resolveSender(ByteView senderCert);
+    static Certificate describeCertificate(X509* cert);
+    bool verifyWithKey(KeyCache::Entry& sender, const ByteSegments& segments, ByteView signature);
 };
 
 } // namespace crypto
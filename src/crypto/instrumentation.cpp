@@ -0,0 +1,143 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace vanet {
+namespace crypto {
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::SIGN: return "sign";
+        case Stage::VERIFY: return "verify";
+        case Stage::REPLAY_CHECK: return "replay_check";
+        case Stage::TRUST: return "trust";
+        case Stage::ROUTE_LOOKUP: return "route_lookup";
+        case Stage::PRUNE: return "prune";
+    }
+    return "unknown";
+}
+
+static unsigned highestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t nanos) {
+    if (nanos < SUB_BUCKETS) {
+        return static_cast<size_t>(nanos);
+    }
+    unsigned magnitude = highestBit(nanos);
+    if (magnitude >= MAX_MAGNITUDE) {
+        return BUCKETS - 1;
+    }
+    // Top SUB_BUCKET_BITS + 1 bits of the value; the leading one picks the group
+    size_t group = magnitude - SUB_BUCKET_BITS + 1;
+    size_t sub = static_cast<size_t>(nanos >> (magnitude - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+    return group * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketLow(size_t bucket) {
+    size_t group = bucket / SUB_BUCKETS;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return group == 0 ? sub : (sub + SUB_BUCKETS) << (group - 1);
+}
+
+uint64_t LatencyHistogram::bucketHigh(size_t bucket) {
+    size_t group = bucket / SUB_BUCKETS;
+    return group == 0 ? bucketLow(bucket) : bucketLow(bucket) + (uint64_t(1) << (group - 1)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    if (counts.empty()) {
+        counts.assign(BUCKETS, 0);
+    }
+    ++counts[bucketOf(nanos)];
+    ++total;
+    sum += nanos;
+    minValue = std::min(minValue, nanos);
+    maxValue = std::max(maxValue, nanos);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.total == 0) {
+        return;
+    }
+    if (counts.empty()) {
+        counts.assign(BUCKETS, 0);
+    }
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    minValue = UINT64_MAX;
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::valueAtQuantile(double q) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketHigh(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+void Instrumentation::merge(const Instrumentation& other) {
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        stages[i].merge(other.stages[i]);
+    }
+}
+
+void Instrumentation::reset() {
+    for (auto& stage : stages) {
+        stage.reset();
+    }
+}
+
+void Instrumentation::writeCsvHeader(std::ostream& out) {
+    out << "node,stage,low_ns,high_ns,count\n";
+}
+
+void Instrumentation::writeCsv(std::ostream& out, const std::string& node) const {
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const LatencyHistogram& histogram = stages[i];
+        if (histogram.count() == 0) {
+            continue;
+        }
+        const char* name = stageName(static_cast<Stage>(i));
+        for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+            uint64_t count = histogram.bucketCount(bucket);
+            if (count) {
+                out << node << ',' << name << ',' << LatencyHistogram::bucketLow(bucket) << ','
+                    << LatencyHistogram::bucketHigh(bucket) << ',' << count << '\n';
+            }
+        }
+    }
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,135 @@
+#ifndef VANET_INSTRUMENTATION_H
+#define VANET_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vanet {
+namespace crypto {
+
+// Hot-path stages timed per node
+enum class Stage : uint8_t {
+    SIGN,
+    VERIFY,
+    REPLAY_CHECK,
+    TRUST,
+    ROUTE_LOOKUP,
+    PRUNE
+};
+
+constexpr size_t STAGE_COUNT = 6;
+
+const char* stageName(Stage stage);
+
+// Log-linear latency histogram in the style of HdrHistogram. Values below
+// 2^SUB_BUCKET_BITS ns are kept exactly; every power of two above that is
+// split into 2^SUB_BUCKET_BITS buckets, so any recorded value is known to
+// within ~3%. Buckets are allocated on the first record().
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr unsigned MAX_MAGNITUDE = 36;   // 2^36 ns, about 68 s
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(uint64_t nanos);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minValue : 0; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+    // Highest value equivalent to the one at quantile q in [0, 1]
+    uint64_t valueAtQuantile(double q) const;
+
+    uint64_t bucketCount(size_t bucket) const { return counts.empty() ? 0 : counts[bucket]; }
+    static size_t bucketOf(uint64_t nanos);
+    static uint64_t bucketLow(size_t bucket);
+    static uint64_t bucketHigh(size_t bucket);
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t minValue = UINT64_MAX;
+    uint64_t maxValue = 0;
+};
+
+// Latency and call counters for one node. A recorder is written only by the
+// thread that drives its node, so recording needs no atomics; recorders of
+// several nodes or threads are combined with merge().
+class Instrumentation {
+public:
+    void record(Stage stage, uint64_t nanos) { stages[static_cast<size_t>(stage)].record(nanos); }
+    const LatencyHistogram& latency(Stage stage) const { return stages[static_cast<size_t>(stage)]; }
+    uint64_t calls(Stage stage) const { return latency(stage).count(); }
+
+    void merge(const Instrumentation& other);
+    void reset();
+
+    // One row per non-empty bucket: node,stage,low_ns,high_ns,count
+    void writeCsv(std::ostream& out, const std::string& node) const;
+    static void writeCsvHeader(std::ostream& out);
+
+    static uint64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    LatencyHistogram stages[STAGE_COUNT];
+};
+
+// Times one stage into a recorder, if there is one. Built with
+// VANET_INSTRUMENTATION undefined the timers are empty and compile away.
+#ifdef VANET_INSTRUMENTATION
+constexpr bool INSTRUMENTATION_ENABLED = true;
+
+class StageTimer {
+public:
+    StageTimer(Instrumentation* recorder, Stage stage)
+        : recorder(recorder), stage(stage), started(recorder ? Instrumentation::nowNanos() : 0) {}
+
+    void stop() {
+        if (recorder) {
+            recorder->record(stage, Instrumentation::nowNanos() - started);
+            recorder = nullptr;
+        }
+    }
+
+private:
+    Instrumentation* recorder;
+    Stage stage;
+    uint64_t started;
+};
+#else
+constexpr bool INSTRUMENTATION_ENABLED = false;
+
+class StageTimer {
+public:
+    StageTimer(Instrumentation*, Stage) {}
+    void stop() {}
+};
+#endif
+
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(Instrumentation* recorder, Stage stage) : timer(recorder, stage) {}
+    ~ScopedStageTimer() { timer.stop(); }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    StageTimer timer;
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_INSTRUMENTATION_H
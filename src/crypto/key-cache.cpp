@@ -0,0 +1,87 @@
+#include "key-cache.h"
+
+namespace vanet {
+namespace crypto {
+
+KeyCache::KeyCache(size_t capacity) : capacity(capacity), counters{0, 0, 0} {
+    index.reserve(capacity);
+}
+
+KeyCache::~KeyCache() {
+    clear();
+}
+
+KeyCache::Entry* KeyCache::lookup(ByteView der) {
+    if (der.empty()) {
+        return nullptr;
+    }
+
+    uint64_t hash = hashDer(der);
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        if (ByteView(it->second->der) == der) {
+            ++counters.hits;
+            entries.splice(entries.begin(), entries, it->second);
+            return &entries.front();
+        }
+        // Hash collision: drop the old entry, the new credential replaces it
+        release(*it->second);
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    ++counters.misses;
+
+    Entry entry{der.toVector(), nullptr, nullptr, nullptr, false, 0, 0};
+    const unsigned char* data = der.data();
+    entry.cert = d2i_X509(nullptr, &data, der.size());
+    if (entry.cert) {
+        entry.key = X509_get_pubkey(entry.cert);
+    } else {
+        data = der.data();
+        entry.key = d2i_PUBKEY(nullptr, &data, der.size());
+    }
+    if (!entry.key) {
+        release(entry);
+        return nullptr;
+    }
+
+    if (entries.size() >= capacity) {
+        release(entries.back());
+        index.erase(hashDer(entries.back().der));
+        entries.pop_back();
+        ++counters.evictions;
+    }
+
+    entries.push_front(std::move(entry));
+    index[hash] = entries.begin();
+    return &entries.front();
+}
+
+void KeyCache::clear() {
+    for (auto& entry : entries) {
+        release(entry);
+    }
+    entries.clear();
+    index.clear();
+}
+
+uint64_t KeyCache::hashDer(ByteView der) {
+    // FNV-1a; entries also keep the DER bytes so a collision is never a false hit
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t byte : der) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void KeyCache::release(Entry& entry) {
+    entry.verifier.reset();
+    if (entry.key) EVP_PKEY_free(entry.key);
+    if (entry.cert) X509_free(entry.cert);
+    entry.key = nullptr;
+    entry.cert = nullptr;
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,71 @@
+#ifndef VANET_KEY_CACHE_H
+#define VANET_KEY_CACHE_H
+
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include "byte-view.h"
+#include "signature-backend.h"
+
+namespace vanet {
+namespace crypto {
+
+// Bounded LRU of parsed sender credentials, keyed by a hash of the DER bytes.
+// Neighbors resend the same certificate with every beacon, so after the first
+// message the d2i_X509/d2i_PUBKEY parse becomes a hash and a memcmp.
+class KeyCache {
+public:
+    struct Entry {
+        std::vector<uint8_t> der;
+        EVP_PKEY* key;
+        X509* cert;              // nullptr for a bare SubjectPublicKeyInfo
+        std::unique_ptr<Verifier> verifier;  // built on first use
+        bool certVerified;       // cached verifyCertificate() outcome
+        time_t verifiedUntil;    // outcome is reused until cert validUntil
+        uint64_t verifiedRevocations;  // TrustStore::revocations() it was reached at
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+    };
+
+    explicit KeyCache(size_t capacity);
+    ~KeyCache();
+
+    KeyCache(const KeyCache&) = delete;
+    KeyCache& operator=(const KeyCache&) = delete;
+
+    // Returns the cached entry for the credential, parsing and inserting it
+    // on a miss. Returns nullptr if the bytes are neither a certificate nor a
+    // public key. The pointer stays valid until the next call to lookup().
+    Entry* lookup(ByteView der);
+
+    void clear();
+    size_t size() const { return entries.size(); }
+    const Stats& stats() const { return counters; }
+
+    // FNV-1a over the DER bytes; also used as the sender identity elsewhere
+    static uint64_t hashDer(ByteView der);
+
+private:
+    using EntryList = std::list<Entry>;
+
+    size_t capacity;
+    EntryList entries;   // most recently used first
+    std::unordered_map<uint64_t, EntryList::iterator> index;
+    Stats counters;
+
+    static void release(Entry& entry);
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_KEY_CACHE_H
@@ -0,0 +1,115 @@
+#include "key-provisioning.h"
+#include "crypto-module.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace vanet {
+namespace crypto {
+
+namespace {
+
+constexpr uint32_t FLEET_KEYS_MAGIC = 0x5956454B;  // "KEVY" little-endian
+constexpr uint32_t FLEET_KEYS_VERSION = 1;
+constexpr uint32_t MAX_IDENTITY_SIZE = 1 << 16;    // Far above any supported key
+
+void writeU32(std::ostream& out, uint32_t value) {
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool readU32(std::istream& in, uint32_t& value) {
+    uint8_t bytes[4];
+    if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    }
+    return true;
+}
+
+} // namespace
+
+void parallelFor(size_t count, size_t threads, const std::function<void(size_t)>& fn) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, count);
+
+    // Indices are claimed one at a time, so uneven work still balances
+    std::atomic<size_t> next(0);
+    auto work = [&] {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool FleetKeys::generate(size_t count, SignatureAlgorithm algo, size_t threads) {
+    std::vector<std::vector<uint8_t>> generated(count);
+    std::atomic<bool> ok(true);
+    parallelFor(count, threads, [&](size_t i) {
+        CryptoModule module;
+        if (!module.generateKeyPair(algo) || !module.exportIdentity(generated[i])) {
+            ok = false;
+        }
+    });
+    if (!ok) {
+        return false;
+    }
+    identities = std::move(generated);
+    return true;
+}
+
+bool FleetKeys::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    writeU32(out, FLEET_KEYS_MAGIC);
+    writeU32(out, FLEET_KEYS_VERSION);
+    writeU32(out, static_cast<uint32_t>(identities.size()));
+    for (const auto& identity : identities) {
+        writeU32(out, static_cast<uint32_t>(identity.size()));
+        out.write(reinterpret_cast<const char*>(identity.data()), static_cast<std::streamsize>(identity.size()));
+    }
+    return static_cast<bool>(out.flush());
+}
+
+bool FleetKeys::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    uint32_t magic = 0, version = 0, count = 0;
+    if (!readU32(in, magic) || magic != FLEET_KEYS_MAGIC || !readU32(in, version) ||
+        version != FLEET_KEYS_VERSION || !readU32(in, count)) {
+        return false;
+    }
+
+    std::vector<std::vector<uint8_t>> loaded;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t size = 0;
+        if (!readU32(in, size) || size == 0 || size > MAX_IDENTITY_SIZE) {
+            return false;
+        }
+        std::vector<uint8_t> identity(size);
+        if (!in.read(reinterpret_cast<char*>(identity.data()), size)) {
+            return false;
+        }
+        loaded.push_back(std::move(identity));
+    }
+    identities = std::move(loaded);
+    return true;
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,45 @@
+#ifndef VANET_KEY_PROVISIONING_H
+#define VANET_KEY_PROVISIONING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "byte-view.h"
+
+namespace vanet {
+namespace crypto {
+
+enum class SignatureAlgorithm;
+
+// Runs fn(i) for every i in [0, count) on up to threads workers, the
+// calling thread included, and returns once all are done. fn must only
+// touch state that belongs to its own index.
+void parallelFor(size_t count, size_t threads, const std::function<void(size_t)>& fn);
+
+// Signing identities for a whole fleet, each in the form of
+// CryptoModule::exportIdentity(), for CryptoModule::importIdentity().
+// Generated on worker threads, or loaded from a file saved by an earlier
+// run, so that large simulations do not create thousands of keys one after
+// the other at startup. The file holds private keys in the clear: it is
+// meant for simulated fleets only.
+class FleetKeys {
+public:
+    // Replaces the contents with count fresh identities; threads 0 uses
+    // every core
+    bool generate(size_t count, SignatureAlgorithm algo, size_t threads = 0);
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    size_t size() const { return identities.size(); }
+    ByteView identity(size_t i) const { return identities[i]; }
+
+private:
+    std::vector<std::vector<uint8_t>> identities;
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_KEY_PROVISIONING_H
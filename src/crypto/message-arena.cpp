@@ -0,0 +1,68 @@
+#include "message-arena.h"
+#include <utility>
+
+namespace vanet {
+namespace crypto {
+
+MessageArena::MessageArena(size_t blockSize, std::pmr::memory_resource* upstream)
+    : blockSize(blockSize ? blockSize : DEFAULT_BLOCK_SIZE), upstream(upstream),
+      current(0), offset(0), totals{0, 0, 0, 0}, allocationsAtReset(0), upstreamAtReset(0) {}
+
+MessageArena::~MessageArena() {
+    for (const auto& block : blocks) {
+        upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+    }
+}
+
+void MessageArena::reset() {
+    current = 0;
+    offset = 0;
+    ++totals.resets;
+    allocationsAtReset = totals.allocations;
+    upstreamAtReset = totals.upstreamAllocations;
+}
+
+size_t MessageArena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+void* MessageArena::do_allocate(size_t bytes, size_t alignment) {
+    ++totals.allocations;
+    totals.bytes += bytes;
+
+    if (current < blocks.size()) {
+        size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= blocks[current].size) {
+            offset = aligned + bytes;
+            return blocks[current].data + aligned;
+        }
+    }
+
+    // Move on to the next retained block that fits, or take a new one.
+    // Blocks are aligned to max_align_t, so offset 0 suits any request.
+    size_t next = blocks.empty() ? 0 : current + 1;
+    size_t fit = next;
+    while (fit < blocks.size() && blocks[fit].size < bytes) {
+        ++fit;
+    }
+    if (fit == blocks.size()) {
+        size_t size = bytes > blockSize ? bytes : blockSize;
+        auto* data = static_cast<uint8_t*>(upstream->allocate(size, alignof(std::max_align_t)));
+        blocks.push_back(Block{data, size});
+        ++totals.upstreamAllocations;
+    }
+    if (fit != next) {
+        std::swap(blocks[fit], blocks[next]);
+    }
+
+    current = next;
+    offset = bytes;
+    return blocks[current].data;
+}
+
+} // namespace crypto
+} // namespace vanet
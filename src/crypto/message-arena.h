@@ -0,0 +1,71 @@
+#ifndef VANET_MESSAGE_ARENA_H
+#define VANET_MESSAGE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace vanet {
+namespace crypto {
+
+// Bump allocator for short-lived per-packet objects (routing messages,
+// SecureMessage buffers). Deallocation is a no-op; reset() releases
+// everything at once but keeps the blocks, so once the arena has grown to
+// the working set no further heap allocations happen.
+//
+// Counts every allocation it serves and every block it has to take from
+// the upstream resource, both in total and since the last reset, so callers
+// can report the cost of a single packet.
+class MessageArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+    struct Stats {
+        uint64_t allocations;          // requests served
+        uint64_t bytes;                // bytes handed out
+        uint64_t upstreamAllocations;  // blocks taken from the heap
+        uint64_t resets;
+    };
+
+    explicit MessageArena(size_t blockSize = DEFAULT_BLOCK_SIZE,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~MessageArena() override;
+
+    MessageArena(const MessageArena&) = delete;
+    MessageArena& operator=(const MessageArena&) = delete;
+
+    void reset();
+
+    const Stats& stats() const { return totals; }
+    uint64_t allocationsSinceReset() const { return totals.allocations - allocationsAtReset; }
+    uint64_t upstreamSinceReset() const { return totals.upstreamAllocations - upstreamAtReset; }
+    size_t capacity() const;
+
+private:
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+
+    size_t blockSize;
+    std::pmr::memory_resource* upstream;
+    std::vector<Block> blocks;
+    size_t current;   // block being bumped
+    size_t offset;    // next free byte in it
+
+    Stats totals;
+    uint64_t allocationsAtReset;
+    uint64_t upstreamAtReset;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_MESSAGE_ARENA_H
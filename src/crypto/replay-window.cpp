@@ -0,0 +1,146 @@
+#include "replay-window.h"
+
+namespace vanet {
+namespace crypto {
+
+// Slots probed per sender before the table grows
+constexpr size_t MAX_PROBE = 8;
+
+ReplayWindow::ReplayWindow(size_t slotCount, uint64_t bucketWidthMs, uint32_t bucketCount)
+    : bucketWidthMs(bucketWidthMs ? bucketWidthMs : 1), bucketCount(bucketCount) {
+    // Round up to a power of two so probing is a mask instead of a modulo
+    size_t size = 1;
+    while (size < slotCount) {
+        size <<= 1;
+    }
+    slots.assign(size, Slot{0, 0, 0, 0, false});
+    mask = size - 1;
+}
+
+bool ReplayWindow::isReplay(uint64_t senderId, uint32_t sequence, uint64_t nowMs) const {
+    const Slot* slot = find(senderId, nowMs);
+    if (!slot || sequence > slot->highest) {
+        return false;
+    }
+
+    uint32_t offset = slot->highest - sequence;
+    if (offset >= WINDOW_BITS) {
+        return true;
+    }
+    return (slot->bitmap >> offset) & 1;
+}
+
+void ReplayWindow::record(uint64_t senderId, uint32_t sequence, uint64_t nowMs) {
+    Slot& slot = claim(senderId, nowMs);
+    slot.bucket = nowMs / bucketWidthMs;
+
+    if (!slot.used) {
+        slot.used = true;
+        slot.senderId = senderId;
+        slot.highest = sequence;
+        slot.bitmap = 1;
+        return;
+    }
+
+    if (sequence > slot.highest) {
+        uint32_t shift = sequence - slot.highest;
+        slot.bitmap = shift >= WINDOW_BITS ? 0 : slot.bitmap << shift;
+        slot.bitmap |= 1;
+        slot.highest = sequence;
+    } else {
+        uint32_t offset = slot.highest - sequence;
+        if (offset < WINDOW_BITS) {
+            slot.bitmap |= uint64_t(1) << offset;
+        }
+    }
+}
+
+void ReplayWindow::clear() {
+    for (auto& slot : slots) {
+        slot.used = false;
+    }
+}
+
+size_t ReplayWindow::activeSenders(uint64_t nowMs) const {
+    size_t count = 0;
+    for (const auto& slot : slots) {
+        if (isLive(slot, nowMs)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool ReplayWindow::isLive(const Slot& slot, uint64_t nowMs) const {
+    // A record late in its bucket must still be live a full
+    // bucketWidth * bucketCount later, hence one bucket beyond the ring
+    return slot.used && (nowMs / bucketWidthMs) - slot.bucket <= bucketCount;
+}
+
+const ReplayWindow::Slot* ReplayWindow::find(uint64_t senderId, uint64_t nowMs) const {
+    size_t start = senderId & mask;
+    for (size_t i = 0; i < MAX_PROBE && i <= mask; ++i) {
+        const Slot& slot = slots[(start + i) & mask];
+        if (slot.used && slot.senderId == senderId) {
+            return isLive(slot, nowMs) ? &slot : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+ReplayWindow::Slot& ReplayWindow::claim(uint64_t senderId, uint64_t nowMs) {
+    size_t start = senderId & mask;
+    Slot* free = nullptr;
+    for (size_t i = 0; i < MAX_PROBE && i <= mask; ++i) {
+        Slot& slot = slots[(start + i) & mask];
+        if (slot.used && slot.senderId == senderId) {
+            if (!isLive(slot, nowMs)) {
+                slot.used = false;
+            }
+            return slot;
+        }
+        if (!free && !isLive(slot, nowMs)) {
+            free = &slot;
+        }
+    }
+    if (free) {
+        free->used = false;
+        return *free;
+    }
+
+    // Every probed slot still guards a live sender, whose old messages
+    // would pass again if it were evicted: make room instead
+    grow(nowMs);
+    return claim(senderId, nowMs);
+}
+
+void ReplayWindow::grow(uint64_t nowMs) {
+    std::vector<Slot> old;
+    old.swap(slots);
+    size_t size = old.size();
+    bool placed = false;
+    while (!placed) {
+        size <<= 1;
+        slots.assign(size, Slot{0, 0, 0, 0, false});
+        mask = size - 1;
+        placed = true;
+        for (const auto& slot : old) {
+            if (!isLive(slot, nowMs)) {
+                continue;
+            }
+            size_t start = slot.senderId & mask;
+            size_t i = 0;
+            while (i < MAX_PROBE && i <= mask && slots[(start + i) & mask].used) {
+                ++i;
+            }
+            if (i == MAX_PROBE || i > mask) {
+                placed = false;
+                break;
+            }
+            slots[(start + i) & mask] = slot;
+        }
+    }
+}
+
+} // namespace crypto
+} // namespace vanet
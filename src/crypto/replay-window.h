@@ -0,0 +1,60 @@
+#ifndef VANET_REPLAY_WINDOW_H
+#define VANET_REPLAY_WINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vanet {
+namespace crypto {
+
+// Anti-replay filter modelled on the IPsec sequence window
+// (RFC 4303, section 3.4.3). Each sender owns a slot holding its highest
+// accepted sequence number and a bitmap of the WINDOW_BITS numbers below it,
+// so lookup and insert are constant time regardless of traffic volume.
+//
+// Slots are stamped with a coarse time bucket. A slot stays live for at
+// least bucketWidth * bucketCount after its last record(); once its bucket
+// has fallen out of the ring it is free for reuse, which replaces the
+// periodic history prune with nothing at all. A live slot is never
+// reused: when every slot a sender may probe is live the table doubles
+// instead, so that its old messages cannot pass again.
+class ReplayWindow {
+public:
+    static constexpr uint32_t WINDOW_BITS = 64;
+
+    ReplayWindow(size_t slotCount, uint64_t bucketWidthMs, uint32_t bucketCount);
+
+    // True if (sender, sequence) was already recorded or is too far behind
+    // the sender's window to be judged
+    bool isReplay(uint64_t senderId, uint32_t sequence, uint64_t nowMs) const;
+    void record(uint64_t senderId, uint32_t sequence, uint64_t nowMs);
+
+    void clear();
+    size_t activeSenders(uint64_t nowMs) const;
+    size_t capacity() const { return slots.size(); }
+
+private:
+    struct Slot {
+        uint64_t senderId;
+        uint64_t bitmap;       // bit n set => (highest - n) seen
+        uint64_t bucket;       // time bucket of the last record()
+        uint32_t highest;
+        bool used;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+    uint64_t bucketWidthMs;
+    uint32_t bucketCount;
+
+    bool isLive(const Slot& slot, uint64_t nowMs) const;
+    const Slot* find(uint64_t senderId, uint64_t nowMs) const;
+    Slot& claim(uint64_t senderId, uint64_t nowMs);
+    void grow(uint64_t nowMs);
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_REPLAY_WINDOW_H
@@ -0,0 +1,255 @@
+#include "session-table.h"
+#include "context-pool.h"
+#include "crypto-module.h"
+#include <algorithm>
+#include <cstring>
+#include <openssl/crypto.h>
+#include <openssl/kdf.h>
+
+namespace vanet {
+namespace crypto {
+
+constexpr size_t HMAC_BLOCK_SIZE = 64;     // SHA-256 input block
+constexpr size_t SESSION_KEY_SIZE = 32;    // per-direction HMAC key
+constexpr char SESSION_LABEL[] = "vanet neighbor session v1";
+
+static uint64_t loadId(const uint8_t* p) {
+    uint64_t id = 0;
+    for (int i = 7; i >= 0; --i) {
+        id = (id << 8) | p[i];
+    }
+    return id;
+}
+
+SessionTable::SessionTable(size_t capacity, uint64_t lifetimeMs)
+    : capacity(std::max<size_t>(capacity, 1)), lifetimeMs(lifetimeMs), exchangeKey(nullptr) {
+    std::memset(ownOffer, 0, sizeof(ownOffer));
+
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_X25519, nullptr);
+    size_t len = OFFER_SIZE;
+    if (!ctx || EVP_PKEY_keygen_init(ctx) <= 0 || EVP_PKEY_keygen(ctx, &exchangeKey) <= 0 ||
+        EVP_PKEY_get_raw_public_key(exchangeKey, ownOffer, &len) <= 0 || len != OFFER_SIZE) {
+        EVP_PKEY_free(exchangeKey);
+        exchangeKey = nullptr;
+    }
+    EVP_PKEY_CTX_free(ctx);
+}
+
+SessionTable::~SessionTable() {
+    for (auto& session : sessions) {
+        release(session.send);
+        release(session.receive);
+    }
+    EVP_PKEY_free(exchangeKey);
+}
+
+bool SessionTable::expand(MacKey& key, const uint8_t* secret, size_t length) {
+    // RFC 2104: later tags start from copies of these states
+    const EVP_MD* md = ContextPool::digest(HashAlgorithm::SHA256);
+    uint8_t pad[HMAC_BLOCK_SIZE];
+    key.inner = EVP_MD_CTX_new();
+    key.outer = EVP_MD_CTX_new();
+    if (!md || !key.inner || !key.outer || length > HMAC_BLOCK_SIZE) {
+        return false;
+    }
+
+    std::memset(pad, 0x36, sizeof(pad));
+    for (size_t i = 0; i < length; ++i) {
+        pad[i] ^= secret[i];
+    }
+    bool ok = EVP_DigestInit_ex(key.inner, md, nullptr) > 0 &&
+              EVP_DigestUpdate(key.inner, pad, sizeof(pad)) > 0;
+
+    std::memset(pad, 0x5c, sizeof(pad));
+    for (size_t i = 0; i < length; ++i) {
+        pad[i] ^= secret[i];
+    }
+    ok = ok && EVP_DigestInit_ex(key.outer, md, nullptr) > 0 &&
+         EVP_DigestUpdate(key.outer, pad, sizeof(pad)) > 0;
+    OPENSSL_cleanse(pad, sizeof(pad));
+    return ok;
+}
+
+void SessionTable::release(MacKey& key) {
+    EVP_MD_CTX_free(key.inner);
+    EVP_MD_CTX_free(key.outer);
+    key.inner = nullptr;
+    key.outer = nullptr;
+}
+
+bool SessionTable::tag(const MacKey& key, const ByteSegments& input, uint8_t* out) {
+    EVP_MD_CTX* ctx = ContextPool::digestContext();
+    unsigned char hash[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    if (!ctx || EVP_MD_CTX_copy_ex(ctx, key.inner) <= 0) {
+        return false;
+    }
+    for (const auto& segment : input) {
+        if (EVP_DigestUpdate(ctx, segment.data(), segment.size()) <= 0) {
+            return false;
+        }
+    }
+    if (EVP_DigestFinal_ex(ctx, hash, &len) <= 0 || EVP_MD_CTX_copy_ex(ctx, key.outer) <= 0 ||
+        EVP_DigestUpdate(ctx, hash, len) <= 0 || EVP_DigestFinal_ex(ctx, hash, &len) <= 0) {
+        return false;
+    }
+    std::memcpy(out, hash, TAG_SIZE);
+    return true;
+}
+
+bool SessionTable::open(uint64_t peer, ByteView peerOffer, uint64_t nowMs) {
+    if (!exchangeKey || peerOffer.size() != OFFER_SIZE ||
+        std::memcmp(peerOffer.data(), ownOffer, OFFER_SIZE) == 0) {
+        return false;
+    }
+
+    // X25519 shared secret; OpenSSL rejects low-order peer points
+    uint8_t secret[32];
+    size_t secretLen = sizeof(secret);
+    EVP_PKEY* peerKey = EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, nullptr,
+                                                    peerOffer.data(), peerOffer.size());
+    EVP_PKEY_CTX* ctx = peerKey ? EVP_PKEY_CTX_new(exchangeKey, nullptr) : nullptr;
+    bool ok = ctx && EVP_PKEY_derive_init(ctx) > 0 && EVP_PKEY_derive_set_peer(ctx, peerKey) > 0 &&
+              EVP_PKEY_derive(ctx, secret, &secretLen) > 0 && secretLen == sizeof(secret);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(peerKey);
+
+    // Both ends order the offers the same way, so they expand the same
+    // keys and each sends with the key the other receives with
+    bool ownFirst = std::memcmp(ownOffer, peerOffer.data(), OFFER_SIZE) < 0;
+    uint8_t info[sizeof(SESSION_LABEL) + 2 * OFFER_SIZE];
+    std::memcpy(info, SESSION_LABEL, sizeof(SESSION_LABEL));
+    std::memcpy(info + sizeof(SESSION_LABEL), ownFirst ? ownOffer : peerOffer.data(), OFFER_SIZE);
+    std::memcpy(info + sizeof(SESSION_LABEL) + OFFER_SIZE, ownFirst ? peerOffer.data() : ownOffer, OFFER_SIZE);
+
+    uint8_t keys[2 * SESSION_KEY_SIZE + 8];
+    size_t keysLen = sizeof(keys);
+    EVP_PKEY_CTX* kdf = ok ? EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr) : nullptr;
+    ok = kdf && EVP_PKEY_derive_init(kdf) > 0 &&
+         EVP_PKEY_CTX_set_hkdf_md(kdf, ContextPool::digest(HashAlgorithm::SHA256)) > 0 &&
+         EVP_PKEY_CTX_set1_hkdf_key(kdf, secret, static_cast<int>(secretLen)) > 0 &&
+         EVP_PKEY_CTX_add1_hkdf_info(kdf, info, static_cast<int>(sizeof(info))) > 0 &&
+         EVP_PKEY_derive(kdf, keys, &keysLen) > 0 && keysLen == sizeof(keys);
+    EVP_PKEY_CTX_free(kdf);
+    OPENSSL_cleanse(secret, sizeof(secret));
+
+    Session session{peer, loadId(keys + 2 * SESSION_KEY_SIZE), nowMs + lifetimeMs, MacKey(), MacKey()};
+    const uint8_t* firstKey = keys;
+    const uint8_t* secondKey = keys + SESSION_KEY_SIZE;
+    ok = ok && expand(session.send, ownFirst ? firstKey : secondKey, SESSION_KEY_SIZE) &&
+         expand(session.receive, ownFirst ? secondKey : firstKey, SESSION_KEY_SIZE);
+    OPENSSL_cleanse(keys, sizeof(keys));
+    if (!ok) {
+        release(session.send);
+        release(session.receive);
+        return false;
+    }
+
+    close(peer);
+    auto sameId = byId.find(session.id);
+    if (sameId != byId.end()) {
+        erase(sameId->second);
+    }
+    if (sessions.size() >= capacity) {
+        auto soonest = std::min_element(sessions.begin(), sessions.end(),
+            [](const Session& a, const Session& b) { return a.expiresMs < b.expiresMs; });
+        erase(static_cast<size_t>(soonest - sessions.begin()));
+    }
+    byPeer[peer] = sessions.size();
+    byId[session.id] = sessions.size();
+    sessions.push_back(session);
+    return true;
+}
+
+bool SessionTable::has(uint64_t peer, uint64_t nowMs) const {
+    auto it = byPeer.find(peer);
+    return it != byPeer.end() && nowMs < sessions[it->second].expiresMs;
+}
+
+void SessionTable::close(uint64_t peer) {
+    auto it = byPeer.find(peer);
+    if (it != byPeer.end()) {
+        erase(it->second);
+    }
+}
+
+void SessionTable::erase(size_t index) {
+    Session& session = sessions[index];
+    byPeer.erase(session.peer);
+    byId.erase(session.id);
+    release(session.send);
+    release(session.receive);
+
+    // The last session moves into the hole
+    if (index + 1 != sessions.size()) {
+        session = sessions.back();
+        byPeer[session.peer] = index;
+        byId[session.id] = index;
+    }
+    sessions.pop_back();
+}
+
+void SessionTable::expire(uint64_t nowMs) {
+    for (size_t i = sessions.size(); i-- > 0;) {
+        if (nowMs >= sessions[i].expiresMs) {
+            erase(i);
+        }
+    }
+}
+
+const SessionTable::Session* SessionTable::findId(uint64_t id, uint64_t nowMs) const {
+    auto it = byId.find(id);
+    if (it == byId.end() || nowMs >= sessions[it->second].expiresMs) {
+        return nullptr;
+    }
+    return &sessions[it->second];
+}
+
+size_t SessionTable::tagAll(const ByteSegments& input, uint64_t nowMs, std::pmr::vector<uint8_t>& entries) {
+    size_t appended = 0;
+    entries.reserve(entries.size() + sessions.size() * ENTRY_SIZE);
+    for (const auto& session : sessions) {
+        if (nowMs >= session.expiresMs) {
+            continue;
+        }
+        size_t offset = entries.size();
+        entries.resize(offset + ENTRY_SIZE);
+        for (int i = 0; i < 8; ++i) {
+            entries[offset + i] = static_cast<uint8_t>(session.id >> (8 * i));
+        }
+        if (!tag(session.send, input, entries.data() + offset + 8)) {
+            entries.resize(offset);
+            continue;
+        }
+        ++appended;
+    }
+    return appended;
+}
+
+uint64_t SessionTable::check(const ByteSegments& input, ByteView entries, uint64_t nowMs) const {
+    for (size_t offset = 0; offset + ENTRY_SIZE <= entries.size(); offset += ENTRY_SIZE) {
+        const Session* session = findId(loadId(entries.data() + offset), nowMs);
+        if (!session) {
+            continue;
+        }
+        // A message has one entry per recipient, so this is the only candidate
+        uint8_t expected[TAG_SIZE];
+        bool ok = tag(session->receive, input, expected) &&
+                  CRYPTO_memcmp(expected, entries.data() + offset + 8, TAG_SIZE) == 0;
+        return ok ? session->peer : 0;
+    }
+    return 0;
+}
+
+uint64_t SessionTable::peerOf(ByteView entries, uint64_t nowMs) const {
+    for (size_t offset = 0; offset + ENTRY_SIZE <= entries.size(); offset += ENTRY_SIZE) {
+        const Session* session = findId(loadId(entries.data() + offset), nowMs);
+        if (session) {
+            return session->peer;
+        }
+    }
+    return 0;
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,95 @@
+#ifndef VANET_SESSION_TABLE_H
+#define VANET_SESSION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include <openssl/evp.h>
+#include "byte-view.h"
+
+namespace vanet {
+namespace crypto {
+
+// Pairwise symmetric keys with neighbors. Each node has an X25519 key whose
+// public half, the offer, travels in its signed messages; a receiver that
+// verified such a message pairs the offer with its own key and derives the
+// same secret as the sender does from the receiver's offer. HKDF-SHA256
+// turns the secret into one HMAC-SHA256 key per direction and a session ID
+// both sides agree on.
+//
+// Messages between session peers then carry (session ID, tag) entries in
+// place of a signature: a truncated HMAC over the same input the signature
+// would cover. HMAC keys are expanded into inner and outer digest states
+// once per session, so tagging a beacon hashes three SHA-256 blocks.
+//
+// Sessions are keyed by the caller's peer identity and expire lifetimeMs
+// after they were opened; the peer must be verified by signature again to
+// reopen one. At most capacity sessions are kept, the one closest to
+// expiry is evicted first.
+class SessionTable {
+public:
+    static constexpr size_t OFFER_SIZE = 32;              // X25519 public key
+    static constexpr size_t TAG_SIZE = 16;                // HMAC-SHA256 truncated to 128 bits
+    static constexpr size_t ENTRY_SIZE = 8 + TAG_SIZE;    // little-endian session ID, then tag
+
+    SessionTable(size_t capacity, uint64_t lifetimeMs);
+    ~SessionTable();
+
+    SessionTable(const SessionTable&) = delete;
+    SessionTable& operator=(const SessionTable&) = delete;
+
+    // False if the exchange key could not be generated
+    bool valid() const { return exchangeKey != nullptr; }
+    ByteView offer() const { return ByteView(ownOffer, OFFER_SIZE); }
+
+    // Derives the session with peer from its offer, replacing any earlier
+    // one; false for malformed offers, including this table's own
+    bool open(uint64_t peer, ByteView peerOffer, uint64_t nowMs);
+    bool has(uint64_t peer, uint64_t nowMs) const;
+    void close(uint64_t peer);
+    void expire(uint64_t nowMs);
+    size_t size() const { return sessions.size(); }
+
+    // Appends one entry per open session; returns the number appended
+    size_t tagAll(const ByteSegments& input, uint64_t nowMs, std::pmr::vector<uint8_t>& entries);
+    // Peer whose entry authenticates input, or 0 if none does
+    uint64_t check(const ByteSegments& input, ByteView entries, uint64_t nowMs) const;
+    // Peer named by the first entry with a known session, without checking its tag
+    uint64_t peerOf(ByteView entries, uint64_t nowMs) const;
+
+private:
+    // HMAC key expanded into the digest states after the padded key block
+    struct MacKey {
+        EVP_MD_CTX* inner = nullptr;
+        EVP_MD_CTX* outer = nullptr;
+    };
+
+    struct Session {
+        uint64_t peer;
+        uint64_t id;
+        uint64_t expiresMs;
+        MacKey send;
+        MacKey receive;
+    };
+
+    size_t capacity;
+    uint64_t lifetimeMs;
+    EVP_PKEY* exchangeKey;
+    uint8_t ownOffer[OFFER_SIZE];
+    std::vector<Session> sessions;
+    std::unordered_map<uint64_t, size_t> byPeer;
+    std::unordered_map<uint64_t, size_t> byId;
+
+    const Session* findId(uint64_t id, uint64_t nowMs) const;
+    void erase(size_t index);
+    static bool expand(MacKey& key, const uint8_t* secret, size_t length);
+    static void release(MacKey& key);
+    static bool tag(const MacKey& key, const ByteSegments& input, uint8_t* out);
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_SESSION_TABLE_H
@@ -0,0 +1,412 @@
+#include "signature-backend.h"
+#include "context-pool.h"
+#include "crypto-module.h"
+#include <openssl/ec.h>
+#include <openssl/opensslv.h>
+#include <openssl/rsa.h>
+#ifdef VANET_HAVE_SODIUM
+#include <sodium.h>
+#include <cstring>
+#endif
+
+namespace vanet {
+namespace crypto {
+
+constexpr int MIN_KEY_SIZE = 2048;  // Minimum RSA key size in bits
+
+namespace {
+
+// Contiguous copy of the input for one-shot schemes (Ed25519 cannot stream).
+// Single-segment input is passed through without copying.
+ByteView gather(const ByteSegments& input) {
+    if (input.size() == 1) {
+        return *input.begin();
+    }
+    thread_local std::vector<uint8_t> scratch;
+    scratch.clear();
+    for (const auto& segment : input) {
+        scratch.insert(scratch.end(), segment.begin(), segment.end());
+    }
+    return ByteView(scratch);
+}
+
+EVP_PKEY* generateWith(int keyType, int curveNid, int rsaBits) {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(keyType, nullptr);
+    if (!ctx) return nullptr;
+
+    EVP_PKEY* key = nullptr;
+    if (EVP_PKEY_keygen_init(ctx) <= 0 ||
+        (curveNid && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, curveNid) <= 0) ||
+        (rsaBits && EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, rsaBits) <= 0) ||
+        EVP_PKEY_keygen(ctx, &key) <= 0) {
+        key = nullptr;
+    }
+
+    EVP_PKEY_CTX_free(ctx);
+    return key;
+}
+
+// Common base for backends running on the OpenSSL EVP interface
+class EvpBackend : public SignatureBackend {
+public:
+    // DigestSignInit/DigestVerifyInit plus any scheme parameters
+    virtual bool init(EVP_MD_CTX* ctx, EVP_PKEY* key, bool forSigning) const = 0;
+    // True for schemes that only support EVP_DigestSign/EVP_DigestVerify
+    virtual bool oneShot() const { return false; }
+
+    std::unique_ptr<Signer> makeSigner(EVP_PKEY* privateKey) const override;
+    std::unique_ptr<Verifier> makeVerifier(EVP_PKEY* publicKey) const override;
+};
+
+// Keeps a context initialized for the key and starts each operation from a
+// copy of it; providers that cannot duplicate their state are re-initialized
+class EvpOperation {
+public:
+    EvpOperation(const EvpBackend* backend, EVP_PKEY* key, bool forSigning)
+        : backend(backend), key(key), forSigning(forSigning), initialized(EVP_MD_CTX_new()) {
+        EVP_PKEY_up_ref(key);
+        if (!initialized || !backend->init(initialized, key, forSigning)) {
+            EVP_MD_CTX_free(initialized);
+            initialized = nullptr;
+        }
+    }
+
+    ~EvpOperation() {
+        EVP_MD_CTX_free(initialized);
+        EVP_PKEY_free(key);
+    }
+
+    bool valid() const { return initialized != nullptr; }
+
+    bool start(EVP_MD_CTX* ctx) {
+        if (copyable && EVP_MD_CTX_copy_ex(ctx, initialized) > 0) {
+            return true;
+        }
+        copyable = false;
+        EVP_MD_CTX_reset(ctx);
+        return backend->init(ctx, key, forSigning);
+    }
+
+    const EvpBackend* backend;
+    EVP_PKEY* key;
+
+private:
+    bool forSigning;
+    bool copyable = true;
+    EVP_MD_CTX* initialized;
+};
+
+class EvpSigner : public Signer {
+public:
+    EvpSigner(const EvpBackend* backend, EVP_PKEY* key)
+        : operation(backend, key, true), maxSize(EVP_PKEY_size(key)) {}
+
+    bool valid() const { return operation.valid(); }
+
+    bool sign(const ByteSegments& input, std::vector<uint8_t>& signature) override {
+        EVP_MD_CTX* ctx = ContextPool::signContext();
+        if (!ctx || !operation.start(ctx)) {
+            return false;
+        }
+
+        size_t sigLen = maxSize;
+        signature.resize(sigLen);
+        if (operation.backend->oneShot()) {
+            ByteView data = gather(input);
+            if (EVP_DigestSign(ctx, signature.data(), &sigLen, data.data(), data.size()) <= 0) {
+                return false;
+            }
+        } else {
+            for (const auto& segment : input) {
+                if (EVP_DigestSignUpdate(ctx, segment.data(), segment.size()) <= 0) {
+                    return false;
+                }
+            }
+            if (EVP_DigestSignFinal(ctx, signature.data(), &sigLen) <= 0) {
+                return false;
+            }
+        }
+
+        signature.resize(sigLen);
+        return true;
+    }
+
+private:
+    EvpOperation operation;
+    size_t maxSize;
+};
+
+class EvpVerifier : public Verifier {
+public:
+    EvpVerifier(const EvpBackend* backend, EVP_PKEY* key) : operation(backend, key, false) {}
+
+    bool valid() const { return operation.valid(); }
+
+    bool verify(const ByteSegments& input, ByteView signature) override {
+        EVP_MD_CTX* ctx = ContextPool::verifyContext();
+        if (!ctx || !operation.start(ctx)) {
+            return false;
+        }
+
+        if (operation.backend->oneShot()) {
+            ByteView data = gather(input);
+            return EVP_DigestVerify(ctx, signature.data(), signature.size(), data.data(), data.size()) > 0;
+        }
+        for (const auto& segment : input) {
+            if (EVP_DigestVerifyUpdate(ctx, segment.data(), segment.size()) <= 0) {
+                return false;
+            }
+        }
+        return EVP_DigestVerifyFinal(ctx, signature.data(), signature.size()) > 0;
+    }
+
+private:
+    EvpOperation operation;
+};
+
+std::unique_ptr<Signer> EvpBackend::makeSigner(EVP_PKEY* privateKey) const {
+    auto signer = std::make_unique<EvpSigner>(this, privateKey);
+    if (!signer->valid()) {
+        return nullptr;
+    }
+    return signer;
+}
+
+std::unique_ptr<Verifier> EvpBackend::makeVerifier(EVP_PKEY* publicKey) const {
+    auto verifier = std::make_unique<EvpVerifier>(this, publicKey);
+    if (!verifier->valid()) {
+        return nullptr;
+    }
+    return verifier;
+}
+
+// RSA-2048 with PSS padding and a digest-length salt
+class RsaPssBackend : public EvpBackend {
+public:
+    SignatureAlgorithm algorithm() const override { return SignatureAlgorithm::RSA_PSS; }
+    const char* name() const override { return "rsa-pss-2048"; }
+
+    EVP_PKEY* generateKey() const override {
+        return generateWith(EVP_PKEY_RSA, 0, MIN_KEY_SIZE);
+    }
+
+    bool init(EVP_MD_CTX* ctx, EVP_PKEY* key, bool forSigning) const override {
+        EVP_PKEY_CTX* pctx = nullptr;
+        const EVP_MD* md = ContextPool::digest(HashAlgorithm::SHA256);
+        int rc = forSigning ? EVP_DigestSignInit(ctx, &pctx, md, nullptr, key)
+                            : EVP_DigestVerifyInit(ctx, &pctx, md, nullptr, key);
+        return rc > 0 &&
+               EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) > 0 &&
+               EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, RSA_PSS_SALTLEN_DIGEST) > 0;
+    }
+};
+
+// ECDSA with SHA-256 on a named curve. On x86-64 and AArch64 OpenSSL has a
+// constant-time assembly implementation for P-256 that is several times
+// faster than the generic code used for secp256k1.
+class EcdsaBackend : public EvpBackend {
+public:
+    EcdsaBackend(SignatureAlgorithm algo, const char* name, int curveNid)
+        : algo(algo), backendName(name), curveNid(curveNid) {}
+
+    SignatureAlgorithm algorithm() const override { return algo; }
+    const char* name() const override { return backendName; }
+    int curve() const { return curveNid; }
+
+    EVP_PKEY* generateKey() const override {
+        return generateWith(EVP_PKEY_EC, curveNid, 0);
+    }
+
+    bool init(EVP_MD_CTX* ctx, EVP_PKEY* key, bool forSigning) const override {
+        const EVP_MD* md = ContextPool::digest(HashAlgorithm::SHA256);
+        int rc = forSigning ? EVP_DigestSignInit(ctx, nullptr, md, nullptr, key)
+                            : EVP_DigestVerifyInit(ctx, nullptr, md, nullptr, key);
+        return rc > 0;
+    }
+
+private:
+    SignatureAlgorithm algo;
+    const char* backendName;
+    int curveNid;
+};
+
+// Ed25519 through OpenSSL; the message is hashed internally, so no digest
+class Ed25519Backend : public EvpBackend {
+public:
+    SignatureAlgorithm algorithm() const override { return SignatureAlgorithm::ED25519; }
+    const char* name() const override { return "ed25519"; }
+    bool oneShot() const override { return true; }
+
+    EVP_PKEY* generateKey() const override {
+        return generateWith(EVP_PKEY_ED25519, 0, 0);
+    }
+
+    bool init(EVP_MD_CTX* ctx, EVP_PKEY* key, bool forSigning) const override {
+        int rc = forSigning ? EVP_DigestSignInit(ctx, nullptr, nullptr, nullptr, key)
+                            : EVP_DigestVerifyInit(ctx, nullptr, nullptr, nullptr, key);
+        return rc > 0;
+    }
+};
+
+#ifdef VANET_HAVE_SODIUM
+// Ed25519 through libsodium. Keys stay EVP_PKEY on the outside so the
+// certificate and wire formats are unchanged; the raw key bytes are
+// extracted once per Signer/Verifier.
+class SodiumSigner : public Signer {
+public:
+    explicit SodiumSigner(EVP_PKEY* key) : ok(false) {
+        uint8_t seed[crypto_sign_SEEDBYTES];
+        size_t len = sizeof(seed);
+        uint8_t pk[crypto_sign_PUBLICKEYBYTES];
+        ok = EVP_PKEY_get_raw_private_key(key, seed, &len) > 0 && len == sizeof(seed) &&
+             crypto_sign_seed_keypair(pk, sk, seed) == 0;
+        sodium_memzero(seed, sizeof(seed));
+    }
+
+    ~SodiumSigner() override { sodium_memzero(sk, sizeof(sk)); }
+
+    bool valid() const { return ok; }
+
+    bool sign(const ByteSegments& input, std::vector<uint8_t>& signature) override {
+        ByteView data = gather(input);
+        unsigned long long sigLen = 0;
+        signature.resize(crypto_sign_BYTES);
+        if (crypto_sign_detached(signature.data(), &sigLen, data.data(), data.size(), sk) != 0) {
+            return false;
+        }
+        signature.resize(sigLen);
+        return true;
+    }
+
+private:
+    uint8_t sk[crypto_sign_SECRETKEYBYTES];
+    bool ok;
+};
+
+class SodiumVerifier : public Verifier {
+public:
+    explicit SodiumVerifier(EVP_PKEY* key) {
+        size_t len = sizeof(pk);
+        ok = EVP_PKEY_get_raw_public_key(key, pk, &len) > 0 && len == sizeof(pk);
+    }
+
+    bool valid() const { return ok; }
+
+    bool verify(const ByteSegments& input, ByteView signature) override {
+        if (signature.size() != crypto_sign_BYTES) {
+            return false;
+        }
+        ByteView data = gather(input);
+        return crypto_sign_verify_detached(signature.data(), data.data(), data.size(), pk) == 0;
+    }
+
+private:
+    uint8_t pk[crypto_sign_PUBLICKEYBYTES];
+    bool ok;
+};
+
+class SodiumEd25519Backend : public SignatureBackend {
+public:
+    SodiumEd25519Backend() { initialized = sodium_init() >= 0; }
+
+    SignatureAlgorithm algorithm() const override { return SignatureAlgorithm::ED25519; }
+    const char* name() const override { return "ed25519-sodium"; }
+
+    EVP_PKEY* generateKey() const override {
+        return generateWith(EVP_PKEY_ED25519, 0, 0);
+    }
+
+    std::unique_ptr<Signer> makeSigner(EVP_PKEY* privateKey) const override {
+        auto signer = std::make_unique<SodiumSigner>(privateKey);
+        if (!initialized || !signer->valid()) {
+            return nullptr;
+        }
+        return signer;
+    }
+
+    std::unique_ptr<Verifier> makeVerifier(EVP_PKEY* publicKey) const override {
+        auto verifier = std::make_unique<SodiumVerifier>(publicKey);
+        if (!initialized || !verifier->valid()) {
+            return nullptr;
+        }
+        return verifier;
+    }
+
+private:
+    bool initialized;
+};
+#endif
+
+const RsaPssBackend rsaPssBackend;
+const EcdsaBackend secp256k1Backend(SignatureAlgorithm::ECDSA, "ecdsa-secp256k1", NID_secp256k1);
+const EcdsaBackend p256Backend(SignatureAlgorithm::ECDSA_P256, "ecdsa-p256", NID_X9_62_prime256v1);
+const Ed25519Backend ed25519Backend;
+#ifdef VANET_HAVE_SODIUM
+const SodiumEd25519Backend sodiumEd25519Backend;
+#endif
+
+const SignatureBackend* preferredEd25519() {
+#ifdef VANET_HAVE_SODIUM
+    return &sodiumEd25519Backend;
+#else
+    return &ed25519Backend;
+#endif
+}
+
+int curveOf(EVP_PKEY* key) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    char group[64];
+    size_t len = 0;
+    if (EVP_PKEY_get_group_name(key, group, sizeof(group), &len) <= 0) {
+        return NID_undef;
+    }
+    return OBJ_txt2nid(group);
+#else
+    const EC_KEY* ec = EVP_PKEY_get0_EC_KEY(key);
+    return ec ? EC_GROUP_get_curve_name(EC_KEY_get0_group(ec)) : NID_undef;
+#endif
+}
+
+} // namespace
+
+const SignatureBackend* SignatureBackend::forAlgorithm(SignatureAlgorithm algo) {
+    switch (algo) {
+        case SignatureAlgorithm::RSA_PSS:
+            return &rsaPssBackend;
+        case SignatureAlgorithm::ECDSA:
+            return &secp256k1Backend;
+        case SignatureAlgorithm::ECDSA_P256:
+            return &p256Backend;
+        case SignatureAlgorithm::ED25519:
+            return preferredEd25519();
+    }
+    return nullptr;
+}
+
+const SignatureBackend* SignatureBackend::forKey(EVP_PKEY* key) {
+    switch (EVP_PKEY_base_id(key)) {
+        case EVP_PKEY_RSA:
+        case EVP_PKEY_RSA_PSS:
+            return &rsaPssBackend;
+        case EVP_PKEY_EC:
+            // Verification is the same EVP path for any named curve
+            return curveOf(key) == p256Backend.curve() ? &p256Backend : &secp256k1Backend;
+        case EVP_PKEY_ED25519:
+            return preferredEd25519();
+        default:
+            return nullptr;
+    }
+}
+
+std::vector<const SignatureBackend*> SignatureBackend::available() {
+    std::vector<const SignatureBackend*> backends = {
+        &rsaPssBackend, &secp256k1Backend, &p256Backend, &ed25519Backend
+    };
+#ifdef VANET_HAVE_SODIUM
+    backends.push_back(&sodiumEd25519Backend);
+#endif
+    return backends;
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,54 @@
+#ifndef VANET_SIGNATURE_BACKEND_H
+#define VANET_SIGNATURE_BACKEND_H
+
+#include <memory>
+#include <vector>
+#include <openssl/evp.h>
+#include "byte-view.h"
+
+namespace vanet {
+namespace crypto {
+
+enum class SignatureAlgorithm;
+
+// Signing state bound to one private key, prepared once and reused for every
+// message signed with it
+class Signer {
+public:
+    virtual ~Signer() = default;
+    virtual bool sign(const ByteSegments& input, std::vector<uint8_t>& signature) = 0;
+};
+
+// Verification state bound to one sender public key
+class Verifier {
+public:
+    virtual ~Verifier() = default;
+    virtual bool verify(const ByteSegments& input, ByteView signature) = 0;
+};
+
+// Sign/verify implementation behind a SignatureAlgorithm. Backends are
+// stateless process-wide singletons; all per-key state lives in the Signer
+// and Verifier objects they create.
+class SignatureBackend {
+public:
+    virtual ~SignatureBackend() = default;
+
+    virtual SignatureAlgorithm algorithm() const = 0;
+    virtual const char* name() const = 0;
+
+    virtual EVP_PKEY* generateKey() const = 0;
+    virtual std::unique_ptr<Signer> makeSigner(EVP_PKEY* privateKey) const = 0;
+    virtual std::unique_ptr<Verifier> makeVerifier(EVP_PKEY* publicKey) const = 0;
+
+    // Backend for locally generated keys of the given algorithm
+    static const SignatureBackend* forAlgorithm(SignatureAlgorithm algo);
+    // Backend able to verify signatures made with the given key
+    static const SignatureBackend* forKey(EVP_PKEY* key);
+    // All backends compiled into this build, fastest path per algorithm
+    static std::vector<const SignatureBackend*> available();
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_SIGNATURE_BACKEND_H
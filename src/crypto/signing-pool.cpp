@@ -0,0 +1,232 @@
+#include "signing-pool.h"
+#include "context-pool.h"
+#include "crypto-module.h"
+#include <chrono>
+#include <openssl/objects.h>
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
+
+namespace vanet {
+namespace crypto {
+
+static EC_GROUP* groupOf(EVP_PKEY* key) {
+    if (EVP_PKEY_base_id(key) != EVP_PKEY_EC) {
+        return nullptr;
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    char name[64];
+    size_t len = 0;
+    if (EVP_PKEY_get_group_name(key, name, sizeof(name), &len) <= 0) {
+        return nullptr;
+    }
+    int nid = OBJ_txt2nid(name);
+#else
+    const EC_KEY* ec = EVP_PKEY_get0_EC_KEY(key);
+    int nid = ec ? EC_GROUP_get_curve_name(EC_KEY_get0_group(ec)) : NID_undef;
+#endif
+    return nid == NID_undef ? nullptr : EC_GROUP_new_by_curve_name(nid);
+}
+
+static BIGNUM* privateScalarOf(EVP_PKEY* key) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    BIGNUM* d = nullptr;
+    EVP_PKEY_get_bn_param(key, OSSL_PKEY_PARAM_PRIV_KEY, &d);
+    return d;
+#else
+    const EC_KEY* ec = EVP_PKEY_get0_EC_KEY(key);
+    const BIGNUM* d = ec ? EC_KEY_get0_private_key(ec) : nullptr;
+    return d ? BN_dup(d) : nullptr;
+#endif
+}
+
+std::unique_ptr<SigningPool> SigningPool::create(EVP_PKEY* key, size_t capacity) {
+    EC_GROUP* group = key ? groupOf(key) : nullptr;
+    if (!group) {
+        return nullptr;
+    }
+    std::unique_ptr<SigningPool> pool(new SigningPool(group, capacity));
+    if (!pool->initialize(key)) {
+        return nullptr;
+    }
+    return pool;
+}
+
+SigningPool::SigningPool(EC_GROUP* group, size_t capacity)
+    : group(group), point(EC_POINT_new(group)), ctx(BN_CTX_secure_new()), mont(BN_MONT_CTX_new()),
+      order(EC_GROUP_get0_order(group)), privateMont(BN_secure_new()), exponent(BN_new()),
+      orderBits(BN_num_bits(order)), entries(capacity), ready(0),
+      inlineEntry{BN_secure_new(), BN_new()}, precomputed(0), consumed(0), misses(0), refillNanos(0) {
+    for (auto& entry : entries) {
+        entry.kinv = BN_secure_new();
+        entry.r = BN_new();
+    }
+}
+
+SigningPool::~SigningPool() {
+    for (auto& entry : entries) {
+        BN_clear_free(entry.kinv);
+        BN_free(entry.r);
+    }
+    BN_clear_free(inlineEntry.kinv);
+    BN_free(inlineEntry.r);
+    BN_free(exponent);
+    BN_clear_free(privateMont);
+    BN_MONT_CTX_free(mont);
+    BN_CTX_free(ctx);
+    EC_POINT_free(point);
+    EC_GROUP_free(group);
+}
+
+bool SigningPool::initialize(EVP_PKEY* key) {
+    for (const auto& entry : entries) {
+        if (!entry.kinv || !entry.r) {
+            return false;
+        }
+    }
+    if (!point || !ctx || !mont || !order || !privateMont || !exponent ||
+        !inlineEntry.kinv || !inlineEntry.r || !BN_MONT_CTX_set(mont, order, ctx) ||
+        !BN_copy(exponent, order) || !BN_sub_word(exponent, 2)) {
+        return false;
+    }
+
+    BIGNUM* d = privateScalarOf(key);
+    bool ok = d && BN_to_montgomery(privateMont, d, mont, ctx);
+    BN_clear_free(d);
+    return ok;
+}
+
+bool SigningPool::precompute(Entry& entry) {
+    BN_CTX_start(ctx);
+    BIGNUM* k = BN_CTX_get(ctx);
+    BIGNUM* kinv = BN_CTX_get(ctx);
+    BIGNUM* x = BN_CTX_get(ctx);
+    bool ok = x != nullptr;
+
+    // r = (k·G).x mod n, with a fresh k whenever r comes out zero
+    do {
+        do {
+            ok = ok && BN_priv_rand_range(k, order);
+        } while (ok && BN_is_zero(k));
+        if (ok) {
+            BN_set_flags(k, BN_FLG_CONSTTIME);
+        }
+        ok = ok && EC_POINT_mul(group, point, k, nullptr, nullptr, ctx) &&
+             EC_POINT_get_affine_coordinates(group, point, x, nullptr, ctx) &&
+             BN_nnmod(entry.r, x, order, ctx);
+    } while (ok && BN_is_zero(entry.r));
+
+    // k⁻¹ = k^(n-2) mod n; n is prime, and the constant-time exponentiation
+    // keeps k out of the timing
+    ok = ok && BN_mod_exp_mont_consttime(kinv, k, exponent, order, ctx, mont) &&
+         BN_to_montgomery(entry.kinv, kinv, mont, ctx);
+
+    if (x) {
+        BN_clear(k);
+        BN_clear(kinv);
+    }
+    BN_CTX_end(ctx);
+    return ok;
+}
+
+size_t SigningPool::refill(size_t maxEntries) {
+    auto start = std::chrono::steady_clock::now();
+    size_t added = 0;
+    while (ready < entries.size() && added < maxEntries && precompute(entries[ready])) {
+        ++ready;
+        ++added;
+    }
+    precomputed += added;
+    refillNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return added;
+}
+
+SigningPool::Stats SigningPool::stats() const {
+    return Stats{ready, entries.size(), precomputed, consumed, misses, refillNanos};
+}
+
+bool SigningPool::digestInput(const ByteSegments& input, BIGNUM* e) {
+    EVP_MD_CTX* md = ContextPool::digestContext();
+    if (!md || EVP_DigestInit_ex(md, ContextPool::digest(HashAlgorithm::SHA256), nullptr) <= 0) {
+        return false;
+    }
+    for (const auto& segment : input) {
+        if (EVP_DigestUpdate(md, segment.data(), segment.size()) <= 0) {
+            return false;
+        }
+    }
+    unsigned char hash[EVP_MAX_MD_SIZE];
+    unsigned int hashLen = 0;
+    if (EVP_DigestFinal_ex(md, hash, &hashLen) <= 0 || !BN_bin2bn(hash, hashLen, e)) {
+        return false;
+    }
+
+    // Leftmost orderBits bits of the hash, reduced mod n (SEC 1, 4.1.3)
+    int hashBits = static_cast<int>(hashLen) * 8;
+    if (hashBits > orderBits && !BN_rshift(e, e, hashBits - orderBits)) {
+        return false;
+    }
+    return BN_nnmod(e, e, order, ctx);
+}
+
+bool SigningPool::sign(const ByteSegments& input, std::vector<uint8_t>& signature) {
+    BN_CTX_start(ctx);
+    BIGNUM* e = BN_CTX_get(ctx);
+    BIGNUM* s = BN_CTX_get(ctx);
+    bool ok = s && digestInput(input, e);
+
+    Entry* entry = nullptr;
+    while (ok) {
+        if (ready > 0) {
+            entry = &entries[--ready];
+            ++consumed;
+        } else if (precompute(inlineEntry)) {
+            entry = &inlineEntry;
+            ++misses;
+        } else {
+            ok = false;
+            break;
+        }
+
+        // s = k⁻¹(e + r·d) mod n; with d and k⁻¹ in Montgomery form each
+        // product comes out in normal form
+        ok = BN_mod_mul_montgomery(s, entry->r, privateMont, mont, ctx) &&
+             BN_mod_add_quick(s, s, e, order) &&
+             BN_mod_mul_montgomery(s, s, entry->kinv, mont, ctx);
+        if (!ok || !BN_is_zero(s)) {
+            break;
+        }
+        BN_clear(entry->kinv);
+    }
+
+    ECDSA_SIG* sig = ok ? ECDSA_SIG_new() : nullptr;
+    BIGNUM* rOut = sig ? BN_dup(entry->r) : nullptr;
+    BIGNUM* sOut = rOut ? BN_dup(s) : nullptr;
+    ok = sOut && ECDSA_SIG_set0(sig, rOut, sOut);
+    if (!ok) {
+        BN_free(rOut);
+        BN_free(sOut);
+    }
+
+    int len = ok ? i2d_ECDSA_SIG(sig, nullptr) : 0;
+    ok = len > 0;
+    if (ok) {
+        signature.resize(static_cast<size_t>(len));
+        unsigned char* out = signature.data();
+        ok = i2d_ECDSA_SIG(sig, &out) == len;
+    }
+    ECDSA_SIG_free(sig);
+
+    // A nonce is never used for a second signature
+    if (entry) {
+        BN_clear(entry->kinv);
+        BN_clear(entry->r);
+    }
+    BN_CTX_end(ctx);
+    return ok;
+}
+
+} // namespace crypto
+} // namespace vanet
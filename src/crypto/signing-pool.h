@@ -0,0 +1,85 @@
+#ifndef VANET_SIGNING_POOL_H
+#define VANET_SIGNING_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include "signature-backend.h"
+
+namespace vanet {
+namespace crypto {
+
+// Offline/online ECDSA signing for one EC private key. The costly part of
+// a signature does not depend on the message: a nonce k, its inverse and
+// r = (k·G).x mod n. refill() computes these ahead of time, when the owner
+// is idle, into a bounded pool; sign() then only hashes the input and
+// computes s = k⁻¹(e + r·d) mod n, a few modular multiplications. Every
+// precomputed nonce is used once and erased. With the pool empty sign()
+// computes the nonce inline, so it never fails for lack of precomputation.
+//
+// Signatures are ordinary DER-encoded ECDSA with SHA-256 and verify with
+// the regular ECDSA backends. Not thread-safe: one pool per signing thread.
+class SigningPool : public Signer {
+public:
+    struct Stats {
+        size_t depth;           // precomputed nonces ready for use
+        size_t capacity;
+        uint64_t precomputed;   // nonces computed by refill()
+        uint64_t consumed;      // signatures served from the pool
+        uint64_t misses;        // signatures that found the pool empty
+        uint64_t refillNanos;   // time spent in refill()
+    };
+
+    // nullptr if key is not an EC private key
+    static std::unique_ptr<SigningPool> create(EVP_PKEY* key, size_t capacity);
+    ~SigningPool() override;
+
+    SigningPool(const SigningPool&) = delete;
+    SigningPool& operator=(const SigningPool&) = delete;
+
+    bool sign(const ByteSegments& input, std::vector<uint8_t>& signature) override;
+
+    // Precomputes up to maxEntries nonces, stopping once the pool is full;
+    // returns the number added
+    size_t refill(size_t maxEntries = SIZE_MAX);
+
+    size_t depth() const { return ready; }
+    size_t capacity() const { return entries.size(); }
+    Stats stats() const;
+
+private:
+    struct Entry {
+        BIGNUM* kinv;   // k⁻¹ mod n, in Montgomery form
+        BIGNUM* r;
+    };
+
+    EC_GROUP* group;
+    EC_POINT* point;
+    BN_CTX* ctx;
+    BN_MONT_CTX* mont;      // Montgomery context for the group order
+    const BIGNUM* order;
+    BIGNUM* privateMont;    // d in Montgomery form
+    BIGNUM* exponent;       // n - 2, for inverting k by Fermat
+    int orderBits;
+    std::vector<Entry> entries;
+    size_t ready;           // entries[0, ready) hold unused nonces
+    Entry inlineEntry;      // nonce computed on a pool miss
+    uint64_t precomputed;
+    uint64_t consumed;
+    uint64_t misses;
+    uint64_t refillNanos;
+
+    SigningPool(EC_GROUP* group, size_t capacity);
+    bool initialize(EVP_PKEY* key);
+    bool precompute(Entry& entry);
+    bool digestInput(const ByteSegments& input, BIGNUM* e);
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_SIGNING_POOL_H
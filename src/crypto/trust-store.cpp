@@ -0,0 +1,249 @@
+#include "trust-store.h"
+#include "context-pool.h"
+#include "crypto-module.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <openssl/x509v3.h>
+
+namespace vanet {
+namespace crypto {
+
+constexpr double REVOCATION_FALSE_POSITIVE_RATE = 1e-6;  // Valid certificates wrongly taken as revoked
+
+static uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t FingerprintHash::operator()(const Fingerprint& fp) const {
+    // A SHA-256 output is already uniformly distributed
+    return static_cast<size_t>(load64(fp.data()));
+}
+
+RevocationFilter::RevocationFilter(size_t expectedEntries, double falsePositiveRate) : count(0) {
+    // Optimal size and probe count for n entries at rate p:
+    // m = -n ln p / (ln 2)^2, k = (m / n) ln 2
+    double n = static_cast<double>(std::max<size_t>(expectedEntries, 1));
+    double p = std::min(std::max(falsePositiveRate, 1e-12), 0.5);
+    double ln2 = std::log(2.0);
+    bitCount = static_cast<uint64_t>(std::ceil(-n * std::log(p) / (ln2 * ln2)));
+    bitCount = std::max<uint64_t>(bitCount, 64);
+    probes = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(bitCount / n * ln2)));
+    words.assign((bitCount + 63) / 64, 0);
+}
+
+template <typename Fn>
+void RevocationFilter::forEachBit(const Fingerprint& fp, Fn fn) const {
+    // Double hashing (Kirsch-Mitzenmacher) over two independent halves of the fingerprint
+    uint64_t h1 = load64(fp.data());
+    uint64_t h2 = load64(fp.data() + 8) | 1;
+    for (uint32_t i = 0; i < probes; ++i) {
+        fn((h1 + i * h2) % bitCount);
+    }
+}
+
+void RevocationFilter::add(const Fingerprint& fp) {
+    forEachBit(fp, [this](uint64_t bit) { words[bit / 64] |= uint64_t(1) << (bit % 64); });
+    ++count;
+}
+
+bool RevocationFilter::mayContain(const Fingerprint& fp) const {
+    bool all = true;
+    forEachBit(fp, [this, &all](uint64_t bit) { all = all && ((words[bit / 64] >> (bit % 64)) & 1); });
+    return all;
+}
+
+void RevocationFilter::clear() {
+    std::fill(words.begin(), words.end(), 0);
+    count = 0;
+}
+
+TrustStore::TrustStore(size_t maxChain, size_t cacheCapacity, size_t expectedRevocations)
+    : maxChain(maxChain), cacheCapacity(std::max<size_t>(cacheCapacity, 1)),
+      anchors(X509_STORE_new()), anchorCount(0), intermediates(sk_X509_new_null()),
+      revoked(expectedRevocations, REVOCATION_FALSE_POSITIVE_RATE), revocationCount(0), counters{0, 0, 0, 0} {}
+
+TrustStore::~TrustStore() {
+    clearCache();
+    sk_X509_pop_free(intermediates, X509_free);
+    X509_STORE_free(anchors);
+}
+
+Fingerprint TrustStore::fingerprint(ByteView der) {
+    Fingerprint fp{};
+    unsigned int len = 0;
+    EVP_Digest(der.data(), der.size(), fp.data(), &len, ContextPool::digest(HashAlgorithm::SHA256), nullptr);
+    return fp;
+}
+
+time_t TrustStore::expiryOf(const X509* cert) {
+    struct tm tmBuf{};
+    if (!ASN1_TIME_to_tm(X509_get0_notAfter(cert), &tmBuf)) {
+        return 0;
+    }
+    return timegm(&tmBuf);
+}
+
+static X509* parseCertificate(ByteView der) {
+    const unsigned char* p = der.data();
+    X509* cert = d2i_X509(nullptr, &p, static_cast<long>(der.size()));
+    if (cert && p != der.data() + der.size()) {
+        X509_free(cert);
+        return nullptr;
+    }
+    return cert;
+}
+
+bool TrustStore::addTrustAnchor(ByteView der) {
+    X509* cert = parseCertificate(der);
+    bool ok = cert && anchors && X509_STORE_add_cert(anchors, cert) > 0;
+    X509_free(cert);
+    if (ok) {
+        ++anchorCount;
+    }
+    return ok;
+}
+
+bool TrustStore::addIntermediate(ByteView der) {
+    X509* cert = parseCertificate(der);
+    if (!cert || !intermediates || !sk_X509_push(intermediates, cert)) {
+        X509_free(cert);
+        return false;
+    }
+    return true;
+}
+
+void TrustStore::revoke(const Fingerprint& fp) {
+    revoked.add(fp);
+    ++revocationCount;
+    clearCache();
+}
+
+bool TrustStore::verify(ByteView der, time_t now) {
+    Fingerprint fp = fingerprint(der);
+    if (revoked.mayContain(fp)) {
+        ++counters.rejected;
+        return false;
+    }
+
+    auto it = validated.find(fp);
+    if (it != validated.end() && now <= it->second.validUntil) {
+        ++counters.cacheHits;
+        return true;
+    }
+
+    X509* cert = parseCertificate(der);
+    bool ok = cert && (verifyWithCachedIssuer(cert, fp, now) || buildChain(cert, now));
+    X509_free(cert);
+    if (!ok) {
+        ++counters.rejected;
+    }
+    return ok;
+}
+
+bool TrustStore::verifyWithCachedIssuer(X509* cert, const Fingerprint& fp, time_t now) {
+    // CA certificates always get the full path checks
+    if (X509_check_ca(cert) != 0 || X509_cmp_time(X509_get0_notBefore(cert), &now) >= 0 ||
+        X509_cmp_time(X509_get0_notAfter(cert), &now) <= 0) {
+        return false;
+    }
+
+    auto range = issuersByName.equal_range(X509_NAME_hash(X509_get_issuer_name(cert)));
+    for (auto candidate = range.first; candidate != range.second; ++candidate) {
+        auto issuer = validated.find(candidate->second);
+        if (issuer == validated.end() || now > issuer->second.validUntil ||
+            issuer->second.chainLength + 1 > maxChain ||
+            X509_check_issued(issuer->second.issuer, cert) != X509_V_OK ||
+            X509_verify(cert, X509_get0_pubkey(issuer->second.issuer)) <= 0) {
+            continue;
+        }
+
+        ++counters.issuerShortcuts;
+        time_t validUntil = std::min(expiryOf(cert), issuer->second.validUntil);
+        size_t chainLength = issuer->second.chainLength + 1;
+        remember(fp, nullptr, validUntil, chainLength, now);
+        return true;
+    }
+    return false;
+}
+
+bool TrustStore::buildChain(X509* cert, time_t now) {
+    ++counters.chainsBuilt;
+    X509_STORE_CTX* ctx = X509_STORE_CTX_new();
+    bool ok = ctx && anchors && X509_STORE_CTX_init(ctx, anchors, cert, intermediates) > 0;
+    if (ok) {
+        X509_VERIFY_PARAM* param = X509_STORE_CTX_get0_param(ctx);
+        X509_VERIFY_PARAM_set_time(param, now);
+        X509_VERIFY_PARAM_set_depth(param, static_cast<int>(maxChain));
+        ok = X509_verify_cert(ctx) > 0;
+    }
+
+    // Leaf first, anchor last
+    STACK_OF(X509)* chain = ok ? X509_STORE_CTX_get0_chain(ctx) : nullptr;
+    int length = chain ? sk_X509_num(chain) : 0;
+    ok = ok && length > 0 && static_cast<size_t>(length) <= maxChain;
+
+    std::vector<Fingerprint> fingerprints;
+    for (int i = 0; ok && i < length; ++i) {
+        unsigned char* der = nullptr;
+        int derLen = i2d_X509(sk_X509_value(chain, i), &der);
+        ok = derLen > 0;
+        if (ok) {
+            fingerprints.push_back(fingerprint(ByteView(der, static_cast<size_t>(derLen))));
+            ok = !revoked.mayContain(fingerprints.back());
+        }
+        OPENSSL_free(der);
+    }
+
+    // Each certificate is good until the first expiry between it and the anchor
+    time_t validUntil = 0;
+    for (int i = length - 1; ok && i >= 0; --i) {
+        X509* member = sk_X509_value(chain, i);
+        time_t expiry = expiryOf(member);
+        validUntil = i == length - 1 ? expiry : std::min(validUntil, expiry);
+        bool issuer = i > 0 || X509_check_ca(member) != 0;
+        remember(fingerprints[i], issuer ? member : nullptr, validUntil, static_cast<size_t>(length - i), now);
+    }
+
+    X509_STORE_CTX_free(ctx);
+    return ok;
+}
+
+void TrustStore::remember(const Fingerprint& fp, X509* cert, time_t validUntil, size_t chainLength,
+                          time_t now) {
+    if (validated.size() >= cacheCapacity && validated.find(fp) == validated.end()) {
+        // Expired entries go first; a cache full of live chains starts over
+        for (auto it = validated.begin(); it != validated.end();) {
+            if (now > it->second.validUntil && !it->second.issuer) {
+                it = validated.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (validated.size() >= cacheCapacity) {
+            clearCache();
+        }
+    }
+
+    Validated& entry = validated[fp];
+    entry.validUntil = validUntil;
+    entry.chainLength = chainLength;
+    if (cert && !entry.issuer) {
+        X509_up_ref(cert);
+        entry.issuer = cert;
+        issuersByName.emplace(X509_NAME_hash(X509_get_subject_name(cert)), fp);
+    }
+}
+
+void TrustStore::clearCache() {
+    for (auto& item : validated) {
+        X509_free(item.second.issuer);
+    }
+    validated.clear();
+    issuersByName.clear();
+}
+
+} // namespace crypto
+} // namespace vanet
@@ -0,0 +1,119 @@
+#ifndef VANET_TRUST_STORE_H
+#define VANET_TRUST_STORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+#include <openssl/x509.h>
+#include "byte-view.h"
+
+namespace vanet {
+namespace crypto {
+
+// SHA-256 of a certificate's DER encoding
+using Fingerprint = std::array<uint8_t, 32>;
+
+struct FingerprintHash {
+    size_t operator()(const Fingerprint& fp) const;
+};
+
+// Bloom filter over revoked certificate fingerprints, e.g. a CRL or a
+// pseudonym revocation list. A lookup is a fixed number of bit probes no
+// matter how long the list is. There are no false negatives; false
+// positives stay near falsePositiveRate up to expectedEntries revocations.
+class RevocationFilter {
+public:
+    RevocationFilter(size_t expectedEntries, double falsePositiveRate);
+
+    void add(const Fingerprint& fp);
+    bool mayContain(const Fingerprint& fp) const;
+    size_t size() const { return count; }
+    void clear();
+
+private:
+    std::vector<uint64_t> words;
+    uint64_t bitCount;
+    uint32_t probes;
+    size_t count;
+
+    template <typename Fn>
+    void forEachBit(const Fingerprint& fp, Fn fn) const;
+};
+
+// Certificate chain validation against a set of trust anchors, e.g. the
+// root and enrolment CAs of a V2X PKI. Chains are built by OpenSSL from the
+// anchors and the known intermediates and may hold at most maxChain
+// certificates, leaf and anchor included.
+//
+// Validated leaves and intermediates are remembered by fingerprint until
+// the earliest validUntil along their chain, so a credential seen again is
+// accepted after one hash, and a new leaf under a validated intermediate
+// only needs its own signature checked. Revocation is checked against the
+// filter for every certificate of a chain; revoking anything drops the
+// cache so no cached chain outlives a revoked member.
+class TrustStore {
+public:
+    struct Stats {
+        uint64_t cacheHits;        // accepted from the validated cache
+        uint64_t issuerShortcuts;  // leaves checked against a cached issuer
+        uint64_t chainsBuilt;      // full chain validations
+        uint64_t rejected;
+    };
+
+    TrustStore(size_t maxChain, size_t cacheCapacity, size_t expectedRevocations);
+    ~TrustStore();
+
+    TrustStore(const TrustStore&) = delete;
+    TrustStore& operator=(const TrustStore&) = delete;
+
+    bool addTrustAnchor(ByteView der);
+    bool hasAnchors() const { return anchorCount > 0; }
+    // Untrusted CA certificate offered for chain building
+    bool addIntermediate(ByteView der);
+    void revoke(const Fingerprint& fp);
+    void revoke(ByteView der) { revoke(fingerprint(der)); }
+    bool isRevoked(const Fingerprint& fp) const { return revoked.mayContain(fp); }
+    // Count of revoke() calls. Outcomes of verify() cached outside the
+    // store, e.g. by each CryptoModule sharing it, are stale once it moves.
+    uint64_t revocations() const { return revocationCount; }
+
+    // True if the DER certificate chains to an anchor and nothing on the
+    // chain is expired, not yet valid or revoked at time now
+    bool verify(ByteView der, time_t now);
+
+    static Fingerprint fingerprint(ByteView der);
+    static time_t expiryOf(const X509* cert);
+    size_t cachedCertificates() const { return validated.size(); }
+    const Stats& stats() const { return counters; }
+
+private:
+    struct Validated {
+        time_t validUntil;    // earliest notAfter from here to the anchor
+        X509* issuer;         // CA certificates only, for the shortcut
+        size_t chainLength;   // certificates from here to the anchor
+    };
+
+    size_t maxChain;
+    size_t cacheCapacity;
+    X509_STORE* anchors;
+    size_t anchorCount;
+    STACK_OF(X509)* intermediates;
+    std::unordered_map<Fingerprint, Validated, FingerprintHash> validated;
+    std::unordered_multimap<unsigned long, Fingerprint> issuersByName;
+    RevocationFilter revoked;
+    uint64_t revocationCount;
+    Stats counters;
+
+    bool verifyWithCachedIssuer(X509* cert, const Fingerprint& fp, time_t now);
+    bool buildChain(X509* cert, time_t now);
+    void remember(const Fingerprint& fp, X509* cert, time_t validUntil, size_t chainLength, time_t now);
+    void clearCache();
+};
+
+} // namespace crypto
+} // namespace vanet
+
+#endif // VANET_TRUST_STORE_H
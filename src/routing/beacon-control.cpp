@@ -0,0 +1,123 @@
+#include "beacon-control.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vanet {
+namespace routing {
+
+// TS 102 687 adaptive approach
+constexpr uint64_t CBR_WINDOW_MS = 100;       // Busy ratio measurement period
+constexpr uint32_t DCC_UPDATE_WINDOWS = 2;    // Duty cycle updated every 200 ms
+constexpr double DCC_ALPHA = 0.016;
+constexpr double DCC_BETA = 0.0012;
+constexpr double DUTY_CYCLE_MIN = 0.0006;
+constexpr double DUTY_CYCLE_MAX = 0.03;
+constexpr double DUTY_STEP_UP_MAX = 0.0005;
+constexpr double DUTY_STEP_DOWN_MAX = -0.00025;
+constexpr uint32_t MAX_CATCHUP_WINDOWS = 64;  // Idle gaps longer than this start over
+
+BeaconController::Config BeaconController::Config::etsi() {
+    Config config;
+    config.minIntervalMs = 100;
+    config.maxIntervalMs = 1000;
+    config.fullIntervalMs = 1000;
+    config.positionThreshold = 4.0;
+    config.speedThreshold = 0.5;
+    config.headingThreshold = 4.0;
+    config.targetLoad = 0.68;
+    config.bitrate = 6e6;
+    // 10 MHz OFDM preamble and SIGNAL field, then MAC header, LLC and FCS at 6 Mbit/s
+    config.frameOverheadUs = 40.0 + 36 * 8 / 6.0;
+    return config;
+}
+
+BeaconController::BeaconController(const Config& config)
+    : config(config), windowStartMs(0), busyUs(0.0), lastWindowLoad(0.0), windowsSinceUpdate(0),
+      cbr(0.0), delta(DUTY_CYCLE_MAX), lastAirtimeUs(0.0), anySent(false), lastSentMs(0),
+      lastFullMs(0), lastPosition{}, lastSpeed(0.0), lastDirection(0.0) {}
+
+double BeaconController::airtimeUs(size_t bytes) const {
+    return config.frameOverheadUs + static_cast<double>(bytes) * 8.0 / config.bitrate * 1e6;
+}
+
+void BeaconController::advance(uint64_t nowMs) {
+    if (windowStartMs == 0) {
+        windowStartMs = nowMs;
+        return;
+    }
+
+    uint32_t closed = 0;
+    while (nowMs >= windowStartMs + CBR_WINDOW_MS && closed < MAX_CATCHUP_WINDOWS) {
+        double load = std::min(busyUs / (CBR_WINDOW_MS * 1000.0), 1.0);
+        cbr = (load + lastWindowLoad) / 2;
+        lastWindowLoad = load;
+        busyUs = 0.0;
+        windowStartMs += CBR_WINDOW_MS;
+        ++closed;
+
+        if (++windowsSinceUpdate >= DCC_UPDATE_WINDOWS) {
+            windowsSinceUpdate = 0;
+            double step = DCC_BETA * (config.targetLoad - cbr);
+            step = step > 0 ? std::min(step, DUTY_STEP_UP_MAX) : std::max(step, DUTY_STEP_DOWN_MAX);
+            delta = std::min(std::max((1 - DCC_ALPHA) * delta + step, DUTY_CYCLE_MIN), DUTY_CYCLE_MAX);
+        }
+    }
+    if (nowMs >= windowStartMs + CBR_WINDOW_MS) {
+        // Long silence: keep the duty cycle, resume measuring from here
+        windowStartMs = nowMs - (nowMs - windowStartMs) % CBR_WINDOW_MS;
+    }
+}
+
+void BeaconController::heard(uint64_t nowMs, size_t bytes) {
+    advance(nowMs);
+    busyUs += airtimeUs(bytes);
+}
+
+uint64_t BeaconController::intervalMs() const {
+    // T_off = T_on / delta
+    uint64_t gap = static_cast<uint64_t>(lastAirtimeUs / delta / 1000.0);
+    return std::min(std::max(gap, config.minIntervalMs), config.maxIntervalMs);
+}
+
+BeaconKind BeaconController::due(uint64_t nowMs, const VehicleInfo& self) {
+    advance(nowMs);
+    if (!anySent) {
+        return BeaconKind::FULL;
+    }
+    if (nowMs < lastSentMs || nowMs - lastSentMs < intervalMs()) {
+        return BeaconKind::NONE;
+    }
+
+    double heading = std::fabs(self.direction - lastDirection);
+    heading = std::min(heading, 360.0 - std::fmod(heading, 360.0));
+    double dx = self.position.x - lastPosition.x;
+    double dy = self.position.y - lastPosition.y;
+    double dz = self.position.z - lastPosition.z;
+    bool triggered = nowMs - lastSentMs >= config.maxIntervalMs ||
+                     dx * dx + dy * dy + dz * dz > config.positionThreshold * config.positionThreshold ||
+                     std::fabs(self.speed - lastSpeed) > config.speedThreshold ||
+                     heading > config.headingThreshold;
+    if (!triggered) {
+        return BeaconKind::NONE;
+    }
+    return nowMs - lastFullMs >= config.fullIntervalMs ? BeaconKind::FULL : BeaconKind::DELTA;
+}
+
+void BeaconController::sent(uint64_t nowMs, BeaconKind kind, const VehicleInfo& self, size_t bytes) {
+    if (kind == BeaconKind::NONE) {
+        return;
+    }
+    advance(nowMs);
+    anySent = true;
+    lastSentMs = nowMs;
+    if (kind == BeaconKind::FULL) {
+        lastFullMs = nowMs;
+    }
+    lastPosition = self.position;
+    lastSpeed = self.speed;
+    lastDirection = self.direction;
+    lastAirtimeUs = airtimeUs(bytes);
+}
+
+} // namespace routing
+} // namespace vanet
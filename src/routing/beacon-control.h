@@ -0,0 +1,94 @@
+#ifndef VANET_BEACON_CONTROL_H
+#define VANET_BEACON_CONTROL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "routing-types.h"
+
+namespace vanet {
+namespace routing {
+
+enum class BeaconKind : uint8_t {
+    NONE,   // nothing due
+    DELTA,  // position change against the last full beacon
+    FULL    // signed beacon with absolute position
+};
+
+// Decides when a node beacons, in the manner of ETSI CAM generation
+// (EN 302 637-2) under adaptive decentralized congestion control (TS 102
+// 687). Times are milliseconds in the owner's time base.
+//
+// A beacon is due once the vehicle moved, turned or changed speed by more
+// than the thresholds since its last one, or maxIntervalMs passed, but
+// never sooner than the congestion-controlled gap. That gap follows the
+// channel busy ratio (CBR): busy time of the frames heard, measured over
+// 100 ms windows. Every 200 ms the allowed duty cycle moves towards the
+// value that keeps CBR at targetLoad, and the gap is the airtime of the
+// node's own last frame over the duty cycle. Dense neighborhoods thus slow
+// everyone down, and fast vehicles beacon more often than parked ones.
+//
+// At least one beacon per fullIntervalMs is full; the ones in between are
+// deltas that receivers apply to the full one.
+class BeaconController {
+public:
+    struct Config {
+        uint64_t minIntervalMs;     // T_GenCamMin
+        uint64_t maxIntervalMs;     // T_GenCamMax
+        uint64_t fullIntervalMs;    // longest run of delta beacons
+        double positionThreshold;   // meters
+        double speedThreshold;      // m/s
+        double headingThreshold;    // degrees
+        double targetLoad;          // CBR the duty cycle converges to
+        double bitrate;             // channel bit rate, bits/s
+        double frameOverheadUs;     // preamble and PHY header per frame
+
+        // ITS-G5 CAM and adaptive DCC defaults on a 6 Mbit/s channel
+        static Config etsi();
+    };
+
+    explicit BeaconController(const Config& config = Config::etsi());
+
+    // A frame of this many bytes was heard on the channel
+    void heard(uint64_t nowMs, size_t bytes);
+    // What, if anything, the node should send at nowMs in its current state
+    BeaconKind due(uint64_t nowMs, const VehicleInfo& self);
+    // A beacon of that kind went out; bytes is its size on the air
+    void sent(uint64_t nowMs, BeaconKind kind, const VehicleInfo& self, size_t bytes);
+
+    // Smallest gap between beacons the channel currently allows
+    uint64_t intervalMs() const;
+    uint64_t checkIntervalMs() const { return config.minIntervalMs; }
+    double channelLoad() const { return cbr; }
+    double dutyCycle() const { return delta; }
+    const Config& getConfig() const { return config; }
+
+private:
+    Config config;
+
+    // CBR measurement
+    uint64_t windowStartMs;    // 0 until the first call
+    double busyUs;             // in the current window
+    double lastWindowLoad;
+    uint32_t windowsSinceUpdate;
+    double cbr;                // average of the last two windows
+
+    // Adaptive DCC state
+    double delta;              // allowed fraction of channel time
+    double lastAirtimeUs;
+
+    // Last beacon sent
+    bool anySent;
+    uint64_t lastSentMs;
+    uint64_t lastFullMs;
+    Position lastPosition;
+    double lastSpeed;
+    double lastDirection;
+
+    void advance(uint64_t nowMs);
+    double airtimeUs(size_t bytes) const;
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_BEACON_CONTROL_H
@@ -0,0 +1,66 @@
+#include "forwarding-monitor.h"
+#include <limits>
+
+namespace vanet {
+namespace routing {
+
+constexpr uint32_t COUNTER_BITS = 16;  // Counts are gone after this many halvings
+
+ForwardingMonitor::Config ForwardingMonitor::Config::defaults() {
+    Config config;
+    config.windowMs = 5000;
+    config.minHandoffs = 8;
+    config.minForwardRatio = 0.25;
+    return config;
+}
+
+ForwardingMonitor::ForwardingMonitor(const Config& config)
+    : config(config), windowStartMs(0), windowEndMs(0), window(0) {}
+
+uint32_t ForwardingMonitor::windowAt(uint64_t nowMs) {
+    if (nowMs < windowStartMs || nowMs >= windowEndMs) {
+        window = static_cast<uint32_t>(nowMs / config.windowMs);
+        windowStartMs = static_cast<uint64_t>(window) * config.windowMs;
+        windowEndMs = windowStartMs + config.windowMs;
+    }
+    return window;
+}
+
+ForwardingCounters ForwardingMonitor::decayed(const ForwardingCounters& counters, uint32_t window) const {
+    uint32_t elapsed = window - counters.window;
+    if (elapsed == 0) {
+        return counters;
+    }
+    if (elapsed >= COUNTER_BITS) {
+        return ForwardingCounters{0, 0, 0, 0, window};
+    }
+    return ForwardingCounters{static_cast<uint16_t>(counters.advertised >> elapsed),
+                              static_cast<uint16_t>(counters.handedOff >> elapsed),
+                              static_cast<uint16_t>(counters.overheard >> elapsed), 0, window};
+}
+
+bool ForwardingMonitor::verdict(const ForwardingCounters& counters) const {
+    uint32_t evidence = counters.advertised > counters.handedOff ? config.minHandoffs / 2u : config.minHandoffs;
+    return counters.handedOff >= evidence && counters.handedOff > 0 &&
+           counters.overheard < config.minForwardRatio * counters.handedOff;
+}
+
+bool ForwardingMonitor::record(ForwardingCounters& counters, ForwardingEvent event, uint64_t nowMs) {
+    // Decay alone can clear a verdict, which counts as a change too
+    bool before = verdict(counters);
+    counters = decayed(counters, windowAt(nowMs));
+    uint16_t& count = event == ForwardingEvent::ADVERTISED ? counters.advertised
+                    : event == ForwardingEvent::HANDED_OFF ? counters.handedOff
+                                                           : counters.overheard;
+    if (count < std::numeric_limits<uint16_t>::max()) {
+        ++count;
+    }
+    return verdict(counters) != before;
+}
+
+bool ForwardingMonitor::suspicious(const ForwardingCounters& counters, uint64_t nowMs) {
+    return verdict(decayed(counters, windowAt(nowMs)));
+}
+
+} // namespace routing
+} // namespace vanet
@@ -0,0 +1,68 @@
+#ifndef VANET_FORWARDING_MONITOR_H
+#define VANET_FORWARDING_MONITOR_H
+
+#include <cstdint>
+
+namespace vanet {
+namespace routing {
+
+enum class ForwardingEvent : uint8_t {
+    ADVERTISED,  // the neighbor sent us a ROUTE_REPLY
+    HANDED_OFF,  // we gave it a DATA packet to relay
+    OVERHEARD    // we heard it relay DATA towards a destination we route through it
+};
+
+// Per-neighbor counters, kept in a NodeTable column. Counts are decayed:
+// they halve at every window boundary, applied lazily on the next access.
+struct ForwardingCounters {
+    uint16_t advertised;
+    uint16_t handedOff;
+    uint16_t overheard;
+    uint16_t reserved;
+    uint32_t window;      // index of the window the counts belong to
+};
+
+// Black-hole detection from forwarding ratios, without buffering packets
+// to match them against what is overheard: a neighbor that is handed
+// enough traffic to relay, but is heard relaying little of it, is suspect.
+// A black hole draws that traffic by advertising routes, so a neighbor that
+// advertised more routes than it was given packets for is judged on half
+// the evidence. Every operation is O(1) and touches only the one row.
+class ForwardingMonitor {
+public:
+    struct Config {
+        uint64_t windowMs;        // counts halve after each window
+        uint16_t minHandoffs;     // decayed handoffs needed for a verdict
+        double minForwardRatio;   // overheard relays per handoff below which it is suspect
+
+        static Config defaults();
+    };
+
+    explicit ForwardingMonitor(const Config& config = Config::defaults());
+
+    // Counts one event at nowMs; true if that changed the verdict
+    bool record(ForwardingCounters& counters, ForwardingEvent event, uint64_t nowMs);
+    bool suspicious(const ForwardingCounters& counters, uint64_t nowMs);
+    // Whether overheard relays can count for the neighbor at all: only if it
+    // was handed packets within the last few windows
+    static bool awaitsRelays(const ForwardingCounters& counters) { return counters.handedOff > 0; }
+
+    const Config& getConfig() const { return config; }
+
+private:
+    Config config;
+    // Window containing the last time asked about, so that the common case
+    // of many events in one window does not divide
+    uint64_t windowStartMs;
+    uint64_t windowEndMs;
+    uint32_t window;
+
+    uint32_t windowAt(uint64_t nowMs);
+    ForwardingCounters decayed(const ForwardingCounters& counters, uint32_t window) const;
+    bool verdict(const ForwardingCounters& counters) const;
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_FORWARDING_MONITOR_H
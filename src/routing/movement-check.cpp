@@ -0,0 +1,184 @@
+#include "movement-check.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VANET_MOVEMENT_AVX2
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define VANET_MOVEMENT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace vanet {
+namespace routing {
+
+constexpr double KMH_PER_MPS_SQUARED = 3.6 * 3.6;
+constexpr double NO_TIME = std::numeric_limits<double>::quiet_NaN();
+
+void PositionColumns::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    t.clear();
+}
+
+void PositionColumns::push_back(const Position& position) {
+    x.push_back(position.x);
+    y.push_back(position.y);
+    z.push_back(position.z);
+    t.push_back(seconds(position.timestamp));
+}
+
+void PositionColumns::pushEmpty() {
+    x.push_back(0.0);
+    y.push_back(0.0);
+    z.push_back(0.0);
+    t.push_back(NO_TIME);
+}
+
+void PositionColumns::set(size_t i, const Position& position) {
+    x[i] = position.x;
+    y[i] = position.y;
+    z[i] = position.z;
+    t[i] = seconds(position.timestamp);
+}
+
+Position PositionColumns::get(size_t i) const {
+    auto sinceEpoch = std::chrono::round<std::chrono::milliseconds>(std::chrono::duration<double>(t[i]));
+    return Position{x[i], y[i], z[i], std::chrono::system_clock::time_point(sinceEpoch)};
+}
+
+void PositionColumns::setEmpty(size_t i) {
+    x[i] = y[i] = z[i] = 0.0;
+    t[i] = NO_TIME;
+}
+
+void PositionColumns::moveRow(size_t from, size_t to) {
+    x[to] = x[from];
+    y[to] = y[from];
+    z[to] = z[from];
+    t[to] = t[from];
+}
+
+void PositionColumns::pop_back() {
+    x.pop_back();
+    y.pop_back();
+    z.pop_back();
+    t.pop_back();
+}
+
+// Lanes [begin, end); also the tail of the vector kernels
+static size_t validateScalar(const PositionColumns& from, const PositionColumns& to,
+                             const MovementLimits& limits, uint8_t* implausible,
+                             size_t begin, size_t end) {
+    const double *fx = from.x.data(), *fy = from.y.data(), *fz = from.z.data(), *ft = from.t.data();
+    const double *tx = to.x.data(), *ty = to.y.data(), *tz = to.z.data(), *tt = to.t.data();
+
+    size_t count = 0;
+    for (size_t i = begin; i < end; ++i) {
+        double dt = std::trunc(tt[i] - ft[i]);
+        double dx = tx[i] - fx[i];
+        double dy = ty[i] - fy[i];
+        double dz = tz[i] - fz[i];
+        double d2 = dx * dx + dy * dy + dz * dz;
+        double bound = std::min(limits.maxSpeed * dt, limits.maxAcceleration * dt * dt);
+        bool plausible = dt > 0 && KMH_PER_MPS_SQUARED * d2 <= bound * bound;
+        implausible[i] = !plausible;
+        count += !plausible;
+    }
+    return count;
+}
+
+#ifdef VANET_MOVEMENT_AVX2
+__attribute__((target("avx2,bmi2,popcnt")))
+static size_t validateAvx2(const PositionColumns& from, const PositionColumns& to,
+                           const MovementLimits& limits, uint8_t* implausible, size_t n) {
+    const __m256d kmh2 = _mm256_set1_pd(KMH_PER_MPS_SQUARED);
+    const __m256d maxSpeed = _mm256_set1_pd(limits.maxSpeed);
+    const __m256d maxAcceleration = _mm256_set1_pd(limits.maxAcceleration);
+    const __m256d zero = _mm256_setzero_pd();
+
+    // Raw column pointers; the byte stores below could alias anything
+    const double *fx = from.x.data(), *fy = from.y.data(), *fz = from.z.data(), *ft = from.t.data();
+    const double *tx = to.x.data(), *ty = to.y.data(), *tz = to.z.data(), *tt = to.t.data();
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dt = _mm256_round_pd(_mm256_sub_pd(_mm256_loadu_pd(tt + i), _mm256_loadu_pd(ft + i)),
+                                     _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(tx + i), _mm256_loadu_pd(fx + i));
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ty + i), _mm256_loadu_pd(fy + i));
+        __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(tz + i), _mm256_loadu_pd(fz + i));
+        __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+                                   _mm256_mul_pd(dz, dz));
+        __m256d bound = _mm256_min_pd(_mm256_mul_pd(maxSpeed, dt),
+                                      _mm256_mul_pd(_mm256_mul_pd(maxAcceleration, dt), dt));
+        __m256d plausible = _mm256_and_pd(
+            _mm256_cmp_pd(dt, zero, _CMP_GT_OQ),
+            _mm256_cmp_pd(_mm256_mul_pd(kmh2, d2), _mm256_mul_pd(bound, bound), _CMP_LE_OQ));
+
+        unsigned bad = ~static_cast<unsigned>(_mm256_movemask_pd(plausible)) & 0xf;
+        // One mask byte per lane, written at once
+        uint32_t bytes = _pdep_u32(bad, 0x01010101u);
+        std::memcpy(implausible + i, &bytes, sizeof(bytes));
+        count += __builtin_popcount(bad);
+    }
+    // The rest of the program is SSE code; avoid the AVX transition penalty
+    _mm256_zeroupper();
+    return count + validateScalar(from, to, limits, implausible, i, n);
+}
+#endif
+
+#ifdef VANET_MOVEMENT_NEON
+static size_t validateNeon(const PositionColumns& from, const PositionColumns& to,
+                           const MovementLimits& limits, uint8_t* implausible, size_t n) {
+    const float64x2_t kmh2 = vdupq_n_f64(KMH_PER_MPS_SQUARED);
+    const float64x2_t maxSpeed = vdupq_n_f64(limits.maxSpeed);
+    const float64x2_t maxAcceleration = vdupq_n_f64(limits.maxAcceleration);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+
+    const double *fx = from.x.data(), *fy = from.y.data(), *fz = from.z.data(), *ft = from.t.data();
+    const double *tx = to.x.data(), *ty = to.y.data(), *tz = to.z.data(), *tt = to.t.data();
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t dt = vrndq_f64(vsubq_f64(vld1q_f64(tt + i), vld1q_f64(ft + i)));
+        float64x2_t dx = vsubq_f64(vld1q_f64(tx + i), vld1q_f64(fx + i));
+        float64x2_t dy = vsubq_f64(vld1q_f64(ty + i), vld1q_f64(fy + i));
+        float64x2_t dz = vsubq_f64(vld1q_f64(tz + i), vld1q_f64(fz + i));
+        float64x2_t d2 = vaddq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)), vmulq_f64(dz, dz));
+        float64x2_t bound = vminq_f64(vmulq_f64(maxSpeed, dt),
+                                      vmulq_f64(vmulq_f64(maxAcceleration, dt), dt));
+        uint64x2_t plausible = vandq_u64(vcgtq_f64(dt, zero),
+                                         vcleq_f64(vmulq_f64(kmh2, d2), vmulq_f64(bound, bound)));
+
+        uint8_t bad0 = vgetq_lane_u64(plausible, 0) == 0;
+        uint8_t bad1 = vgetq_lane_u64(plausible, 1) == 0;
+        implausible[i] = bad0;
+        implausible[i + 1] = bad1;
+        count += bad0 + bad1;
+    }
+    return count + validateScalar(from, to, limits, implausible, i, n);
+}
+#endif
+
+size_t validateMovementsBatch(const PositionColumns& from, const PositionColumns& to,
+                              const MovementLimits& limits, uint8_t* implausible) {
+    size_t n = std::min(from.size(), to.size());
+#if defined(VANET_MOVEMENT_AVX2)
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+    if (hasAvx2) {
+        return validateAvx2(from, to, limits, implausible, n);
+    }
+#elif defined(VANET_MOVEMENT_NEON)
+    return validateNeon(from, to, limits, implausible, n);
+#endif
+    return validateScalar(from, to, limits, implausible, 0, n);
+}
+
+} // namespace routing
+} // namespace vanet
@@ -0,0 +1,57 @@
+#ifndef VANET_MOVEMENT_CHECK_H
+#define VANET_MOVEMENT_CHECK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "routing-types.h"
+
+namespace vanet {
+namespace routing {
+
+// Positions stored column-wise for batch kernels. Timestamps are seconds
+// since the epoch; NaN marks a slot without a position.
+struct PositionColumns {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<double> t;
+
+    size_t size() const { return x.size(); }
+    void clear();
+    void push_back(const Position& position);
+    void pushEmpty();
+    void set(size_t i, const Position& position);
+    void setEmpty(size_t i);
+    // Timestamps come back rounded to milliseconds, the wire precision
+    Position get(size_t i) const;
+    bool empty(size_t i) const { return t[i] != t[i]; }
+    void moveRow(size_t from, size_t to);
+    void pop_back();
+
+    static double seconds(std::chrono::system_clock::time_point timestamp) {
+        return std::chrono::duration<double>(timestamp.time_since_epoch()).count();
+    }
+};
+
+// Plausibility thresholds, in the units SecureRoutingProtocol uses
+struct MovementLimits {
+    double maxSpeed;         // km/h
+    double maxAcceleration;  // (km/h) per second
+};
+
+// Checks the move from[i] -> to[i] for every i, with the same rules as
+// SecureRoutingProtocol::isValidMovement: whole seconds elapsed must be
+// positive, and neither the speed nor the speed over elapsed time may
+// exceed the limits. Compares squared distances, so no sqrt or division
+// per lane. Sets implausible[i] to 1 or 0 and returns the number of 1s.
+// Uses AVX2 where the CPU has it, NEON on AArch64, scalar code otherwise.
+size_t validateMovementsBatch(const PositionColumns& from, const PositionColumns& to,
+                              const MovementLimits& limits, uint8_t* implausible);
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_MOVEMENT_CHECK_H
@@ -0,0 +1,239 @@
+#include "node-table.h"
+#include <stdexcept>
+
+namespace vanet {
+namespace routing {
+
+NodeRegistry& NodeRegistry::instance() {
+    static NodeRegistry registry;
+    return registry;
+}
+
+NodeId NodeRegistry::intern(const std::string& id) {
+    auto it = ids.find(id);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    NodeId node = static_cast<NodeId>(names.size());
+    ids.emplace(id, node);
+    names.push_back(id);
+    return node;
+}
+
+NodeId NodeRegistry::find(const std::string& id) const {
+    auto it = ids.find(id);
+    return it == ids.end() ? INVALID_NODE : it->second;
+}
+
+const std::string& NodeRegistry::name(NodeId id) const {
+    if (id >= names.size()) {
+        throw std::out_of_range("Unknown node id");
+    }
+    return names[id];
+}
+
+NodeTable::NodeTable(size_t initialCapacity) {
+    size_t size = 8;
+    while (size < initialCapacity * 2) {
+        size <<= 1;
+    }
+    slots.assign(size, Slot{INVALID_NODE, NO_ROW});
+    mask = size - 1;
+}
+
+size_t NodeTable::slotOf(NodeId id) const {
+    // Fibonacci hashing spreads the dense IDs over the table
+    return static_cast<size_t>((uint64_t(id) * 11400714819323198485ULL) >> 32) & mask;
+}
+
+uint32_t NodeTable::find(NodeId id) const {
+    for (size_t i = slotOf(id);; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.id == id) {
+            return slot.row;
+        }
+        if (slot.id == INVALID_NODE) {
+            return NO_ROW;
+        }
+    }
+}
+
+uint32_t NodeTable::insert(NodeId id) {
+    uint32_t existing = find(id);
+    if (existing != NO_ROW) {
+        return existing;
+    }
+
+    // Keep the load factor at or below one half
+    if ((ids.size() + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    uint32_t row = static_cast<uint32_t>(ids.size());
+    ids.push_back(id);
+    fields.push_back(0);
+    routeNextHop.push_back(INVALID_NODE);
+    routeHopCount.push_back(0);
+    routeSequence.push_back(0);
+    routeTimestamp.emplace_back();
+    routeTrust.push_back(0.0);
+    neighborInfo.emplace_back();
+    beaconPosition.pushEmpty();
+    previousBeaconPosition.pushEmpty();
+    beaconBaseSequence.push_back(0);
+    beaconDeltaSequence.push_back(0);
+    beaconBase.emplace_back();
+    trustScore.push_back(0.0);
+    cachedTrust.push_back(0.0);
+    trustDirty.push_back(1);
+    forwarding.push_back(ForwardingCounters{});
+    senderCredential.push_back(0);
+    lastSequence.push_back(0);
+    sequenceWindow.push_back(0);
+    lastUpdate.emplace_back();
+
+    size_t i = slotOf(id);
+    while (slots[i].id != INVALID_NODE) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = Slot{id, row};
+    return row;
+}
+
+void NodeTable::clearField(uint32_t row, Field field) {
+    fields[row] &= ~field;
+    trustDirty[row] = 1;
+    if (field == NEIGHBOR) {
+        neighborInfo[row] = VehicleInfo{};
+        beaconPosition.setEmpty(row);
+        previousBeaconPosition.setEmpty(row);
+        beaconBaseSequence[row] = 0;
+        beaconDeltaSequence[row] = 0;
+    }
+    if (fields[row] == 0) {
+        removeRow(row);
+    }
+}
+
+void NodeTable::clear() {
+    ids.clear();
+    fields.clear();
+    routeNextHop.clear();
+    routeHopCount.clear();
+    routeSequence.clear();
+    routeTimestamp.clear();
+    routeTrust.clear();
+    neighborInfo.clear();
+    beaconPosition.clear();
+    previousBeaconPosition.clear();
+    beaconBaseSequence.clear();
+    beaconDeltaSequence.clear();
+    beaconBase.clear();
+    trustScore.clear();
+    cachedTrust.clear();
+    trustDirty.clear();
+    forwarding.clear();
+    senderCredential.clear();
+    lastSequence.clear();
+    sequenceWindow.clear();
+    lastUpdate.clear();
+    for (auto& slot : slots) {
+        slot = Slot{INVALID_NODE, NO_ROW};
+    }
+}
+
+void NodeTable::grow() {
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, Slot{INVALID_NODE, NO_ROW});
+    mask = slots.size() - 1;
+    for (const auto& slot : old) {
+        if (slot.id != INVALID_NODE) {
+            size_t i = slotOf(slot.id);
+            while (slots[i].id != INVALID_NODE) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+    }
+}
+
+void NodeTable::removeRow(uint32_t row) {
+    NodeId id = ids[row];
+    size_t i = slotOf(id);
+    while (slots[i].id != id) {
+        i = (i + 1) & mask;
+    }
+    eraseSlot(i);
+
+    // Move the last row into the hole and repoint its slot
+    uint32_t last = static_cast<uint32_t>(ids.size() - 1);
+    if (row != last) {
+        ids[row] = ids[last];
+        fields[row] = fields[last];
+        routeNextHop[row] = routeNextHop[last];
+        routeHopCount[row] = routeHopCount[last];
+        routeSequence[row] = routeSequence[last];
+        routeTimestamp[row] = routeTimestamp[last];
+        routeTrust[row] = routeTrust[last];
+        neighborInfo[row] = std::move(neighborInfo[last]);
+        beaconPosition.moveRow(last, row);
+        previousBeaconPosition.moveRow(last, row);
+        beaconBaseSequence[row] = beaconBaseSequence[last];
+        beaconDeltaSequence[row] = beaconDeltaSequence[last];
+        beaconBase[row] = beaconBase[last];
+        trustScore[row] = trustScore[last];
+        cachedTrust[row] = cachedTrust[last];
+        trustDirty[row] = trustDirty[last];
+        forwarding[row] = forwarding[last];
+        senderCredential[row] = senderCredential[last];
+        lastSequence[row] = lastSequence[last];
+        sequenceWindow[row] = sequenceWindow[last];
+        lastUpdate[row] = lastUpdate[last];
+
+        size_t j = slotOf(ids[row]);
+        while (slots[j].id != ids[row]) {
+            j = (j + 1) & mask;
+        }
+        slots[j].row = row;
+    }
+
+    ids.pop_back();
+    fields.pop_back();
+    routeNextHop.pop_back();
+    routeHopCount.pop_back();
+    routeSequence.pop_back();
+    routeTimestamp.pop_back();
+    routeTrust.pop_back();
+    neighborInfo.pop_back();
+    beaconPosition.pop_back();
+    previousBeaconPosition.pop_back();
+    beaconBaseSequence.pop_back();
+    beaconDeltaSequence.pop_back();
+    beaconBase.pop_back();
+    trustScore.pop_back();
+    cachedTrust.pop_back();
+    trustDirty.pop_back();
+    forwarding.pop_back();
+    senderCredential.pop_back();
+    lastSequence.pop_back();
+    sequenceWindow.pop_back();
+    lastUpdate.pop_back();
+}
+
+void NodeTable::eraseSlot(size_t slot) {
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    for (size_t i = (slot + 1) & mask; slots[i].id != INVALID_NODE; i = (i + 1) & mask) {
+        size_t home = slotOf(slots[i].id);
+        // Move the entry back if the hole lies on its probe path
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole] = Slot{INVALID_NODE, NO_ROW};
+}
+
+} // namespace routing
+} // namespace vanet
@@ -0,0 +1,121 @@
+#ifndef VANET_NODE_TABLE_H
+#define VANET_NODE_TABLE_H
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "forwarding-monitor.h"
+#include "movement-check.h"
+#include "routing-types.h"
+
+namespace vanet {
+namespace routing {
+
+// Compact integer handle for a vehicle ID
+using NodeId = uint32_t;
+constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();
+
+// Process-wide vehicle ID interning. IDs are dense and handed out in
+// first-seen order, so every protocol instance in a simulation agrees on
+// them. Not thread-safe: interning happens on the simulator thread.
+class NodeRegistry {
+public:
+    static NodeRegistry& instance();
+
+    NodeId intern(const std::string& id);
+    NodeId find(const std::string& id) const;  // INVALID_NODE if never interned
+    const std::string& name(NodeId id) const;
+    size_t size() const { return names.size(); }
+
+private:
+    std::unordered_map<std::string, NodeId> ids;
+    std::vector<std::string> names;
+};
+
+// Everything a protocol instance knows about other nodes, in one open
+// addressing hash table keyed by NodeId. The hash slots only map an ID to a
+// dense row; per-node state is stored column-wise (struct of arrays) so
+// sweeps such as expiry touch only the columns they need.
+//
+// A row holds any combination of fields; it disappears when its last field
+// is cleared. Removal swaps the last row into the hole, so row indices are
+// only stable until the next clearField().
+class NodeTable {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+    static constexpr uint32_t NO_ROW = std::numeric_limits<uint32_t>::max();
+
+    enum Field : uint8_t {
+        ROUTE = 1 << 0,     // route to the node
+        NEIGHBOR = 1 << 1,  // node is a one-hop neighbor
+        TRUST = 1 << 2,     // trust score observed
+        TRACKER = 1 << 3    // sequence tracking for messages from the node
+    };
+
+    explicit NodeTable(size_t initialCapacity = 16);
+
+    uint32_t find(NodeId id) const;
+    uint32_t insert(NodeId id);       // existing row, or a new empty one
+    bool has(uint32_t row, Field field) const { return fields[row] & field; }
+    void setField(uint32_t row, Field field) { fields[row] |= field; }
+    void clearField(uint32_t row, Field field);
+
+    size_t size() const { return ids.size(); }
+    void clear();
+
+    // Columns, indexed by row
+    std::vector<NodeId> ids;
+    std::vector<uint8_t> fields;
+
+    std::vector<NodeId> routeNextHop;
+    std::vector<uint32_t> routeHopCount;
+    std::vector<uint32_t> routeSequence;   // destination sequence number, 0 if unknown
+    std::vector<TimePoint> routeTimestamp;
+    std::vector<double> routeTrust;
+
+    std::vector<VehicleInfo> neighborInfo;
+    // Positions from the latest and the one before last beacon, for batch
+    // plausibility sweeps
+    PositionColumns beaconPosition;
+    PositionColumns previousBeaconPosition;
+    // Latest full beacon, which delta beacons are relative to; sequence 0 if none
+    std::vector<uint32_t> beaconBaseSequence;
+    // Last delta applied on top of it, the base sequence if none
+    std::vector<uint32_t> beaconDeltaSequence;
+    std::vector<Position> beaconBase;
+
+    std::vector<double> trustScore;
+    // Memoized calculateTrust() result, recomputed when trustDirty is set
+    std::vector<double> cachedTrust;
+    std::vector<uint8_t> trustDirty;
+    // Black-hole evidence, see ForwardingMonitor
+    std::vector<ForwardingCounters> forwarding;
+
+    // CryptoModule::senderIdentity() of the first verified frame from the
+    // node, which all later ones must match; 0 until then
+    std::vector<uint64_t> senderCredential;
+    std::vector<uint32_t> lastSequence;
+    std::vector<uint64_t> sequenceWindow;  // bit n set => (lastSequence - n) seen
+    std::vector<TimePoint> lastUpdate;
+
+private:
+    struct Slot {
+        NodeId id;
+        uint32_t row;
+    };
+    std::vector<Slot> slots;
+    size_t mask;
+
+    size_t slotOf(NodeId id) const;
+    void grow();
+    void removeRow(uint32_t row);
+    void eraseSlot(size_t slot);
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_NODE_TABLE_H
@@ -0,0 +1,187 @@
+#include "route-discovery.h"
+#include <algorithm>
+
+namespace vanet {
+namespace routing {
+
+constexpr uint64_t NODE_TRAVERSAL_MS = 40;      // one-hop processing and transmission estimate
+constexpr uint64_t TIMEOUT_BUFFER = 2;          // extra hops of slack per ring
+constexpr uint64_t RATE_INTERVAL_MS = 1000;     // least time between discoveries of one destination
+constexpr uint64_t FAILURE_BACKOFF_MS = 1000;   // holdoff after the first failed discovery
+constexpr uint32_t MAX_BACKOFF_SHIFT = 5;       // holdoff stops doubling at 32x
+
+static uint64_t pairKey(NodeId originator, uint32_t broadcastId) {
+    return (static_cast<uint64_t>(originator) << 32) | broadcastId;
+}
+
+DuplicateCache::DuplicateCache(size_t capacity, uint64_t lifetimeMs)
+    : lifetimeMs(lifetimeMs), entries(std::max<size_t>(capacity, 1)), next(0), count(0) {
+    // At most half full, like NodeTable
+    size_t size = 1;
+    while (size < entries.size() * 2) {
+        size <<= 1;
+    }
+    slots.assign(size, EMPTY);
+    mask = size - 1;
+}
+
+size_t DuplicateCache::slotOf(uint64_t key) const {
+    return static_cast<size_t>((key * 11400714819323198485ULL) >> 32) & mask;
+}
+
+size_t DuplicateCache::findSlot(uint64_t key) const {
+    for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+        if (slots[i] == EMPTY || entries[slots[i]].key == key) {
+            return i;
+        }
+    }
+}
+
+bool DuplicateCache::contains(NodeId originator, uint32_t broadcastId, uint64_t nowMs) const {
+    size_t slot = findSlot(pairKey(originator, broadcastId));
+    return slots[slot] != EMPTY && nowMs - entries[slots[slot]].timeMs < lifetimeMs;
+}
+
+bool DuplicateCache::insert(NodeId originator, uint32_t broadcastId, uint64_t nowMs) {
+    uint64_t key = pairKey(originator, broadcastId);
+    size_t slot = findSlot(key);
+    if (slots[slot] != EMPTY) {
+        Entry& entry = entries[slots[slot]];
+        if (nowMs - entry.timeMs < lifetimeMs) {
+            return false;
+        }
+        // A stale pair is a new flood that reused the ID; it keeps its ring position
+        entry.timeMs = nowMs;
+        return true;
+    }
+
+    if (count == entries.size()) {
+        eraseSlot(findSlot(entries[next].key));
+        slot = findSlot(key);
+    } else {
+        ++count;
+    }
+    entries[next] = Entry{key, nowMs};
+    slots[slot] = static_cast<uint32_t>(next);
+    next = (next + 1) % entries.size();
+    return true;
+}
+
+void DuplicateCache::clear() {
+    std::fill(slots.begin(), slots.end(), EMPTY);
+    next = 0;
+    count = 0;
+}
+
+void DuplicateCache::eraseSlot(size_t slot) {
+    // Backward-shift deletion, as in NodeTable::eraseSlot
+    size_t hole = slot;
+    for (size_t i = (slot + 1) & mask; slots[i] != EMPTY; i = (i + 1) & mask) {
+        size_t home = slotOf(entries[slots[i]].key);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole] = EMPTY;
+}
+
+RouteDiscovery::RouteDiscovery(uint8_t netDiameter)
+    : netDiameter(std::max(netDiameter, TTL_START)) {}
+
+uint64_t RouteDiscovery::ringTraversalMs(uint8_t ttl) {
+    return 2 * NODE_TRAVERSAL_MS * (ttl + TIMEOUT_BUFFER);
+}
+
+uint8_t RouteDiscovery::nextTtl(uint8_t ttl) const {
+    uint32_t widened = uint32_t(ttl) + TTL_INCREMENT;
+    return widened > TTL_THRESHOLD ? netDiameter : static_cast<uint8_t>(std::min<uint32_t>(widened, netDiameter));
+}
+
+bool RouteDiscovery::pending(NodeId destination) const {
+    return std::any_of(discoveries.begin(), discoveries.end(),
+                       [destination](const Discovery& d) { return d.destination == destination; });
+}
+
+uint8_t RouteDiscovery::begin(NodeId destination, uint64_t nowMs, uint8_t lastHopCount) {
+    if (pending(destination)) {
+        return 0;
+    }
+
+    auto it = holdoffs.find(destination);
+    if (it != holdoffs.end() &&
+        (nowMs < it->second.untilMs || nowMs - it->second.lastStartMs < RATE_INTERVAL_MS)) {
+        return 0;
+    }
+    if (it == holdoffs.end()) {
+        it = holdoffs.emplace(destination, Holdoff{0, 0, 0, 0}).first;
+    }
+    it->second.lastStartMs = nowMs;
+    it->second.forgetMs = std::max(it->second.forgetMs, nowMs + RATE_INTERVAL_MS);
+
+    uint8_t ttl = lastHopCount ? std::min<uint32_t>(lastHopCount + TTL_INCREMENT, netDiameter) : TTL_START;
+    discoveries.push_back(Discovery{destination, ttl, 0, nowMs + ringTraversalMs(ttl)});
+    return ttl;
+}
+
+void RouteDiscovery::complete(NodeId destination) {
+    for (size_t i = 0; i < discoveries.size(); ++i) {
+        if (discoveries[i].destination == destination) {
+            discoveries[i] = discoveries.back();
+            discoveries.pop_back();
+            break;
+        }
+    }
+    auto it = holdoffs.find(destination);
+    if (it != holdoffs.end()) {
+        it->second.failures = 0;
+        it->second.untilMs = 0;
+    }
+}
+
+size_t RouteDiscovery::expire(uint64_t nowMs, std::vector<Retry>& out) {
+    size_t appended = 0;
+    for (size_t i = 0; i < discoveries.size();) {
+        Discovery& d = discoveries[i];
+        if (nowMs < d.deadlineMs) {
+            ++i;
+            continue;
+        }
+
+        ++appended;
+        if (d.ttl < netDiameter || d.retries < RREQ_RETRIES) {
+            if (d.ttl < netDiameter) {
+                d.ttl = nextTtl(d.ttl);
+            } else {
+                ++d.retries;
+            }
+            d.deadlineMs = nowMs + ringTraversalMs(d.ttl);
+            out.push_back(Retry{d.destination, d.ttl});
+            ++i;
+            continue;
+        }
+
+        // Gave up; back off before the next discovery of this destination
+        Holdoff& holdoff = holdoffs[d.destination];
+        uint64_t backoff = FAILURE_BACKOFF_MS << std::min(holdoff.failures, MAX_BACKOFF_SHIFT);
+        holdoff.untilMs = nowMs + backoff;
+        holdoff.forgetMs = holdoff.untilMs + backoff;
+        ++holdoff.failures;
+        out.push_back(Retry{d.destination, 0});
+        discoveries[i] = discoveries.back();
+        discoveries.pop_back();
+    }
+
+    // Forget destinations once their holdoff has passed without a new failure
+    for (auto it = holdoffs.begin(); it != holdoffs.end();) {
+        if (nowMs >= it->second.forgetMs && !pending(it->first)) {
+            it = holdoffs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return appended;
+}
+
+} // namespace routing
+} // namespace vanet
@@ -0,0 +1,114 @@
+#ifndef VANET_ROUTE_DISCOVERY_H
+#define VANET_ROUTE_DISCOVERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "node-table.h"
+
+namespace vanet {
+namespace routing {
+
+// Bounded set of recently seen (originator, broadcast ID) pairs, for
+// dropping the copies of a flood that reach a node over several paths.
+// Once full, the oldest pair is evicted by each new one; pairs older than
+// lifetimeMs no longer count as seen. Lookup and insert are O(1).
+class DuplicateCache {
+public:
+    DuplicateCache(size_t capacity, uint64_t lifetimeMs);
+
+    // True the first time a pair is seen within the lifetime; records it
+    bool insert(NodeId originator, uint32_t broadcastId, uint64_t nowMs);
+    bool contains(NodeId originator, uint32_t broadcastId, uint64_t nowMs) const;
+
+    size_t size() const { return count; }
+    size_t capacity() const { return entries.size(); }
+    void clear();
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct Entry {
+        uint64_t key;
+        uint64_t timeMs;
+    };
+
+    uint64_t lifetimeMs;
+    std::vector<Entry> entries;    // insertion-ordered ring
+    size_t next;                   // ring position written next, the oldest once full
+    size_t count;
+    std::vector<uint32_t> slots;   // open addressing over ring positions
+    size_t mask;
+
+    size_t slotOf(uint64_t key) const;
+    size_t findSlot(uint64_t key) const;
+    void eraseSlot(size_t slot);
+};
+
+// Originator side of AODV-style route discovery (RFC 3561): expanding-ring
+// search and per-destination rate limiting. The owner sends the requests;
+// this only decides when and with which TTL. Times are milliseconds in the
+// owner's time base.
+//
+// A discovery starts with TTL_START and widens by TTL_INCREMENT each time
+// the ring traversal time passes without a reply, up to TTL_THRESHOLD and
+// then straight to netDiameter, where it is retried RREQ_RETRIES times.
+// After a discovery gives up, the destination is held off for a backoff
+// that doubles with every consecutive failure.
+class RouteDiscovery {
+public:
+    static constexpr uint8_t TTL_START = 1;
+    static constexpr uint8_t TTL_INCREMENT = 2;
+    static constexpr uint8_t TTL_THRESHOLD = 7;
+    static constexpr uint32_t RREQ_RETRIES = 2;
+
+    struct Retry {
+        NodeId destination;
+        uint8_t ttl;       // 0 when the discovery gave up
+    };
+
+    explicit RouteDiscovery(uint8_t netDiameter);
+
+    // TTL for a new request to destination, or 0 if one is already in
+    // flight or the destination is rate limited. lastHopCount, when known
+    // from an expired route, lets the search start near where it ended.
+    uint8_t begin(NodeId destination, uint64_t nowMs, uint8_t lastHopCount = 0);
+    // A route to destination arrived
+    void complete(NodeId destination);
+    bool pending(NodeId destination) const;
+    size_t inFlight() const { return discoveries.size(); }
+
+    // Appends every discovery whose ring timed out, with the TTL of its next
+    // request or 0 if it gave up; returns the number appended
+    size_t expire(uint64_t nowMs, std::vector<Retry>& out);
+
+    // Milliseconds a request with this TTL may take to be answered
+    static uint64_t ringTraversalMs(uint8_t ttl);
+
+private:
+    struct Discovery {
+        NodeId destination;
+        uint8_t ttl;
+        uint32_t retries;
+        uint64_t deadlineMs;
+    };
+
+    struct Holdoff {
+        uint64_t lastStartMs;
+        uint64_t untilMs;
+        uint64_t forgetMs;   // dropped from the table after this
+        uint32_t failures;
+    };
+
+    uint8_t netDiameter;
+    std::vector<Discovery> discoveries;
+    std::unordered_map<NodeId, Holdoff> holdoffs;
+
+    uint8_t nextTtl(uint8_t ttl) const;
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_ROUTE_DISCOVERY_H
@@ -0,0 +1,49 @@
+#ifndef VANET_ROUTING_TYPES_H
+#define VANET_ROUTING_TYPES_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vanet {
+namespace routing {
+
+struct Position {
+    double x;
+    double y;
+    double z;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+struct VehicleInfo {
+    std::string id;
+    Position position;
+    double speed;
+    double direction;
+    double trustScore;
+    std::vector<uint8_t> certificate;
+};
+
+struct RouteEntry {
+    std::string nextHop;
+    uint32_t hopCount;
+    std::chrono::system_clock::time_point timestamp;
+    double trustScore;
+};
+
+enum class MessageType {
+    HELLO,
+    ROUTE_REQUEST,
+    ROUTE_REPLY,
+    ROUTE_ERROR,
+    DATA
+};
+
+constexpr size_t MESSAGE_TYPE_COUNT = static_cast<size_t>(MessageType::DATA) + 1;
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_ROUTING_TYPES_H
@@ -0,0 +1,72 @@
+#include "secure-frame.h"
+#include "wire-format.h"
+#include <algorithm>
+
+namespace vanet {
+namespace routing {
+
+// Writes a u16 length and the bytes at out; returns the next free byte
+static uint8_t* storeField(uint8_t* out, crypto::ByteView field) {
+    out[0] = static_cast<uint8_t>(field.size());
+    out[1] = static_cast<uint8_t>(field.size() >> 8);
+    std::copy(field.begin(), field.end(), out + 2);
+    return out + 2 + field.size();
+}
+
+// Reads a u16-length field at offset and moves offset past it
+static bool loadField(crypto::ByteView frame, size_t& offset, crypto::ByteView& field) {
+    if (frame.size() - offset < 2) {
+        return false;
+    }
+    size_t length = frame[offset] | (frame[offset + 1] << 8);
+    offset += 2;
+    if (frame.size() - offset < length) {
+        return false;
+    }
+    field = frame.subview(offset, length);
+    offset += length;
+    return true;
+}
+
+size_t encodeSecureFrame(const crypto::CryptoModule::SecureMessageView& message,
+                         uint8_t* out, size_t capacity) {
+    size_t size = secureFrameSize(message);
+    for (auto field : {message.payload, message.signature, message.senderCert,
+                       message.sessionOffer, message.sessionTags}) {
+        if (field.size() > UINT16_MAX) {
+            return 0;
+        }
+    }
+    if (capacity < size) {
+        return 0;
+    }
+
+    out[0] = SECURE_FRAME_MARKER;
+    uint8_t* p = storeField(out + 1, message.payload);
+    storeLE64(p, message.timestamp);
+    storeLE32(p + 8, message.sequenceNumber);
+    p = storeField(p + 12, message.signature);
+    p = storeField(p, message.senderCert);
+    p = storeField(p, message.sessionOffer);
+    storeField(p, message.sessionTags);
+    return size;
+}
+
+bool parseSecureFrame(crypto::ByteView frame, crypto::CryptoModule::SecureMessageView& out) {
+    if (!isSecureFrame(frame)) {
+        return false;
+    }
+    size_t offset = 1;
+    if (!loadField(frame, offset, out.payload) || frame.size() - offset < 12) {
+        return false;
+    }
+    out.timestamp = loadLE64(frame.data() + offset);
+    out.sequenceNumber = loadLE32(frame.data() + offset + 8);
+    offset += 12;
+    return loadField(frame, offset, out.signature) && loadField(frame, offset, out.senderCert) &&
+           loadField(frame, offset, out.sessionOffer) && loadField(frame, offset, out.sessionTags) &&
+           offset == frame.size();
+}
+
+} // namespace routing
+} // namespace vanet
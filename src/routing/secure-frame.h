@@ -0,0 +1,49 @@
+#ifndef VANET_SECURE_FRAME_H
+#define VANET_SECURE_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include "../crypto/byte-view.h"
+#include "../crypto/crypto-module.h"
+
+namespace vanet {
+namespace routing {
+
+// Frame as put on the air: a CryptoModule::SecureMessage whose payload is
+// one routing message (see wire-format.h). All fields little-endian:
+//
+//   offset  size  field
+//        0     1  SECURE_FRAME_MARKER
+//        1     2  u16 payload length n
+//        3     n  payload
+//      3+n     8  timestamp, ms since epoch
+//     11+n     4  sequence number
+//     15+n        signature, sender credential, session offer, session tags:
+//                 each a u16 length, then the bytes (0 if absent)
+//
+// Routing messages start with WIRE_VERSION, so a receiver tells frames
+// from bare delta beacons, which go out unsecured outside session mode, by
+// the first byte.
+constexpr uint8_t SECURE_FRAME_MARKER = 0x80;
+constexpr size_t SECURE_FRAME_FRAMING = 11;   // marker and lengths, on top of SecureMessageView::wireSize()
+
+inline bool isSecureFrame(crypto::ByteView bytes) {
+    return !bytes.empty() && bytes[0] == SECURE_FRAME_MARKER;
+}
+
+inline size_t secureFrameSize(const crypto::CryptoModule::SecureMessageView& message) {
+    return message.wireSize() + SECURE_FRAME_FRAMING;
+}
+
+// Returns the number of bytes written, or 0 if the buffer is too small or
+// a field does not fit its u16 length
+size_t encodeSecureFrame(const crypto::CryptoModule::SecureMessageView& message,
+                         uint8_t* out, size_t capacity);
+// The fields of out point into frame, which must outlive them; false if
+// it is truncated or has bytes left over
+bool parseSecureFrame(crypto::ByteView frame, crypto::CryptoModule::SecureMessageView& out);
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_SECURE_FRAME_H
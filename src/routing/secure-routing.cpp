@@ -1,4 +1,5 @@
 #include "secure-routing.h"
+#include "state-codec.h"
 #include <cmath>
 #include <algorithm>
 #include <stdexcept>
@@ -16,11 +17,49 @@ constexpr double MAX_ACCELERATION = 10.0; // m/s^2
 constexpr std::chrono::seconds ROUTE_TIMEOUT(60);
 constexpr std::chrono::seconds NEIGHBOR_TIMEOUT(10);
 constexpr uint32_t MAX_HOP_COUNT = 10;
+constexpr uint64_t EXPIRY_TICK_MS = 100;           // Timer wheel resolution
+constexpr uint8_t STATE_VERSION = 3;               // exportState() snapshot layout
+constexpr double SPATIAL_CELL_SIZE = 50.0;         // meters
+constexpr double SYBIL_RADIUS = 1.0;               // meters; no two vehicles are closer
+constexpr size_t SYBIL_MIN_IDENTITIES = 2;         // identities at one spot that count as Sybil
+constexpr uint64_t MAX_MESSAGE_AGE_MS = 5000;      // Oldest routing message accepted
+constexpr uint32_t SEQUENCE_WINDOW = 64;           // Out-of-order tolerance per sender
+constexpr double FULL_VERIFY_TRUST_THRESHOLD = 0.8; // Less trusted senders are always fully verified
+constexpr size_t REQUEST_CACHE_SIZE = 1024;        // (originator, broadcast ID) pairs remembered
+constexpr double DELTA_POSITION_SLACK = 1.0;       // meters of position error a delta may add
+
+static uint64_t toMillis(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+static uint64_t toNanos(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+static uint64_t expiryKey(NodeId node, NodeTable::Field field) {
+    return (static_cast<uint64_t>(node) << 32) | field;
+}
+
+VerificationPolicy::VerificationPolicy() : trustThreshold(FULL_VERIFY_TRUST_THRESHOLD) {
+    modes.fill(VerificationMode::FULL);
+    // DATA is the only type relayed hop by hop without being consumed
+    setMode(MessageType::DATA, VerificationMode::ON_DEMAND);
+}
 
 SecureRoutingProtocol::SecureRoutingProtocol(const std::string& id) 
-    : vehicleId(id), cryptoModule(std::make_unique<crypto::CryptoModule>()) {
+    : vehicleId(id), cryptoModule(std::make_unique<crypto::CryptoModule>()),
+      selfId(NodeRegistry::instance().intern(id)), nextSequence(0), expiryWheel(EXPIRY_TICK_MS),
+      neighborGrid(SPATIAL_CELL_SIZE), verificationStats{0, 0, 0},
+      // A flood dies out within a path discovery time: twice a full-diameter ring
+      requestCache(REQUEST_CACHE_SIZE, 2 * RouteDiscovery::ringTraversalMs(MAX_HOP_COUNT)),
+      routeDiscovery(MAX_HOP_COUNT), nextBroadcastId(0), localRouteSequence(0),
+      discoveryStats{0, 0, 0, 0, 0, 0, 0}, beaconStats{0, 0, 0, 0, 0, 0}, beaconBaseSequence(0),
+      beaconBase{}, allocationStats{0, 0, 0, 0, 0},
+      cryptoEngine(nullptr), traceSink(nullptr) {
     localInfo.id = id;
     localInfo.trustScore = MAX_TRUST_SCORE;
+    cryptoModule->setInstrumentation(&instrumentation);
+    cryptoModule->setClock(&eventClock);
 }
 
 SecureRoutingProtocol::~SecureRoutingProtocol() = default;
@@ -34,81 +73,163 @@ bool SecureRoutingProtocol::initializeVehicle(const VehicleInfo& info) {
     return cryptoModule->generateKeyPair();
 }
 
+bool SecureRoutingProtocol::initializeVehicle(const VehicleInfo& info, crypto::ByteView identity) {
+    if (info.id != vehicleId) {
+        return false;
+    }
+
+    localInfo = info;
+    return cryptoModule->importIdentity(identity);
+}
+
+void SecureRoutingProtocol::setClock(const crypto::Clock& source) {
+    eventClock.setSource(source);
+}
+
 bool SecureRoutingProtocol::updatePosition(const Position& newPos) {
-    if (!isValidMovement(localInfo.position, newPos, 
+    auto now = eventClock.refresh();
+    bool plausible = isValidMovement(localInfo.position, newPos,
         std::chrono::duration_cast<std::chrono::seconds>(
-            newPos.timestamp - localInfo.position.timestamp).count())) {
-        return false;
+            newPos.timestamp - localInfo.position.timestamp).count());
+    if (plausible) {
+        localInfo.position = newPos;
     }
     
-    localInfo.position = newPos;
-    pruneExpiredEntries();
-    return true;
+    // Timers are due whether or not the fix is accepted, so a scheduler
+    // moving vehicles in batches is all it takes to drive them
+    pruneExpiredEntries(now);
+    retryRouteDiscoveries(toMillis(now));
+    return plausible;
 }
 
 bool SecureRoutingProtocol::sendData(const std::string& destination, const std::vector<uint8_t>& data) {
-    auto routeIt = routingTable.find(destination);
-    if (routeIt == routingTable.end()) {
+    eventClock.refresh();
+    NodeId dest = NodeRegistry::instance().intern(destination);
+    uint32_t row = lookupRoute(dest);
+    if (row == NodeTable::NO_ROW) {
         if (!findRoute(destination)) {
             return false;
         }
-        routeIt = routingTable.find(destination);
+        row = lookupRoute(dest);
+        if (row == NodeTable::NO_ROW) {
+            return false;
+        }
     }
     
-    if (!isVehicleTrusted(routeIt->second.nextHop)) {
+    if (calculateTrust(nodes.routeNextHop[row]) < TRUST_THRESHOLD) {
         invalidateRoute(destination);
         return false;
     }
     
-    // Create secure message
-    auto message = createRoutingMessage(MessageType::DATA, destination);
-    message.insert(message.end(), data.begin(), data.end());
+    sendDataPacket(dest, row, selfId, crypto::ByteView(data), MAX_HOP_COUNT);
+    return true;
+}
+
+void SecureRoutingProtocol::sendDataPacket(NodeId destination, uint32_t routeRow, NodeId originator,
+                                           crypto::ByteView body, uint8_t ttl) {
+    NodeId nextHop = nodes.routeNextHop[routeRow];
+    MessageHeader header = routingHeader(MessageType::DATA, destination);
+    header.ttl = ttl;
     
-    // Sign and encrypt using crypto module
-    auto secureMessage = cryptoModule->createSecureMessage(message);
+    // Create secure message
+    auto* resource = beginPacket();
+    std::pmr::vector<uint8_t> message(DATA_HEADER_SIZE + body.size(), resource);
+    size_t length = encodeDataHeader(header, DataHop{originator, nextHop}, message.data(), message.size());
+    std::copy(body.begin(), body.end(), message.begin() + length);
     
-    // Send to next hop (implementation depends on network layer)
-    // For simulation purposes, this would interface with NS-3
-    return true;
+    // Sign and send to next hop, which we should then hear relaying it
+    // unless it is the destination
+    signAndSend(crypto::ByteView(message), resource);
+    if (nextHop != destination) {
+        recordForwarding(nodes.find(nextHop), ForwardingEvent::HANDED_OFF);
+    }
 }
 
-bool SecureRoutingProtocol::receiveMessage(const std::vector<uint8_t>& message) {
-    if (!verifyRoutingMessage(message)) {
+bool SecureRoutingProtocol::receiveMessage(crypto::ByteView frame) {
+    beaconControl.heard(toMillis(eventClock.refresh()), frame.size());
+    
+    // Everything but bare delta beacons comes in a secure frame
+    crypto::CryptoModule::SecureMessageView secure;
+    bool framed = isSecureFrame(frame);
+    if (framed && !parseSecureFrame(frame, secure)) {
+        ++verificationStats.rejected;
+        tracePacket(TraceEvent::REJECT, frame, TraceReason::MALFORMED);
         return false;
     }
+    crypto::ByteView message = framed ? secure.payload : frame;
+    if (isDeltaBeacon(message)) {
+        return handleDeltaBeacon(message, framed ? &secure : nullptr);
+    }
+    
+    MessageView view;
+    if (!framed || !view.parse(message)) {
+        ++verificationStats.rejected;
+        tracePacket(TraceEvent::REJECT, message, TraceReason::MALFORMED);
+        return false;
+    }
+    if (!passesCheapChecks(view)) {
+        ++verificationStats.rejected;
+        tracePacket(TraceEvent::REJECT, view.raw(), TraceReason::STALE_OR_REPLAYED);
+        return false;
+    }
+    
+    // Signatures are only checked where the policy asks for it. Source and
+    // sequence of an unverified frame may be forged, so only verified ones
+    // advance the sender's window, and unverified ones must stay close to it.
+    bool verified = needsFullVerification(view);
+    if (verified) {
+        ++verificationStats.fullVerifications;
+        if (!verifyRoutingMessage(secure, view.source())) {
+            ++verificationStats.rejected;
+            tracePacket(TraceEvent::REJECT, view.raw(), TraceReason::BAD_SIGNATURE);
+            return false;
+        }
+    } else {
+        if (!isNearVerifiedSequence(view.source(), view.sequence())) {
+            ++verificationStats.rejected;
+            tracePacket(TraceEvent::REJECT, view.raw(), TraceReason::STALE_OR_REPLAYED);
+            return false;
+        }
+        ++verificationStats.cheapChecks;
+    }
+    uint32_t sourceRow = verified ? recordSequence(view.source(), view.sequence()) : nodes.find(view.source());
+    tracePacket(TraceEvent::RECEIVE, view.raw());
     
-    // Extract message type and handle accordingly
-    MessageType type = static_cast<MessageType>(message[0]);
-    switch (type) {
+    // Handle according to message type
+    switch (view.type()) {
         case MessageType::HELLO:
-            return processBeacon(message);
+            return handleBeacon(view);
         case MessageType::ROUTE_REQUEST:
-            // Handle route request
-            break;
+            return handleRouteRequest(view);
         case MessageType::ROUTE_REPLY:
-            // Handle route reply
-            break;
+            return handleRouteReply(view);
         case MessageType::ROUTE_ERROR:
-            // Handle route error
-            break;
+            return handleRouteError(view);
         case MessageType::DATA:
-            // Handle data message
-            break;
+            return handleData(view, sourceRow);
     }
     
     return true;
 }
 
 bool SecureRoutingProtocol::findRoute(const std::string& destination) {
-    // Create RREQ message
-    auto rreq = createRoutingMessage(MessageType::ROUTE_REQUEST, destination);
-    
-    // Sign message
-    auto secureRreq = cryptoModule->createSecureMessage(rreq);
+    eventClock.refresh();
+    NodeId dest = NodeRegistry::instance().intern(destination);
+    if (lookupRoute(dest) != NodeTable::NO_ROW) {
+        return true;
+    }
     
-    // Broadcast to neighbors (implementation depends on network layer)
-    // For simulation purposes, this would interface with NS-3
+    // An expired route's hop count tells where the search can start
+    uint32_t row = nodes.find(dest);
+    uint32_t lastHops = row == NodeTable::NO_ROW ? 0 : nodes.routeHopCount[row];
+    uint8_t ttl = routeDiscovery.begin(dest, eventClock.nowMillis(),
+                                       static_cast<uint8_t>(std::min(lastHops, MAX_HOP_COUNT)));
+    if (ttl == 0) {
+        ++discoveryStats.requestsThrottled;
+        return false;
+    }
     
+    sendRouteRequest(dest, ttl);
     return true;
 }
 
@@ -117,48 +238,85 @@ bool SecureRoutingProtocol::updateRoute(const std::string& destination, const Ro
         return false;
     }
     
-    auto now = std::chrono::system_clock::now();
+    auto now = eventClock.refresh();
     if (entry.timestamp + ROUTE_TIMEOUT < now) {
         return false;
     }
     
-    routingTable[destination] = entry;
+    auto& registry = NodeRegistry::instance();
+    NodeId dest = registry.intern(destination);
+    uint32_t row = nodes.insert(dest);
+    nodes.routeNextHop[row] = registry.intern(entry.nextHop);
+    nodes.routeHopCount[row] = entry.hopCount;
+    nodes.routeTimestamp[row] = entry.timestamp;
+    nodes.routeTrust[row] = entry.trustScore;
+    nodes.setField(row, NodeTable::ROUTE);
+    scheduleExpiry(dest, NodeTable::ROUTE, entry.timestamp);
     return true;
 }
 
 bool SecureRoutingProtocol::invalidateRoute(const std::string& destination) {
-    auto it = routingTable.find(destination);
-    if (it != routingTable.end()) {
-        routingTable.erase(it);
+    NodeId dest = NodeRegistry::instance().find(destination);
+    uint32_t row = dest == INVALID_NODE ? NodeTable::NO_ROW : nodes.find(dest);
+    if (row != NodeTable::NO_ROW && nodes.has(row, NodeTable::ROUTE)) {
+        // The broken route is announced with a newer sequence number, so
+        // nobody takes the old one back
+        RouteError error{dest, nodes.routeSequence[row] + 1};
+        nodes.routeSequence[row] = error.sequence;
+        nodes.clearField(row, NodeTable::ROUTE);
+        expiryWheel.cancel(expiryKey(dest, NodeTable::ROUTE));
         
         // Create and broadcast RERR message
-        auto rerr = createRoutingMessage(MessageType::ROUTE_ERROR, destination);
-        auto secureRerr = cryptoModule->createSecureMessage(rerr);
-        
-        // Broadcast RERR (implementation depends on network layer)
+        uint8_t rerr[ROUTE_ERROR_SIZE];
+        size_t length = encodeRouteError(routingHeader(MessageType::ROUTE_ERROR, BROADCAST_NODE),
+                                         error, rerr, sizeof(rerr));
+        signAndSend(crypto::ByteView(rerr, length), beginPacket());
         return true;
     }
     return false;
 }
 
 double SecureRoutingProtocol::calculateTrust(const std::string& vehicleId) {
-    auto it = trustScores.find(vehicleId);
-    if (it == trustScores.end()) {
+    NodeId node = NodeRegistry::instance().find(vehicleId);
+    if (node == INVALID_NODE) {
+        return MIN_TRUST_SCORE;
+    }
+    return calculateTrust(node);
+}
+
+double SecureRoutingProtocol::calculateTrust(NodeId node) {
+    crypto::ScopedStageTimer timer(&instrumentation, crypto::Stage::TRUST);
+    uint32_t row = nodes.find(node);
+    if (row == NodeTable::NO_ROW || !nodes.has(row, NodeTable::TRUST)) {
         return MIN_TRUST_SCORE;
     }
     
+    // Detection only reruns after an event that can change its outcome
+    if (nodes.trustDirty[row]) {
+        nodes.cachedTrust[row] = evaluateTrust(row);
+        nodes.trustDirty[row] = 0;
+    }
+    return nodes.cachedTrust[row];
+}
+
+double SecureRoutingProtocol::evaluateTrust(uint32_t row) {
     // Factor in various trust metrics
-    double score = it->second;
+    double score = nodes.trustScore[row];
+    const std::string& vehicleId = NodeRegistry::instance().name(nodes.ids[row]);
     
     // Check for suspicious behavior
-    if (detectBlackHole(vehicleId) || detectSybil(vehicleId)) {
+    if (detectBlackHole(vehicleId)) {
+        traceAlert(nodes.ids[row], TraceReason::BLACK_HOLE);
+        score *= 0.5;
+    } else if (detectSybil(vehicleId)) {
+        traceAlert(nodes.ids[row], TraceReason::SYBIL);
         score *= 0.5;
     }
     
-    // Verify position consistency
-    auto neighborIt = neighborTable.find(vehicleId);
-    if (neighborIt != neighborTable.end()) {
-        if (detectPositionFalsification(vehicleId, neighborIt->second.position)) {
+    // Verify position consistency of the last move beaconed
+    if (nodes.has(row, NodeTable::NEIGHBOR) && !nodes.previousBeaconPosition.empty(row)) {
+        if (isFalsifiedMove(nodes.ids[row], nodes.previousBeaconPosition.get(row), nodes.neighborInfo[row].position)) {
+            traceAlert(nodes.ids[row], TraceReason::POSITION_FALSIFICATION);
             score *= 0.5;
         }
     }
@@ -166,11 +324,32 @@ double SecureRoutingProtocol::calculateTrust(const std::string& vehicleId) {
     return std::clamp(score, MIN_TRUST_SCORE, MAX_TRUST_SCORE);
 }
 
+uint32_t SecureRoutingProtocol::lookupRoute(NodeId destination) {
+    crypto::ScopedStageTimer timer(&instrumentation, crypto::Stage::ROUTE_LOOKUP);
+    uint32_t row = nodes.find(destination);
+    return row != NodeTable::NO_ROW && nodes.has(row, NodeTable::ROUTE) ? row : NodeTable::NO_ROW;
+}
+
 void SecureRoutingProtocol::updateTrustScore(const std::string& vehicleId, double score) {
-    double currentScore = trustScores[vehicleId];
+    uint32_t row = nodes.insert(NodeRegistry::instance().intern(vehicleId));
+    double currentScore = nodes.has(row, NodeTable::TRUST) ? nodes.trustScore[row] : 0.0;
     // Use exponential moving average
     constexpr double alpha = 0.3;
-    trustScores[vehicleId] = (alpha * score) + ((1 - alpha) * currentScore);
+    nodes.trustScore[row] = (alpha * score) + ((1 - alpha) * currentScore);
+    nodes.setField(row, NodeTable::TRUST);
+    nodes.trustDirty[row] = 1;
+}
+
+void SecureRoutingProtocol::invalidateTrustNear(const Position& position) {
+    // Sybil and position checks of every vehicle this close see the change
+    queryScratch.clear();
+    neighborGrid.queryRadius(position, SYBIL_RADIUS, queryScratch);
+    for (NodeId node : queryScratch) {
+        uint32_t row = nodes.find(node);
+        if (row != NodeTable::NO_ROW) {
+            nodes.trustDirty[row] = 1;
+        }
+    }
 }
 
 bool SecureRoutingProtocol::isVehicleTrusted(const std::string& vehicleId) {
@@ -178,24 +357,112 @@ bool SecureRoutingProtocol::isVehicleTrusted(const std::string& vehicleId) {
 }
 
 void SecureRoutingProtocol::sendBeacon() {
-    auto beacon = createRoutingMessage(MessageType::HELLO, "");
-    auto secureBeacon = cryptoModule->createSecureMessage(beacon);
+    sendFullBeacon(toMillis(eventClock.refresh()));
+}
+
+bool SecureRoutingProtocol::sendBeaconIfDue() {
+    uint64_t nowMs = toMillis(eventClock.refresh());
+    BeaconKind kind = beaconControl.due(nowMs, localInfo);
+    if (kind == BeaconKind::NONE) {
+        ++beaconStats.suppressed;
+        return false;
+    }
+    // A delta that does not fit its fields goes out as a full beacon
+    if (kind == BeaconKind::FULL || !sendDeltaBeacon(nowMs)) {
+        sendFullBeacon(nowMs);
+    }
+    return true;
+}
+
+void SecureRoutingProtocol::sendFullBeacon(uint64_t nowMs) {
+    uint8_t beacon[BEACON_SIZE];
+    size_t length = createRoutingMessage(MessageType::HELLO, BROADCAST_NODE, beacon, sizeof(beacon));
+    size_t bytes = signAndSend(crypto::ByteView(beacon, length), beginPacket());
     
-    // Broadcast beacon (implementation depends on network layer)
+    // Receivers see the position as encoded, so deltas start from that
+    beaconBaseSequence = nextSequence;
+    beaconBase = {static_cast<float>(localInfo.position.x), static_cast<float>(localInfo.position.y),
+                  static_cast<float>(localInfo.position.z),
+                  std::chrono::system_clock::time_point(std::chrono::milliseconds(nowMs))};
+    beaconControl.sent(nowMs, BeaconKind::FULL, localInfo, bytes);
+    ++beaconStats.fullBeacons;
+    beaconStats.bytesSent += bytes;
+}
+
+bool SecureRoutingProtocol::sendDeltaBeacon(uint64_t nowMs) {
+    uint64_t baseMs = toMillis(beaconBase.timestamp);
+    DeltaBeacon delta{selfId, nextSequence + 1, beaconBaseSequence, static_cast<uint32_t>(nowMs - baseMs),
+                      localInfo.position.x - beaconBase.x, localInfo.position.y - beaconBase.y,
+                      localInfo.position.z - beaconBase.z, localInfo.speed, localInfo.direction};
+    uint8_t beacon[DELTA_BEACON_SIZE];
+    if (beaconBaseSequence == 0 || nowMs < baseMs || nowMs - baseMs > UINT16_MAX ||
+        delta.sequence - beaconBaseSequence > SEQUENCE_WINDOW ||
+        encodeDeltaBeacon(delta, beacon, sizeof(beacon)) == 0) {
+        return false;
+    }
+    ++nextSequence;
+    
+    size_t bytes = DELTA_BEACON_SIZE;
+    if (cryptoModule->sessionsEnabled()) {
+        bytes = signAndSend(crypto::ByteView(beacon, sizeof(beacon)), beginPacket());
+    } else {
+        tracePacket(TraceEvent::SEND, crypto::ByteView(beacon, sizeof(beacon)));
+        if (transmitter) {
+            transmitter(crypto::ByteView(beacon, sizeof(beacon)));
+        }
+    }
+    beaconControl.sent(nowMs, BeaconKind::DELTA, localInfo, bytes);
+    ++beaconStats.deltaBeacons;
+    beaconStats.bytesSent += bytes;
+    return true;
 }
 
 bool SecureRoutingProtocol::processBeacon(const std::vector<uint8_t>& beacon) {
-    // Extract vehicle info from beacon
-    VehicleInfo info;
-    // ... parse beacon data ...
+    eventClock.refresh();
+    crypto::CryptoModule::SecureMessageView secure;
+    MessageView view;
+    if (!parseSecureFrame(crypto::ByteView(beacon), secure) || !view.parse(secure.payload) || !view.isBeacon()) {
+        return false;
+    }
     
     // Verify certificate
-    if (!cryptoModule->verifySecureMessage(crypto::CryptoModule::SecureMessage{/*...*/})) {
+    if (!verifyRoutingMessage(secure, view.source())) {
+        return false;
+    }
+    return handleBeacon(view);
+}
+
+bool SecureRoutingProtocol::handleBeacon(const MessageView& view) {
+    // Extract vehicle info from beacon
+    auto& registry = NodeRegistry::instance();
+    NodeId neighbor = view.source();
+    if (!view.isBeacon() || neighbor >= registry.size() || neighbor == selfId) {
         return false;
     }
     
+    uint32_t row = nodes.insert(neighbor);
+    VehicleInfo& info = nodes.neighborInfo[row];
+    if (info.id.empty()) {
+        info.id = registry.name(neighbor);
+        info.trustScore = MIN_TRUST_SCORE;
+    }
+    if (nodes.has(row, NodeTable::NEIGHBOR)) {
+        invalidateTrustNear(info.position);
+        nodes.previousBeaconPosition.set(row, info.position);
+    }
+    info.position = view.position();
+    nodes.beaconPosition.set(row, info.position);
+    nodes.beaconBaseSequence[row] = view.sequence();
+    nodes.beaconDeltaSequence[row] = view.sequence();
+    nodes.beaconBase[row] = info.position;
+    info.speed = view.speed();
+    info.direction = view.direction();
+    
     // Update neighbor table
-    neighborTable[info.id] = info;
+    nodes.setField(row, NodeTable::NEIGHBOR);
+    neighborGrid.update(neighbor, info.position);
+    invalidateTrustNear(info.position);
+    scheduleExpiry(neighbor, NodeTable::NEIGHBOR, info.position.timestamp);
     
     // Update trust score based on beacon validity
     updateTrustScore(info.id, 1.0);
@@ -203,16 +470,486 @@ bool SecureRoutingProtocol::processBeacon(const std::vector<uint8_t>& beacon) {
     return true;
 }
 
+bool SecureRoutingProtocol::handleDeltaBeacon(crypto::ByteView message,
+                                              const crypto::CryptoModule::SecureMessageView* secure) {
+    // Only a continuation of the last full beacon accepted from the sender
+    // counts, after the last delta applied to it and close enough to it
+    // that a forged sequence cannot run far ahead
+    DeltaBeacon delta;
+    uint32_t row = decodeDeltaBeacon(message, delta) ? nodes.find(delta.source) : NodeTable::NO_ROW;
+    if (row == NodeTable::NO_ROW || !nodes.has(row, NodeTable::NEIGHBOR) ||
+        nodes.beaconBaseSequence[row] == 0 || delta.baseSequence != nodes.beaconBaseSequence[row] ||
+        delta.sequence <= nodes.beaconDeltaSequence[row] || delta.sequence - delta.baseSequence > SEQUENCE_WINDOW ||
+        !isFreshSequence(delta.source, delta.sequence)) {
+        ++beaconStats.deltasDropped;
+        tracePacket(TraceEvent::REJECT, message, TraceReason::STALE_OR_REPLAYED);
+        return false;
+    }
+    
+    const Position& base = nodes.beaconBase[row];
+    Position position{base.x + delta.dx, base.y + delta.dy, base.z + delta.dz,
+                      base.timestamp + std::chrono::milliseconds(delta.elapsedMs)};
+    uint64_t nowMs = eventClock.nowMillis();
+    uint64_t timestamp = toMillis(position.timestamp);
+    if (timestamp > nowMs || nowMs - timestamp > MAX_MESSAGE_AGE_MS) {
+        ++beaconStats.deltasDropped;
+        tracePacket(TraceEvent::REJECT, message, TraceReason::STALE_OR_REPLAYED);
+        return false;
+    }
+    
+    // Nothing signed vouches for the move, so it must be one the vehicle could make
+    double moved = std::sqrt(delta.dx * delta.dx + delta.dy * delta.dy + delta.dz * delta.dz);
+    if (moved > MAX_SPEED / 3.6 * delta.elapsedMs / 1000.0 + DELTA_POSITION_SLACK) {
+        ++beaconStats.deltasDropped;
+        tracePacket(TraceEvent::REJECT, message, TraceReason::POSITION_FALSIFICATION);
+        return false;
+    }
+    
+    // Secured deltas must verify, and in session mode bare ones are not
+    // taken at all. Only verified ones advance the sender's window.
+    if (secure || cryptoModule->sessionsEnabled()) {
+        if (!secure || !verifyRoutingMessage(*secure, delta.source)) {
+            ++beaconStats.deltasDropped;
+            tracePacket(TraceEvent::REJECT, message, TraceReason::BAD_SIGNATURE);
+            return false;
+        }
+        recordSequence(delta.source, delta.sequence);
+    }
+    nodes.beaconDeltaSequence[row] = delta.sequence;
+    tracePacket(TraceEvent::RECEIVE, message);
+    
+    VehicleInfo& info = nodes.neighborInfo[row];
+    invalidateTrustNear(info.position);
+    nodes.previousBeaconPosition.set(row, info.position);
+    info.position = position;
+    nodes.beaconPosition.set(row, position);
+    info.speed = delta.speed;
+    info.direction = delta.direction;
+    neighborGrid.update(delta.source, position);
+    invalidateTrustNear(position);
+    scheduleExpiry(delta.source, NodeTable::NEIGHBOR, position.timestamp);
+    ++beaconStats.deltasApplied;
+    return true;
+}
+
+bool SecureRoutingProtocol::handleRouteRequest(const MessageView& view) {
+    RouteRequest request;
+    if (!view.routeRequest(request) || request.hopCount >= MAX_HOP_COUNT) {
+        return false;
+    }
+    // The first copy of a flood is sent by its originator; later ones are
+    // vouched for by the hops that verified the copies before
+    if (request.hopCount == 0 && request.originator != view.source()) {
+        return false;
+    }
+    
+    // Each flood is handled once however many neighbors repeat it; this
+    // also drops our own requests coming back
+    auto now = eventClock.now();
+    if (request.originator == selfId ||
+        !requestCache.insert(request.originator, request.broadcastId, toMillis(now))) {
+        ++discoveryStats.duplicatesDropped;
+        return true;
+    }
+    
+    // Reverse route, for the reply to follow back
+    uint32_t hops = request.hopCount + 1u;
+    installRoute(request.originator, view.source(), hops, request.originatorSequence, now);
+    
+    NodeId target = view.destination();
+    if (target == selfId) {
+        localRouteSequence = std::max(localRouteSequence + 1, request.destinationSequence);
+        RouteReply reply{selfId, localRouteSequence, view.source(),
+                         static_cast<uint32_t>(std::chrono::milliseconds(ROUTE_TIMEOUT).count()), 0};
+        sendRouteReply(request.originator, reply, static_cast<uint8_t>(std::min(hops, MAX_HOP_COUNT)));
+        ++discoveryStats.repliesSent;
+        return true;
+    }
+    
+    // A route at least as fresh as the originator asks for answers here
+    // and ends the flood on this branch
+    uint32_t row = lookupRoute(target);
+    if (row != NodeTable::NO_ROW && nodes.routeSequence[row] != 0 &&
+        static_cast<int32_t>(nodes.routeSequence[row] - request.destinationSequence) >= 0) {
+        auto remaining = nodes.routeTimestamp[row] + ROUTE_TIMEOUT - now;
+        RouteReply reply{target, nodes.routeSequence[row], view.source(),
+                         static_cast<uint32_t>(std::max<int64_t>(
+                             std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count(), 0)),
+                         static_cast<uint8_t>(nodes.routeHopCount[row])};
+        sendRouteReply(request.originator, reply, static_cast<uint8_t>(std::min(hops, MAX_HOP_COUNT)));
+        ++discoveryStats.repliesSent;
+        return true;
+    }
+    
+    // Rebroadcast within the ring the originator chose
+    if (view.ttl() <= 1) {
+        return true;
+    }
+    request.hopCount = static_cast<uint8_t>(hops);
+    MessageHeader header = routingHeader(MessageType::ROUTE_REQUEST, target);
+    header.ttl = view.ttl() - 1;
+    uint8_t rreq[ROUTE_REQUEST_SIZE];
+    size_t length = encodeRouteRequest(header, request, rreq, sizeof(rreq));
+    signAndSend(crypto::ByteView(rreq, length), beginPacket());
+    ++discoveryStats.requestsForwarded;
+    return true;
+}
+
+bool SecureRoutingProtocol::handleRouteReply(const MessageView& view) {
+    RouteReply reply;
+    if (!view.routeReply(reply) || reply.hopCount >= MAX_HOP_COUNT) {
+        return false;
+    }
+    // Only the target itself replies from zero hops away
+    if (reply.hopCount == 0 && reply.target != view.source()) {
+        return false;
+    }
+    // Replies travel hop by hop; the others on the channel only overhear them
+    if (reply.nextHop != selfId) {
+        return true;
+    }
+    recordForwarding(nodes.find(view.source()), ForwardingEvent::ADVERTISED);
+    
+    // Forward route; the reply's lifetime caps how long it is used
+    auto now = eventClock.now();
+    auto lifetime = std::min<std::chrono::system_clock::duration>(
+        std::chrono::milliseconds(reply.lifetimeMs), ROUTE_TIMEOUT);
+    uint32_t hops = reply.hopCount + 1u;
+    installRoute(reply.target, view.source(), hops, reply.targetSequence, now - (ROUTE_TIMEOUT - lifetime));
+    
+    NodeId originator = view.destination();
+    if (originator == selfId) {
+        routeDiscovery.complete(reply.target);
+        return true;
+    }
+    
+    uint32_t row = lookupRoute(originator);
+    if (row == NodeTable::NO_ROW || view.ttl() <= 1) {
+        return true;
+    }
+    reply.nextHop = nodes.routeNextHop[row];
+    reply.hopCount = static_cast<uint8_t>(hops);
+    sendRouteReply(originator, reply, view.ttl() - 1);
+    ++discoveryStats.repliesForwarded;
+    return true;
+}
+
+bool SecureRoutingProtocol::handleRouteError(const MessageView& view) {
+    RouteError error;
+    if (!view.routeError(error)) {
+        return false;
+    }
+    
+    // Only routes through the reporting hop are affected; invalidating
+    // ours repeats the error, and the cleared route stops further repeats
+    uint32_t row = lookupRoute(error.unreachable);
+    if (row == NodeTable::NO_ROW || nodes.routeNextHop[row] != view.source()) {
+        return true;
+    }
+    nodes.routeSequence[row] = std::max(nodes.routeSequence[row], error.sequence - 1);
+    invalidateRoute(NodeRegistry::instance().name(error.unreachable));
+    return true;
+}
+
+bool SecureRoutingProtocol::handleData(const MessageView& view, uint32_t sourceRow) {
+    DataHop hop;
+    if (!view.dataHop(hop)) {
+        return false;
+    }
+    
+    // Overheard relay by a neighbor towards a destination we route through
+    // it; relays of neighbors we hand nothing to cost no lookup
+    NodeId destination = view.destination();
+    if (hop.nextHop != selfId) {
+        if (hop.originator != view.source() && sourceRow != NodeTable::NO_ROW &&
+            ForwardingMonitor::awaitsRelays(nodes.forwarding[sourceRow])) {
+            uint32_t row = lookupRoute(destination);
+            if (row != NodeTable::NO_ROW && nodes.routeNextHop[row] == view.source()) {
+                recordForwarding(sourceRow, ForwardingEvent::OVERHEARD);
+            }
+        }
+        return true;
+    }
+    if (destination == selfId) {
+        return true;
+    }
+    
+    // Relay along our own route, as long as its next hop is trusted
+    uint32_t row = lookupRoute(destination);
+    if (row == NodeTable::NO_ROW || view.ttl() <= 1 ||
+        calculateTrust(nodes.routeNextHop[row]) < TRUST_THRESHOLD) {
+        return false;
+    }
+    sendDataPacket(destination, row, hop.originator, view.dataBody(), view.ttl() - 1);
+    return true;
+}
+
+void SecureRoutingProtocol::recordForwarding(uint32_t row, ForwardingEvent event) {
+    // Only nodes we already keep state for are judged
+    if (row != NodeTable::NO_ROW &&
+        forwardingMonitor.record(nodes.forwarding[row], event, eventClock.nowMillis())) {
+        nodes.trustDirty[row] = 1;
+    }
+}
+
+void SecureRoutingProtocol::sendRouteRequest(NodeId destination, uint8_t ttl) {
+    uint32_t row = nodes.find(destination);
+    RouteRequest request{selfId, ++nextBroadcastId, ++localRouteSequence,
+                         row == NodeTable::NO_ROW ? 0 : nodes.routeSequence[row], 0};
+    requestCache.insert(selfId, request.broadcastId, eventClock.nowMillis());
+    
+    MessageHeader header = routingHeader(MessageType::ROUTE_REQUEST, destination);
+    header.ttl = ttl;
+    uint8_t rreq[ROUTE_REQUEST_SIZE];
+    size_t length = encodeRouteRequest(header, request, rreq, sizeof(rreq));
+    signAndSend(crypto::ByteView(rreq, length), beginPacket());
+    ++discoveryStats.requestsSent;
+}
+
+void SecureRoutingProtocol::sendRouteReply(NodeId originator, const RouteReply& reply, uint8_t ttl) {
+    MessageHeader header = routingHeader(MessageType::ROUTE_REPLY, originator);
+    header.ttl = ttl;
+    uint8_t rrep[ROUTE_REPLY_SIZE];
+    size_t length = encodeRouteReply(header, reply, rrep, sizeof(rrep));
+    signAndSend(crypto::ByteView(rrep, length), beginPacket());
+}
+
+void SecureRoutingProtocol::retryRouteDiscoveries(uint64_t nowMs) {
+    retryScratch.clear();
+    routeDiscovery.expire(nowMs, retryScratch);
+    for (const auto& retry : retryScratch) {
+        if (retry.ttl == 0) {
+            ++discoveryStats.discoveriesFailed;
+        } else if (lookupRoute(retry.destination) != NodeTable::NO_ROW) {
+            // Learned from someone else's discovery in the meantime
+            routeDiscovery.complete(retry.destination);
+        } else {
+            sendRouteRequest(retry.destination, retry.ttl);
+        }
+    }
+}
+
+bool SecureRoutingProtocol::installRoute(NodeId destination, NodeId nextHop, uint32_t hopCount,
+                                         uint32_t sequence, std::chrono::system_clock::time_point timestamp) {
+    if (destination == selfId || hopCount > MAX_HOP_COUNT) {
+        return false;
+    }
+    
+    // Newer sequence numbers win; for the same one, the shorter route does
+    uint32_t row = nodes.find(destination);
+    if (row != NodeTable::NO_ROW && nodes.has(row, NodeTable::ROUTE)) {
+        int32_t age = static_cast<int32_t>(sequence - nodes.routeSequence[row]);
+        if (age < 0 || (age == 0 && hopCount >= nodes.routeHopCount[row])) {
+            return false;
+        }
+    }
+    
+    double trust = calculateTrust(nextHop);
+    row = nodes.insert(destination);
+    nodes.routeNextHop[row] = nextHop;
+    nodes.routeHopCount[row] = hopCount;
+    nodes.routeSequence[row] = sequence;
+    nodes.routeTimestamp[row] = timestamp;
+    nodes.routeTrust[row] = trust;
+    nodes.setField(row, NodeTable::ROUTE);
+    scheduleExpiry(destination, NodeTable::ROUTE, timestamp);
+    return true;
+}
+
+void SecureRoutingProtocol::setCryptoEngine(crypto::CryptoEngine* engine,
+                                            std::function<void(uint64_t ticket)> scheduler) {
+    cryptoEngine = engine;
+    scheduleDelivery = std::move(scheduler);
+}
+
+bool SecureRoutingProtocol::exportState(std::vector<uint8_t>& out) const {
+    std::vector<uint8_t> identity;
+    if (!cryptoModule->exportIdentity(identity)) {
+        return false;
+    }
+    
+    ByteWriter writer(out);
+    writer.u8(STATE_VERSION);
+    writer.string(vehicleId);
+    writer.f64(localInfo.position.x);
+    writer.f64(localInfo.position.y);
+    writer.f64(localInfo.position.z);
+    writer.time(localInfo.position.timestamp);
+    writer.f64(localInfo.speed);
+    writer.f64(localInfo.direction);
+    writer.f64(localInfo.trustScore);
+    writer.u32(nextSequence);
+    writer.u32(nextBroadcastId);
+    writer.u32(localRouteSequence);
+    writer.bytes(identity);
+    
+    writer.u32(static_cast<uint32_t>(nodes.size()));
+    for (uint32_t row = 0; row < nodes.size(); ++row) {
+        writer.u32(nodes.ids[row]);
+        writer.u8(nodes.fields[row]);
+        if (nodes.has(row, NodeTable::ROUTE)) {
+            writer.u32(nodes.routeNextHop[row]);
+            writer.u32(nodes.routeHopCount[row]);
+            writer.u32(nodes.routeSequence[row]);
+            writer.time(nodes.routeTimestamp[row]);
+            writer.f64(nodes.routeTrust[row]);
+        }
+        if (nodes.has(row, NodeTable::NEIGHBOR)) {
+            const VehicleInfo& info = nodes.neighborInfo[row];
+            writer.f64(info.position.x);
+            writer.f64(info.position.y);
+            writer.f64(info.position.z);
+            writer.time(info.position.timestamp);
+            writer.f64(info.speed);
+            writer.f64(info.direction);
+            writer.f64(info.trustScore);
+            writer.bytes(info.certificate);
+        }
+        if (nodes.has(row, NodeTable::TRUST)) {
+            writer.f64(nodes.trustScore[row]);
+        }
+        if (nodes.has(row, NodeTable::TRACKER)) {
+            writer.u64(nodes.senderCredential[row]);
+            writer.u32(nodes.lastSequence[row]);
+            writer.u64(nodes.sequenceWindow[row]);
+            writer.time(nodes.lastUpdate[row]);
+        }
+    }
+    return true;
+}
+
+bool SecureRoutingProtocol::importState(crypto::ByteView state) {
+    ByteReader reader(state);
+    if (reader.u8() != STATE_VERSION || reader.string() != vehicleId) {
+        return false;
+    }
+    
+    VehicleInfo info = localInfo;
+    info.position.x = reader.f64();
+    info.position.y = reader.f64();
+    info.position.z = reader.f64();
+    info.position.timestamp = reader.time();
+    info.speed = reader.f64();
+    info.direction = reader.f64();
+    info.trustScore = reader.f64();
+    uint32_t sequence = reader.u32();
+    uint32_t broadcastId = reader.u32();
+    uint32_t routeSequence = reader.u32();
+    crypto::ByteView identity = reader.bytes();
+    
+    // Decode into a fresh table so a truncated snapshot changes nothing
+    NodeTable table;
+    uint32_t rows = reader.u32();
+    auto& registry = NodeRegistry::instance();
+    for (uint32_t i = 0; i < rows && reader.ok(); ++i) {
+        NodeId id = reader.u32();
+        uint8_t fields = reader.u8();
+        if (id >= registry.size()) {
+            return false;
+        }
+        uint32_t row = table.insert(id);
+        if (fields & NodeTable::ROUTE) {
+            table.routeNextHop[row] = reader.u32();
+            table.routeHopCount[row] = reader.u32();
+            table.routeSequence[row] = reader.u32();
+            table.routeTimestamp[row] = reader.time();
+            table.routeTrust[row] = reader.f64();
+        }
+        if (fields & NodeTable::NEIGHBOR) {
+            VehicleInfo& neighbor = table.neighborInfo[row];
+            neighbor.id = registry.name(id);
+            neighbor.position.x = reader.f64();
+            neighbor.position.y = reader.f64();
+            neighbor.position.z = reader.f64();
+            neighbor.position.timestamp = reader.time();
+            neighbor.speed = reader.f64();
+            neighbor.direction = reader.f64();
+            neighbor.trustScore = reader.f64();
+            neighbor.certificate = reader.bytes().toVector();
+        }
+        if (fields & NodeTable::TRUST) {
+            table.trustScore[row] = reader.f64();
+        }
+        if (fields & NodeTable::TRACKER) {
+            table.senderCredential[row] = reader.u64();
+            table.lastSequence[row] = reader.u32();
+            table.sequenceWindow[row] = reader.u64();
+            table.lastUpdate[row] = reader.time();
+        }
+        table.fields[row] = fields;
+    }
+    if (!reader.ok() || !reader.atEnd() || !cryptoModule->importIdentity(identity)) {
+        return false;
+    }
+    
+    localInfo = info;
+    nextSequence = sequence;
+    nextBroadcastId = broadcastId;
+    localRouteSequence = routeSequence;
+    nodes = std::move(table);
+    
+    // Derived indexes are rebuilt rather than shipped
+    neighborGrid.clear();
+    expiryWheel = TimerWheel(EXPIRY_TICK_MS);
+    for (uint32_t row = 0; row < nodes.size(); ++row) {
+        if (nodes.has(row, NodeTable::ROUTE)) {
+            scheduleExpiry(nodes.ids[row], NodeTable::ROUTE, nodes.routeTimestamp[row]);
+        }
+        if (nodes.has(row, NodeTable::NEIGHBOR)) {
+            neighborGrid.update(nodes.ids[row], nodes.neighborInfo[row].position);
+            nodes.beaconPosition.set(row, nodes.neighborInfo[row].position);
+            scheduleExpiry(nodes.ids[row], NodeTable::NEIGHBOR, nodes.neighborInfo[row].position.timestamp);
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> SecureRoutingProtocol::neighborsWithin(const Position& center, double radius) const {
+    queryScratch.clear();
+    neighborGrid.queryRadius(center, radius, queryScratch);
+    
+    std::vector<std::string> result;
+    result.reserve(queryScratch.size());
+    for (NodeId id : queryScratch) {
+        result.push_back(NodeRegistry::instance().name(id));
+    }
+    return result;
+}
+
+std::vector<std::string> SecureRoutingProtocol::nearestNeighbors(const Position& center, size_t k) const {
+    queryScratch.clear();
+    neighborGrid.nearest(center, k, queryScratch);
+    
+    std::vector<std::string> result;
+    result.reserve(queryScratch.size());
+    for (NodeId id : queryScratch) {
+        result.push_back(NodeRegistry::instance().name(id));
+    }
+    return result;
+}
+
 bool SecureRoutingProtocol::detectBlackHole(const std::string& suspectId) {
-    // Check for abnormally high route advertisements
-    // and low packet forwarding rates
-    return false;
+    // Check for route advertisements and handoffs that are not matched by
+    // overheard relaying
+    NodeId node = NodeRegistry::instance().find(suspectId);
+    uint32_t row = node == INVALID_NODE ? NodeTable::NO_ROW : nodes.find(node);
+    if (row == NodeTable::NO_ROW) {
+        return false;
+    }
+    return forwardingMonitor.suspicious(nodes.forwarding[row], eventClock.nowMillis());
 }
 
 bool SecureRoutingProtocol::detectSybil(const std::string& suspectId) {
     // Check for multiple identities from similar positions
-    // or with similar certificates
-    return false;
+    NodeId node = NodeRegistry::instance().find(suspectId);
+    uint32_t row = node == INVALID_NODE ? NodeTable::NO_ROW : nodes.find(node);
+    if (row == NodeTable::NO_ROW || !nodes.has(row, NodeTable::NEIGHBOR)) {
+        return false;
+    }
+    
+    // One grid query per suspect keeps a sweep over all neighbors near-linear
+    const auto& position = nodes.neighborInfo[row].position;
+    return identitiesNear(node, position, SYBIL_RADIUS) + 1 >= SYBIL_MIN_IDENTITIES;
 }
 
 bool SecureRoutingProtocol::detectReplay(const std::vector<uint8_t>& message) {
@@ -220,54 +957,249 @@ bool SecureRoutingProtocol::detectReplay(const std::vector<uint8_t>& message) {
 }
 
 bool SecureRoutingProtocol::detectPositionFalsification(const std::string& vehicleId, const Position& reportedPos) {
-    auto it = neighborTable.find(vehicleId);
-    if (it == neighborTable.end()) {
+    NodeId node = NodeRegistry::instance().find(vehicleId);
+    uint32_t row = node == INVALID_NODE ? NodeTable::NO_ROW : nodes.find(node);
+    if (row == NodeTable::NO_ROW || !nodes.has(row, NodeTable::NEIGHBOR)) {
         return false;
     }
     
-    const auto& lastPos = it->second.position;
-    double timeElapsed = std::chrono::duration_cast<std::chrono::seconds>(
-        reportedPos.timestamp - lastPos.timestamp).count();
+    return isFalsifiedMove(node, nodes.neighborInfo[row].position, reportedPos);
+}
+
+bool SecureRoutingProtocol::isFalsifiedMove(NodeId node, const Position& from, const Position& to) {
+    double timeElapsed = std::chrono::duration_cast<std::chrono::seconds>(to.timestamp - from.timestamp).count();
+    if (!isValidMovement(from, to, timeElapsed)) {
+        return true;
+    }
     
-    return !isValidMovement(lastPos, reportedPos, timeElapsed);
+    // A plausible move onto a spot another vehicle occupies is still false
+    return identitiesNear(node, to, SYBIL_RADIUS) > 0;
 }
 
-std::vector<uint8_t> SecureRoutingProtocol::createRoutingMessage(MessageType type, const std::string& destination) {
-    std::vector<uint8_t> message;
-    message.push_back(static_cast<uint8_t>(type));
+std::vector<std::string> SecureRoutingProtocol::detectImplausibleMovers() {
+    // One kernel pass over every row; rows without two beacons are skipped after
+    movementScratch.resize(nodes.size());
+    validateMovementsBatch(nodes.previousBeaconPosition, nodes.beaconPosition,
+                           {MAX_SPEED, MAX_ACCELERATION}, movementScratch.data());
     
-    // Add source ID
-    message.insert(message.end(), vehicleId.begin(), vehicleId.end());
-    message.push_back(0); // null terminator
+    std::vector<std::string> movers;
+    auto& registry = NodeRegistry::instance();
+    for (uint32_t row = 0; row < nodes.size(); ++row) {
+        if (movementScratch[row] && !nodes.previousBeaconPosition.empty(row)) {
+            movers.push_back(registry.name(nodes.ids[row]));
+        }
+    }
+    return movers;
+}
+
+size_t SecureRoutingProtocol::identitiesNear(NodeId self, const Position& position, double radius) const {
+    queryScratch.clear();
+    neighborGrid.queryRadius(position, radius, queryScratch);
+    return queryScratch.size() - std::count(queryScratch.begin(), queryScratch.end(), self);
+}
+
+std::pmr::memory_resource* SecureRoutingProtocol::beginPacket() {
+    // The previous packet has been handed to the network layer by now
+    packetArena.reset();
+    return &packetArena;
+}
+
+size_t SecureRoutingProtocol::signAndSend(crypto::ByteView message, std::pmr::memory_resource* resource) {
+    tracePacket(TraceEvent::SEND, message);
+    size_t wireSize;
+    if (cryptoEngine) {
+        // Signed on a worker, sent when the engine delivers the ticket; the
+        // size is needed now, so it is the largest the signature can make it
+        wireSize = cryptoModule->signedWireSize(message.size()) + SECURE_FRAME_FRAMING;
+        uint64_t ticket = cryptoModule->createSecureMessageAsync(message, *cryptoEngine,
+            [this](bool ok, const crypto::CryptoModule::SecureMessageView& secure) {
+                if (ok && transmitter) {
+                    deliveredFrame.resize(secureFrameSize(secure));
+                    encodeSecureFrame(secure, deliveredFrame.data(), deliveredFrame.size());
+                    transmitter(crypto::ByteView(deliveredFrame));
+                }
+            });
+        if (scheduleDelivery) {
+            scheduleDelivery(ticket);
+        }
+    } else {
+        auto type = static_cast<MessageType>(message[1]);
+        bool hopByHop = type == MessageType::HELLO || type == MessageType::DATA;
+        auto secure = hopByHop ? cryptoModule->createSessionMessage(message, resource)
+                               : cryptoModule->createSecureMessage(message, resource);
+        crypto::CryptoModule::SecureMessageView view(secure);
+        wireSize = secureFrameSize(view);
+        if (transmitter) {
+            std::pmr::vector<uint8_t> frame(wireSize, resource);
+            encodeSecureFrame(view, frame.data(), frame.size());
+            transmitter(crypto::ByteView(frame));
+        }
+    }
+    endPacket();
+    return wireSize;
+}
+
+void SecureRoutingProtocol::endPacket() {
+    allocationStats.packets++;
+    allocationStats.lastPacketAllocations = packetArena.allocationsSinceReset();
+    allocationStats.lastPacketHeapAllocations = packetArena.upstreamSinceReset();
+    allocationStats.allocations += allocationStats.lastPacketAllocations;
+    allocationStats.heapAllocations += allocationStats.lastPacketHeapAllocations;
+}
+
+void SecureRoutingProtocol::tracePacket(TraceEvent event, crypto::ByteView message, TraceReason reason) {
+    if (!traceSink) {
+        return;
+    }
     
-    // Add destination ID
-    message.insert(message.end(), destination.begin(), destination.end());
-    message.push_back(0); // null terminator
+    TraceRecord record{};
+    record.timeNs = toNanos(eventClock.now());
+    record.node = selfId;
+    record.x = static_cast<float>(localInfo.position.x);
+    record.y = static_cast<float>(localInfo.position.y);
+    record.size = static_cast<uint16_t>(std::min<size_t>(message.size(), UINT16_MAX));
+    record.event = event;
+    record.reason = reason;
     
-    // Add timestamp
-    auto now = std::chrono::system_clock::now();
-    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()).count();
-    message.insert(message.end(),
-        reinterpret_cast<uint8_t*>(&timestamp),
-        reinterpret_cast<uint8_t*>(&timestamp) + sizeof(timestamp));
+    // Malformed packets keep whatever header fields they have
+    record.type = message.size() > 1 ? message[1] : 0;
+    if (message.size() >= DELTA_BEACON_SIZE && isDeltaBeacon(message)) {
+        record.peer = event == TraceEvent::SEND ? BROADCAST_NODE : loadLE32(message.data() + 4);
+        record.sequence = loadLE32(message.data() + 8);
+    } else if (message.size() >= HEADER_SIZE) {
+        record.peer = loadLE32(message.data() + (event == TraceEvent::SEND ? 8 : 4));
+        record.sequence = loadLE32(message.data() + 12);
+    } else {
+        record.peer = INVALID_NODE;
+    }
+    traceSink->record(record);
+}
+
+void SecureRoutingProtocol::traceAlert(NodeId suspect, TraceReason reason) {
+    if (!traceSink) {
+        return;
+    }
     
-    return message;
+    TraceRecord record{};
+    record.timeNs = toNanos(eventClock.now());
+    record.node = selfId;
+    record.peer = suspect;
+    record.x = static_cast<float>(localInfo.position.x);
+    record.y = static_cast<float>(localInfo.position.y);
+    record.event = TraceEvent::ALERT;
+    record.reason = reason;
+    traceSink->record(record);
 }
 
-bool SecureRoutingProtocol::verifyRoutingMessage(const std::vector<uint8_t>& message) {
-    if (message.empty()) {
+MessageHeader SecureRoutingProtocol::routingHeader(MessageType type, NodeId destination) {
+    MessageHeader header;
+    header.type = type;
+    header.ttl = type == MessageType::HELLO ? 1 : MAX_HOP_COUNT;
+    header.source = selfId;
+    header.destination = destination;
+    header.sequence = ++nextSequence;
+    header.timestamp = eventClock.nowMillis();
+    header.x = static_cast<float>(localInfo.position.x);
+    header.y = static_cast<float>(localInfo.position.y);
+    header.z = static_cast<float>(localInfo.position.z);
+    return header;
+}
+
+size_t SecureRoutingProtocol::createRoutingMessage(MessageType type, NodeId destination,
+                                                   uint8_t* out, size_t capacity) {
+    MessageHeader header = routingHeader(type, destination);
+    if (type == MessageType::HELLO) {
+        return encodeBeacon(header, static_cast<float>(localInfo.speed),
+                            static_cast<float>(localInfo.direction), out, capacity);
+    }
+    return encodeHeader(header, out, capacity);
+}
+
+bool SecureRoutingProtocol::needsFullVerification(const MessageView& view) {
+    if (verificationPolicy.modeFor(view.type()) == VerificationMode::FULL) {
+        return true;
+    }
+    
+    // Messages consumed here are always verified; relayed ones only when
+    // the sender is not trusted enough to skip it
+    if (view.destination() == BROADCAST_NODE || view.destination() == selfId) {
+        return true;
+    }
+    return calculateTrust(view.source()) < verificationPolicy.trustThreshold;
+}
+
+bool SecureRoutingProtocol::passesCheapChecks(const MessageView& view) const {
+    uint64_t nowMs = eventClock.nowMillis();
+    uint64_t timestamp = view.timestamp();
+    if (timestamp > nowMs || nowMs - timestamp > MAX_MESSAGE_AGE_MS) {
         return false;
     }
     
-    // Verify message structure
-    MessageType type = static_cast<MessageType>(message[0]);
-    if (type > MessageType::DATA) {
+    return view.ttl() > 0 && isFreshSequence(view.source(), view.sequence());
+}
+
+bool SecureRoutingProtocol::isFreshSequence(NodeId source, uint32_t sequence) const {
+    uint32_t row = nodes.find(source);
+    if (row == NodeTable::NO_ROW || !nodes.has(row, NodeTable::TRACKER) ||
+        sequence > nodes.lastSequence[row]) {
+        return true;
+    }
+    
+    uint32_t offset = nodes.lastSequence[row] - sequence;
+    return offset < SEQUENCE_WINDOW && !((nodes.sequenceWindow[row] >> offset) & 1);
+}
+
+bool SecureRoutingProtocol::isNearVerifiedSequence(NodeId source, uint32_t sequence) const {
+    uint32_t row = nodes.find(source);
+    if (row == NodeTable::NO_ROW || !nodes.has(row, NodeTable::TRACKER)) {
+        return true;
+    }
+    return sequence <= nodes.lastSequence[row] || sequence - nodes.lastSequence[row] <= SEQUENCE_WINDOW;
+}
+
+uint32_t SecureRoutingProtocol::recordSequence(NodeId source, uint32_t sequence) {
+    uint32_t row = nodes.insert(source);
+    auto& last = nodes.lastSequence[row];
+    auto& window = nodes.sequenceWindow[row];
+    
+    if (!nodes.has(row, NodeTable::TRACKER)) {
+        last = sequence;
+        window = 1;
+        nodes.setField(row, NodeTable::TRACKER);
+    } else if (sequence > last) {
+        uint32_t shift = sequence - last;
+        window = shift >= SEQUENCE_WINDOW ? 0 : window << shift;
+        window |= 1;
+        last = sequence;
+    } else {
+        window |= uint64_t(1) << (last - sequence);
+    }
+    nodes.lastUpdate[row] = eventClock.now();
+    return row;
+}
+
+bool SecureRoutingProtocol::verifyRoutingMessage(const crypto::CryptoModule::SecureMessageView& secure,
+                                                 NodeId source) {
+    // Signature and credential, or a session tag, over the whole routing
+    // message. It is recorded so the crypto sequence cannot be replayed.
+    if (!cryptoModule->verifySecureMessage(secure)) {
         return false;
     }
     
-    // Verify signature and certificate
-    return cryptoModule->verifySecureMessage(crypto::CryptoModule::SecureMessage{/*...*/});
+    // A source is bound to the credential of its first verified frame, so
+    // that no other key can speak for it
+    uint64_t credential = cryptoModule->senderIdentity(secure);
+    uint32_t row = nodes.find(source);
+    if (row != NodeTable::NO_ROW && nodes.senderCredential[row] != 0 &&
+        nodes.senderCredential[row] != credential) {
+        return false;
+    }
+    cryptoModule->updateMessageHistory(secure);
+    if (row == NodeTable::NO_ROW) {
+        row = nodes.insert(source);
+    }
+    nodes.senderCredential[row] = credential;
+    return true;
 }
 
 double SecureRoutingProtocol::calculateDistance(const Position& pos1, const Position& pos2) {
@@ -298,27 +1230,42 @@ bool SecureRoutingProtocol::isValidMovement(const Position& oldPos, const Positi
     return acceleration <= MAX_ACCELERATION;
 }
 
-void SecureRoutingProtocol::pruneExpiredEntries() {
-    auto now = std::chrono::system_clock::now();
-    
-    // Prune routing table
-    for (auto it = routingTable.begin(); it != routingTable.end();) {
-        if (it->second.timestamp + ROUTE_TIMEOUT < now) {
-            it = routingTable.erase(it);
-        } else {
-            ++it;
-        }
+void SecureRoutingProtocol::scheduleExpiry(NodeId node, NodeTable::Field field,
+                                           std::chrono::system_clock::time_point timestamp) {
+    auto timeout = field == NodeTable::ROUTE ? ROUTE_TIMEOUT : NEIGHBOR_TIMEOUT;
+    expiryWheel.start(toMillis(timestamp));
+    // Entries expire once strictly older than the timeout
+    expiryWheel.schedule(expiryKey(node, field), toMillis(timestamp + timeout) + 1);
+}
+
+void SecureRoutingProtocol::expireEntry(uint64_t key, std::chrono::system_clock::time_point now) {
+    NodeId node = static_cast<NodeId>(key >> 32);
+    auto field = static_cast<NodeTable::Field>(key & 0xffffffff);
+    uint32_t row = nodes.find(node);
+    if (row == NodeTable::NO_ROW || !nodes.has(row, field)) {
+        return;
     }
-    
-    // Prune neighbor table
-    for (auto it = neighborTable.begin(); it != neighborTable.end();) {
-        if (it->second.position.timestamp + NEIGHBOR_TIMEOUT < now) {
-            it = neighborTable.erase(it);
-        } else {
-            ++it;
+
+    auto timestamp = field == NodeTable::ROUTE ? nodes.routeTimestamp[row]
+                                               : nodes.neighborInfo[row].position.timestamp;
+    auto timeout = field == NodeTable::ROUTE ? ROUTE_TIMEOUT : NEIGHBOR_TIMEOUT;
+    if (timestamp + timeout < now) {
+        if (field == NodeTable::NEIGHBOR) {
+            neighborGrid.remove(node);
+            invalidateTrustNear(nodes.neighborInfo[row].position);
         }
+        nodes.clearField(row, field);
+    } else {
+        // Refreshed without being rescheduled; wait for the real deadline
+        scheduleExpiry(node, field, timestamp);
     }
 }
 
+void SecureRoutingProtocol::pruneExpiredEntries(std::chrono::system_clock::time_point now) {
+    crypto::ScopedStageTimer timer(&instrumentation, crypto::Stage::PRUNE);
+    // Only entries whose timers are due are touched, never the whole table
+    expiryWheel.advance(toMillis(now), [&](uint64_t key) { expireEntry(key, now); });
+}
+
 } // namespace routing
 } // namespace vanet 
\ No newline at end of file
@@ -1,44 +1,85 @@
 #ifndef VANET_SECURE_ROUTING_H
 #define VANET_SECURE_ROUTING_H
 
+#include <array>
 #include <vector>
-#include <map>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include "../crypto/clock.h"
 #include "../crypto/crypto-module.h"
+#include "../crypto/message-arena.h"
+#include "routing-types.h"
+#include "beacon-control.h"
+#include "forwarding-monitor.h"
+#include "node-table.h"
+#include "route-discovery.h"
+#include "secure-frame.h"
+#include "timer-wheel.h"
+#include "spatial-grid.h"
+#include "trace-sink.h"
+#include "wire-format.h"
 
 namespace vanet {
 namespace routing {
 
-struct Position {
-    double x;
-    double y;
-    double z;
-    std::chrono::system_clock::time_point timestamp;
+// How much checking a received message gets before it is acted on
+enum class VerificationMode {
+    FULL,       // signature and certificate on every hop
+    ON_DEMAND   // forwarding hops run cheap checks only; full check at the destination
 };
 
-struct VehicleInfo {
-    std::string id;
-    Position position;
-    double speed;
-    double direction;
-    double trustScore;
-    std::vector<uint8_t> certificate;
+// Per-MessageType verification policy. Under ON_DEMAND a forwarding hop only
+// checks timestamp freshness, the sender's sequence window and its trust;
+// senders whose trust is below trustThreshold are always verified in full.
+struct VerificationPolicy {
+    std::array<VerificationMode, MESSAGE_TYPE_COUNT> modes;
+    double trustThreshold;
+
+    VerificationPolicy();
+
+    VerificationMode modeFor(MessageType type) const { return modes[static_cast<size_t>(type)]; }
+    void setMode(MessageType type, VerificationMode mode) { modes[static_cast<size_t>(type)] = mode; }
+};
+
+struct VerificationStats {
+    uint64_t fullVerifications;
+    uint64_t cheapChecks;
+    uint64_t rejected;
 };
 
-struct RouteEntry {
-    std::string nextHop;
-    uint32_t hopCount;
-    std::chrono::system_clock::time_point timestamp;
-    double trustScore;
+// Route discovery traffic of one node. Every node forwards a flood at most
+// once, so requestsForwarded per discovery is bounded by the number of nodes
+// within the ring, not by the size of the network.
+struct RouteDiscoveryStats {
+    uint64_t requestsSent;        // originated here, expanding-ring retries included
+    uint64_t requestsForwarded;
+    uint64_t duplicatesDropped;   // flood copies already seen
+    uint64_t requestsThrottled;   // discoveries not started: one in flight or rate limited
+    uint64_t repliesSent;         // as the destination or from a fresh enough route
+    uint64_t repliesForwarded;
+    uint64_t discoveriesFailed;
 };
 
-enum class MessageType {
-    HELLO,
-    ROUTE_REQUEST,
-    ROUTE_REPLY,
-    ROUTE_ERROR,
-    DATA
+// Allocation cost of the send paths. Packets are built in the protocol's
+// MessageArena; heapAllocations only grows while the arena warms up.
+struct AllocationStats {
+    uint64_t packets;
+    uint64_t allocations;           // served by the arena
+    uint64_t heapAllocations;       // arena blocks taken from the heap
+    uint64_t lastPacketAllocations;
+    uint64_t lastPacketHeapAllocations;
+};
+
+// Beacon traffic of one node. Under crypto offload bytesSent assumes the
+// largest signature of the key, as sizes are only known once the engine delivers.
+struct BeaconStats {
+    uint64_t fullBeacons;
+    uint64_t deltaBeacons;
+    uint64_t suppressed;       // checks that found nothing due
+    uint64_t bytesSent;        // as put on the air, security fields included
+    uint64_t deltasApplied;    // received and applied to a neighbor's full beacon
+    uint64_t deltasDropped;    // unknown base, stale, replayed, implausible or unauthenticated
 };
 
 class SecureRoutingProtocol {
@@ -48,11 +89,19 @@ public:
 
     // Core routing functions
     bool initializeVehicle(const VehicleInfo& info);
+    // Takes a provisioned identity (see crypto::FleetKeys) instead of
+    // generating a key
+    bool initializeVehicle(const VehicleInfo& info, crypto::ByteView identity);
     bool updatePosition(const Position& newPos);
     bool sendData(const std::string& destination, const std::vector<uint8_t>& data);
-    bool receiveMessage(const std::vector<uint8_t>& message);
+    // Takes a frame as transmitted (see setTransmitter()). Parses in place;
+    // the bytes only need to outlive the call, e.g. a receive buffer reused
+    // for every packet
+    bool receiveMessage(crypto::ByteView message);
+    bool receiveMessage(const std::vector<uint8_t>& message) { return receiveMessage(crypto::ByteView(message)); }
 
-    // Route management
+    // Route management. findRoute() starts an expanding-ring discovery
+    // unless a route exists; false if one is in flight or rate limited.
     bool findRoute(const std::string& destination);
     bool updateRoute(const std::string& destination, const RouteEntry& entry);
     bool invalidateRoute(const std::string& destination);
@@ -62,39 +111,200 @@ public:
     void updateTrustScore(const std::string& vehicleId, double score);
     bool isVehicleTrusted(const std::string& vehicleId);
 
-    // Beacon management
+    // Beacon management. sendBeacon() sends a full signed beacon now.
+    // sendBeaconIfDue() leaves it to the BeaconController, which picks
+    // nothing, a delta or a full beacon from local channel load and the
+    // vehicle's own motion; call it every beaconCheckIntervalMs(). Deltas
+    // carry session tags in session mode and go out bare otherwise, and
+    // receivers only apply them on top of the full beacon they reference,
+    // within the plausible speed. Receivers in session mode drop bare ones.
     void sendBeacon();
+    bool sendBeaconIfDue();
+    uint64_t beaconCheckIntervalMs() const { return beaconControl.checkIntervalMs(); }
     bool processBeacon(const std::vector<uint8_t>& beacon);
 
+    // Proximity queries over the current one-hop neighbors
+    std::vector<std::string> neighborsWithin(const Position& center, double radius) const;
+    std::vector<std::string> nearestNeighbors(const Position& center, size_t k) const;
+
+    // Verification policy
+    void setVerificationPolicy(const VerificationPolicy& policy) { verificationPolicy = policy; }
+    const VerificationPolicy& getVerificationPolicy() const { return verificationPolicy; }
+    const VerificationStats& getVerificationStats() const { return verificationStats; }
+    const RouteDiscoveryStats& getRouteDiscoveryStats() const { return discoveryStats; }
+    const AllocationStats& getAllocationStats() const { return allocationStats; }
+    const BeaconStats& getBeaconStats() const { return beaconStats; }
+    const BeaconController& getBeaconController() const { return beaconControl; }
+    const ForwardingMonitor& getForwardingMonitor() const { return forwardingMonitor; }
+    // Per-stage latencies of this node, crypto included; empty unless built
+    // with VANET_INSTRUMENTATION
+    const crypto::Instrumentation& getInstrumentation() const { return instrumentation; }
+
+    // Moves signing onto the engine's workers. The scheduler is called with
+    // each ticket and is expected to run engine->deliverThrough(ticket) later
+    // on this thread, e.g. from an ns-3 event a fixed delay ahead, which keeps
+    // results independent of worker timing. Pass nullptr to sign inline again.
+    void setCryptoEngine(crypto::CryptoEngine* engine,
+                         std::function<void(uint64_t ticket)> scheduler = nullptr);
+
+    // Precomputes up to poolDepth ECDSA nonces so that signing a beacon
+    // only costs the message-dependent half of a signature. The owner tops
+    // the pool up with refillSigningPool() between beacons. Only applies to
+    // inline signing; false if the signing key is not ECDSA.
+    bool enablePresigning(size_t poolDepth) { return cryptoModule->enablePresigning(poolDepth); }
+    size_t refillSigningPool(size_t maxEntries = SIZE_MAX) { return cryptoModule->refillSigningPool(maxEntries); }
+    crypto::SigningPool::Stats getSigningPoolStats() const { return cryptoModule->getSigningPoolStats(); }
+
+    // Neighbor session mode: HELLO and DATA hops are authenticated with
+    // per-neighbor HMAC tags once a signed exchange has set up a session,
+    // and only signed for periodic re-authentication. Route control
+    // messages, which are relayed and acted on beyond the first hop, are
+    // always signed. Only applies to inline signing.
+    bool setSessionMode(bool enabled) { return cryptoModule->enableSessions(enabled); }
+    const crypto::CryptoModule::SessionStats& getSessionStats() const { return cryptoModule->getSessionStats(); }
+    const crypto::CryptoModule::OperationStats& getCryptoOperationStats() const {
+        return cryptoModule->getOperationStats();
+    }
+
+    // Sends frames ready for the air: secure frames (see secure-frame.h),
+    // and delta beacons, which outside session mode go out bare. The bytes
+    // are only valid during the call; hand them to the receivers from a
+    // later event, not from within it. Without a transmitter frames are
+    // built and counted but go nowhere.
+    void setTransmitter(std::function<void(crypto::ByteView frame)> transmit) { transmitter = std::move(transmit); }
+
+    // Records sent, received and rejected packets and detection alerts into
+    // the sink, which may be shared by every protocol instance of a
+    // simulation. Pass nullptr to stop tracing.
+    void setTraceSink(TraceSink* sink) { traceSink = sink; }
+
+    // Time source for timestamps, timeouts and crypto checks, e.g. the
+    // simulator's clock; not owned and the wall clock by default. It is read
+    // once per call of the methods above and that instant is used throughout.
+    void setClock(const crypto::Clock& source);
+
+    // Snapshot of everything the protocol knows: local vehicle, signing
+    // identity and the node table. importState() replaces the current state
+    // and only accepts snapshots of the same vehicle. NodeIds are stored as
+    // is, so both sides must have interned the same IDs in the same order.
+    bool exportState(std::vector<uint8_t>& out) const;
+    bool importState(crypto::ByteView state);
+
     // Attack detection
     bool detectBlackHole(const std::string& suspectId);
     bool detectSybil(const std::string& suspectId);
     bool detectReplay(const std::vector<uint8_t>& message);
     bool detectPositionFalsification(const std::string& vehicleId, const Position& reportedPos);
+    // Neighbors whose last two beacons describe an implausible move, checked
+    // for the whole neighbor table in one batch
+    std::vector<std::string> detectImplausibleMovers();
 
 private:
     std::string vehicleId;
     VehicleInfo localInfo;
     std::unique_ptr<crypto::CryptoModule> cryptoModule;
     
-    // Routing tables and caches
-    std::map<std::string, RouteEntry> routingTable;
-    std::map<std::string, VehicleInfo> neighborTable;
-    std::map<std::string, double> trustScores;
-    
-    // Message sequence tracking
-    struct MessageTracker {
-        uint32_t lastSequence;
-        std::chrono::system_clock::time_point lastUpdate;
-    };
-    std::map<std::string, MessageTracker> messageTracking;
+    // Routing, neighbor, trust and sequence state for every known node
+    NodeId selfId;
+    NodeTable nodes;
+    uint32_t nextSequence;
+
+    // Route and neighbor expiry; keys are (NodeId << 32) | NodeTable::Field
+    TimerWheel expiryWheel;
+
+    // Last beaconed position of every neighbor
+    SpatialGrid neighborGrid;
+    mutable std::vector<NodeId> queryScratch;
+    std::vector<uint8_t> movementScratch;
+
+    VerificationPolicy verificationPolicy;
+    VerificationStats verificationStats;
+
+    // AODV-style route discovery: floods seen, requests in flight, and this
+    // node's own destination sequence number
+    DuplicateCache requestCache;
+    RouteDiscovery routeDiscovery;
+    uint32_t nextBroadcastId;
+    uint32_t localRouteSequence;
+    RouteDiscoveryStats discoveryStats;
+    std::vector<RouteDiscovery::Retry> retryScratch;
+
+    // Beacon rate control, and the last full beacon sent, which deltas are relative to
+    BeaconController beaconControl;
+    BeaconStats beaconStats;
+    uint32_t beaconBaseSequence;
+    Position beaconBase;
+
+    // Route advertisements and relaying of every neighbor, for black-hole detection
+    ForwardingMonitor forwardingMonitor;
+
+    // Backing store for outgoing packets, reset at the start of each one
+    crypto::MessageArena packetArena;
+    AllocationStats allocationStats;
+
+    crypto::Instrumentation instrumentation;
+
+    // Optional signing offload, shared between protocol instances
+    crypto::CryptoEngine* cryptoEngine;
+    std::function<void(uint64_t ticket)> scheduleDelivery;
+    // Offloaded messages are framed here once the engine delivers them
+    std::vector<uint8_t> deliveredFrame;
+
+    std::function<void(crypto::ByteView frame)> transmitter;
+
+    TraceSink* traceSink;
+
+    // Caches the clock at the start of each event; the crypto module reads it too
+    crypto::EventClock eventClock;
 
     // Helper functions
-    std::vector<uint8_t> createRoutingMessage(MessageType type, const std::string& destination);
-    bool verifyRoutingMessage(const std::vector<uint8_t>& message);
+    MessageHeader routingHeader(MessageType type, NodeId destination);
+    size_t createRoutingMessage(MessageType type, NodeId destination, uint8_t* out, size_t capacity);
+    // Also false if the frame verifies under another credential than the
+    // ones from source did before
+    bool verifyRoutingMessage(const crypto::CryptoModule::SecureMessageView& secure, NodeId source);
+    bool needsFullVerification(const MessageView& view);
+    bool passesCheapChecks(const MessageView& view) const;
+    bool handleBeacon(const MessageView& view);
+    // secure is nullptr for deltas that came bare
+    bool handleDeltaBeacon(crypto::ByteView message, const crypto::CryptoModule::SecureMessageView* secure);
+    void sendFullBeacon(uint64_t nowMs);
+    bool sendDeltaBeacon(uint64_t nowMs);
+    bool handleRouteRequest(const MessageView& view);
+    bool handleRouteReply(const MessageView& view);
+    bool handleRouteError(const MessageView& view);
+    bool handleData(const MessageView& view, uint32_t sourceRow);
+    void sendDataPacket(NodeId destination, uint32_t routeRow, NodeId originator,
+                        crypto::ByteView body, uint8_t ttl);
+    void recordForwarding(uint32_t row, ForwardingEvent event);
+    void sendRouteRequest(NodeId destination, uint8_t ttl);
+    void sendRouteReply(NodeId originator, const RouteReply& reply, uint8_t ttl);
+    void retryRouteDiscoveries(uint64_t nowMs);
+    bool installRoute(NodeId destination, NodeId nextHop, uint32_t hopCount, uint32_t sequence,
+                      std::chrono::system_clock::time_point timestamp);
+    std::pmr::memory_resource* beginPacket();
+    size_t signAndSend(crypto::ByteView message, std::pmr::memory_resource* resource);
+    void endPacket();
+    void tracePacket(TraceEvent event, crypto::ByteView message, TraceReason reason = TraceReason::NONE);
+    void traceAlert(NodeId suspect, TraceReason reason);
+    bool isFreshSequence(NodeId source, uint32_t sequence) const;
+    // Unverified frames are held to at most SEQUENCE_WINDOW ahead of the
+    // sender's last verified sequence
+    bool isNearVerifiedSequence(NodeId source, uint32_t sequence) const;
+    // Returns the sender's row, valid until the next NodeTable::clearField()
+    uint32_t recordSequence(NodeId source, uint32_t sequence);
+    double calculateTrust(NodeId node);
+    double evaluateTrust(uint32_t row);
+    void invalidateTrustNear(const Position& position);
+    uint32_t lookupRoute(NodeId destination);
+    size_t identitiesNear(NodeId self, const Position& position, double radius) const;
     double calculateDistance(const Position& pos1, const Position& pos2);
     bool isValidMovement(const Position& oldPos, const Position& newPos, double timeElapsed);
-    void pruneExpiredEntries();
+    bool isFalsifiedMove(NodeId node, const Position& from, const Position& to);
+    void scheduleExpiry(NodeId node, NodeTable::Field field,
+                        std::chrono::system_clock::time_point timestamp);
+    void expireEntry(uint64_t key, std::chrono::system_clock::time_point now);
+    void pruneExpiredEntries(std::chrono::system_clock::time_point now);
 };
 
 } // namespace routing
@@ -0,0 +1,178 @@
+#include "spatial-grid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace vanet {
+namespace routing {
+
+static double squaredDistance(double x, double y, double z, const Position& p) {
+    double dx = x - p.x;
+    double dy = y - p.y;
+    double dz = z - p.z;
+    return dx*dx + dy*dy + dz*dz;
+}
+
+SpatialGrid::SpatialGrid(double cellSize)
+    : cellSize(cellSize > 0 ? cellSize : 1.0),
+      minCellX(std::numeric_limits<int32_t>::max()), maxCellX(std::numeric_limits<int32_t>::min()),
+      minCellY(std::numeric_limits<int32_t>::max()), maxCellY(std::numeric_limits<int32_t>::min()) {}
+
+int32_t SpatialGrid::cellCoord(double v) const {
+    double c = std::floor(v / cellSize);
+    c = std::max(c, static_cast<double>(std::numeric_limits<int32_t>::min()));
+    c = std::min(c, static_cast<double>(std::numeric_limits<int32_t>::max()));
+    return static_cast<int32_t>(c);
+}
+
+uint64_t SpatialGrid::cellKey(int32_t cx, int32_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+void SpatialGrid::update(NodeId id, const Position& position) {
+    int32_t cx = cellCoord(position.x);
+    int32_t cy = cellCoord(position.y);
+    uint64_t key = cellKey(cx, cy);
+
+    auto it = locators.find(id);
+    if (it != locators.end()) {
+        if (it->second.cell == key) {
+            Item& item = cells[key][it->second.index];
+            item.x = position.x;
+            item.y = position.y;
+            item.z = position.z;
+            return;
+        }
+        removeItem(it->second);
+    }
+
+    auto& cell = cells[key];
+    locators[id] = Locator{key, static_cast<uint32_t>(cell.size())};
+    cell.push_back(Item{id, position.x, position.y, position.z});
+
+    minCellX = std::min(minCellX, cx);
+    maxCellX = std::max(maxCellX, cx);
+    minCellY = std::min(minCellY, cy);
+    maxCellY = std::max(maxCellY, cy);
+}
+
+bool SpatialGrid::remove(NodeId id) {
+    auto it = locators.find(id);
+    if (it == locators.end()) {
+        return false;
+    }
+    removeItem(it->second);
+    locators.erase(it);
+    return true;
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    locators.clear();
+    minCellX = minCellY = std::numeric_limits<int32_t>::max();
+    maxCellX = maxCellY = std::numeric_limits<int32_t>::min();
+}
+
+void SpatialGrid::removeItem(const Locator& locator) {
+    auto cellIt = cells.find(locator.cell);
+    auto& cell = cellIt->second;
+    if (locator.index + 1 != cell.size()) {
+        cell[locator.index] = cell.back();
+        locators[cell[locator.index].id].index = locator.index;
+    }
+    cell.pop_back();
+    if (cell.empty()) {
+        cells.erase(cellIt);
+    }
+}
+
+void SpatialGrid::queryRadius(const Position& center, double radius,
+                              std::vector<NodeId>& out) const {
+    if (locators.empty() || radius < 0) {
+        return;
+    }
+
+    int32_t x0 = std::max(cellCoord(center.x - radius), minCellX);
+    int32_t x1 = std::min(cellCoord(center.x + radius), maxCellX);
+    int32_t y0 = std::max(cellCoord(center.y - radius), minCellY);
+    int32_t y1 = std::min(cellCoord(center.y + radius), maxCellY);
+    double limit = radius * radius;
+
+    for (int64_t cx = x0; cx <= x1; ++cx) {
+        for (int64_t cy = y0; cy <= y1; ++cy) {
+            auto it = cells.find(cellKey(static_cast<int32_t>(cx), static_cast<int32_t>(cy)));
+            if (it == cells.end()) {
+                continue;
+            }
+            for (const auto& item : it->second) {
+                if (squaredDistance(item.x, item.y, item.z, center) <= limit) {
+                    out.push_back(item.id);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::nearest(const Position& center, size_t k, std::vector<NodeId>& out) const {
+    if (k == 0 || locators.empty()) {
+        return;
+    }
+
+    // Search rings of cells around the center's cell. Anything outside ring r
+    // is at least r * cellSize away, so stop once the k-th best is closer.
+    std::vector<std::pair<double, NodeId>> best;  // max-heap on distance
+    int64_t cx = cellCoord(center.x);
+    int64_t cy = cellCoord(center.y);
+    int64_t maxRing = std::max({cx - minCellX, maxCellX - cx, cy - minCellY, maxCellY - cy, int64_t(0)});
+
+    auto visit = [&](int64_t x, int64_t y) {
+        if (x < minCellX || x > maxCellX || y < minCellY || y > maxCellY) {
+            return;
+        }
+        auto it = cells.find(cellKey(static_cast<int32_t>(x), static_cast<int32_t>(y)));
+        if (it == cells.end()) {
+            return;
+        }
+        for (const auto& item : it->second) {
+            double d = squaredDistance(item.x, item.y, item.z, center);
+            if (best.size() < k) {
+                best.emplace_back(d, item.id);
+                std::push_heap(best.begin(), best.end());
+            } else if (d < best.front().first) {
+                std::pop_heap(best.begin(), best.end());
+                best.back() = {d, item.id};
+                std::push_heap(best.begin(), best.end());
+            }
+        }
+    };
+
+    for (int64_t ring = 0; ring <= maxRing; ++ring) {
+        if (ring == 0) {
+            visit(cx, cy);
+        } else {
+            for (int64_t x = cx - ring; x <= cx + ring; ++x) {
+                visit(x, cy - ring);
+                visit(x, cy + ring);
+            }
+            for (int64_t y = cy - ring + 1; y <= cy + ring - 1; ++y) {
+                visit(cx - ring, y);
+                visit(cx + ring, y);
+            }
+        }
+
+        double reach = ring * cellSize;
+        if (best.size() == locators.size() ||
+            (best.size() == k && best.front().first <= reach * reach)) {
+            break;
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for (const auto& entry : best) {
+        out.push_back(entry.second);
+    }
+}
+
+} // namespace routing
+} // namespace vanet
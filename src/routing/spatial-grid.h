@@ -0,0 +1,64 @@
+#ifndef VANET_SPATIAL_GRID_H
+#define VANET_SPATIAL_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "routing-types.h"
+#include "node-table.h"
+
+namespace vanet {
+namespace routing {
+
+// Uniform grid over the x/y plane for proximity queries on node positions.
+// Each cell keeps its nodes and their coordinates contiguously, and a
+// locator per node makes update and removal O(1). Distances are 3D, like
+// SecureRoutingProtocol::calculateDistance.
+//
+// Queries cost O(cells covered + nodes in them), so cellSize should be on
+// the order of the typical query radius.
+class SpatialGrid {
+public:
+    explicit SpatialGrid(double cellSize);
+
+    // Inserts the node or moves it to its new position
+    void update(NodeId id, const Position& position);
+    bool remove(NodeId id);
+    bool contains(NodeId id) const { return locators.count(id) != 0; }
+    size_t size() const { return locators.size(); }
+    void clear();
+
+    // Every node within radius of center, in no particular order
+    void queryRadius(const Position& center, double radius, std::vector<NodeId>& out) const;
+    // Up to k nodes nearest to center, closest first
+    void nearest(const Position& center, size_t k, std::vector<NodeId>& out) const;
+
+private:
+    struct Item {
+        NodeId id;
+        double x;
+        double y;
+        double z;
+    };
+
+    struct Locator {
+        uint64_t cell;
+        uint32_t index;
+    };
+
+    double cellSize;
+    std::unordered_map<uint64_t, std::vector<Item>> cells;
+    std::unordered_map<NodeId, Locator> locators;
+    // Bounds of every cell used so far; limits how far nearest() searches
+    int32_t minCellX, maxCellX, minCellY, maxCellY;
+
+    int32_t cellCoord(double v) const;
+    static uint64_t cellKey(int32_t cx, int32_t cy);
+    void removeItem(const Locator& locator);
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_SPATIAL_GRID_H
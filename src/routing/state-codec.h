@@ -0,0 +1,112 @@
+#ifndef VANET_STATE_CODEC_H
+#define VANET_STATE_CODEC_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../crypto/byte-view.h"
+#include "wire-format.h"
+
+namespace vanet {
+namespace routing {
+
+// Little-endian encoder for state snapshots, e.g. protocol state handed to
+// another MPI rank when a vehicle migrates
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void u8(uint8_t v) { out.push_back(v); }
+    void u32(uint32_t v) { size_t at = grow(4); storeLE32(out.data() + at, v); }
+    void u64(uint64_t v) { size_t at = grow(8); storeLE64(out.data() + at, v); }
+
+    void f64(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+
+    void time(std::chrono::system_clock::time_point t) {
+        u64(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            t.time_since_epoch()).count()));
+    }
+
+    void bytes(crypto::ByteView data) {
+        u32(static_cast<uint32_t>(data.size()));
+        out.insert(out.end(), data.begin(), data.end());
+    }
+
+    void string(const std::string& s) {
+        bytes(crypto::ByteView(reinterpret_cast<const uint8_t*>(s.data()), s.size()));
+    }
+
+private:
+    std::vector<uint8_t>& out;
+
+    size_t grow(size_t n) {
+        size_t at = out.size();
+        out.resize(at + n);
+        return at;
+    }
+};
+
+// Matching decoder. Reads past the end return zero and mark the reader
+// failed, so callers decode everything and check ok() once.
+class ByteReader {
+public:
+    explicit ByteReader(crypto::ByteView in) : in(in), offset(0), failed(false) {}
+
+    uint8_t u8() { return take(1) ? in[offset - 1] : 0; }
+    uint32_t u32() { return take(4) ? loadLE32(in.data() + offset - 4) : 0; }
+    uint64_t u64() { return take(8) ? loadLE64(in.data() + offset - 8) : 0; }
+
+    double f64() {
+        uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    std::chrono::system_clock::time_point time() {
+        auto us = std::chrono::microseconds(static_cast<int64_t>(u64()));
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(us));
+    }
+
+    crypto::ByteView bytes() {
+        uint32_t size = u32();
+        if (!take(size)) {
+            return crypto::ByteView();
+        }
+        return in.subview(offset - size, size);
+    }
+
+    std::string string() {
+        crypto::ByteView data = bytes();
+        return std::string(data.begin(), data.end());
+    }
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return offset == in.size(); }
+
+private:
+    crypto::ByteView in;
+    size_t offset;
+    bool failed;
+
+    bool take(size_t n) {
+        if (failed || in.size() - offset < n) {
+            failed = true;
+            return false;
+        }
+        offset += n;
+        return true;
+    }
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_STATE_CODEC_H
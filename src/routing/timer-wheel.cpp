@@ -0,0 +1,168 @@
+#include "timer-wheel.h"
+
+namespace vanet {
+namespace routing {
+
+TimerWheel::TimerWheel(uint64_t tickMs)
+    : tickMs(tickMs ? tickMs : 1), currentTick(0), isStarted(false),
+      heads(LEVELS * SLOTS, NIL), levelCounts{} {}
+
+void TimerWheel::start(uint64_t nowMs) {
+    if (!isStarted) {
+        currentTick = nowMs / tickMs;
+        isStarted = true;
+    }
+}
+
+void TimerWheel::schedule(uint64_t key, uint64_t deadlineMs) {
+    uint64_t deadlineTick = (deadlineMs + tickMs - 1) / tickMs;
+    if (!isStarted) {
+        currentTick = deadlineTick ? deadlineTick - 1 : 0;
+        isStarted = true;
+    }
+
+    auto it = index.find(key);
+    uint32_t timer;
+    if (it != index.end()) {
+        timer = it->second;
+        unlink(timer);
+    } else {
+        if (freeTimers.empty()) {
+            timer = static_cast<uint32_t>(timers.size());
+            timers.push_back(Timer{});
+        } else {
+            timer = freeTimers.back();
+            freeTimers.pop_back();
+        }
+        index.emplace(key, timer);
+    }
+
+    timers[timer].key = key;
+    timers[timer].deadlineTick = deadlineTick;
+    place(timer, false);
+}
+
+bool TimerWheel::cancel(uint64_t key) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return false;
+    }
+    unlink(it->second);
+    freeTimers.push_back(it->second);
+    index.erase(it);
+    return true;
+}
+
+void TimerWheel::advance(uint64_t nowMs, const std::function<void(uint64_t key)>& onExpire) {
+    uint64_t target = nowMs / tickMs;
+    if (!isStarted) {
+        start(nowMs);
+        return;
+    }
+
+    while (currentTick < target) {
+        if (index.empty()) {
+            currentTick = target;
+            break;
+        }
+
+        // Skip ahead over ticks whose finer levels are empty
+        uint32_t lowest = 0;
+        while (lowest < LEVELS && levelCounts[lowest] == 0) {
+            ++lowest;
+        }
+        if (lowest > 0 && lowest < LEVELS) {
+            uint64_t span = (uint64_t(1) << (SLOT_BITS * lowest)) - 1;
+            uint64_t skipTo = currentTick | span;
+            if (skipTo > currentTick) {
+                currentTick = skipTo < target ? skipTo : target;
+                if (currentTick == target) {
+                    break;
+                }
+            }
+        }
+
+        ++currentTick;
+
+        // Pull timers down from coarser levels whose slot boundary we crossed
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            if ((currentTick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+
+        uint32_t slot = static_cast<uint32_t>(currentTick & (SLOTS - 1));
+        uint32_t timer = heads[slot];
+        while (timer != NIL) {
+            uint32_t next = timers[timer].next;
+            if (timers[timer].deadlineTick <= currentTick) {
+                uint64_t key = timers[timer].key;
+                unlink(timer);
+                freeTimers.push_back(timer);
+                index.erase(key);
+                onExpire(key);
+                // The callback may have relinked timers out of this slot
+                timer = heads[slot];
+                continue;
+            }
+            timer = next;
+        }
+    }
+}
+
+void TimerWheel::place(uint32_t timer, bool cascading) {
+    // New timers never land in the slot being fired, so a callback re-arming
+    // at the same deadline cannot loop; cascaded ones may still be due now.
+    Timer& t = timers[timer];
+    uint64_t earliest = cascading ? currentTick : currentTick + 1;
+    uint64_t due = t.deadlineTick > earliest ? t.deadlineTick : earliest;
+    uint64_t delta = due - currentTick;
+
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    uint64_t horizon = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    if (delta > horizon) {
+        due = currentTick + horizon;  // re-placed from its real deadline on cascade
+    }
+
+    uint32_t slot = level * SLOTS + static_cast<uint32_t>((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+    t.slot = slot;
+    t.prev = NIL;
+    t.next = heads[slot];
+    if (t.next != NIL) {
+        timers[t.next].prev = timer;
+    }
+    heads[slot] = timer;
+    ++levelCounts[level];
+}
+
+void TimerWheel::unlink(uint32_t timer) {
+    Timer& t = timers[timer];
+    if (t.prev != NIL) {
+        timers[t.prev].next = t.next;
+    } else {
+        heads[t.slot] = t.next;
+    }
+    if (t.next != NIL) {
+        timers[t.next].prev = t.prev;
+    }
+    --levelCounts[t.slot / SLOTS];
+    t.prev = t.next = NIL;
+}
+
+void TimerWheel::cascade(uint32_t level) {
+    uint32_t slot = level * SLOTS +
+        static_cast<uint32_t>((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    uint32_t timer = heads[slot];
+    while (timer != NIL) {
+        uint32_t next = timers[timer].next;
+        unlink(timer);
+        place(timer, true);
+        timer = next;
+    }
+}
+
+} // namespace routing
+} // namespace vanet
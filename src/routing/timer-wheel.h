@@ -0,0 +1,72 @@
+#ifndef VANET_TIMER_WHEEL_H
+#define VANET_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace vanet {
+namespace routing {
+
+// Hierarchical timing wheel (Varghese & Lauck) for entry expiry. Scheduling,
+// rescheduling and cancelling are O(1); advance() only touches timers that
+// are due plus the occasional cascade from a coarser level.
+//
+// The wheel has no clock of its own: it is driven by advance(nowMs) with
+// whatever time base the owner uses, wall clock or ns-3 Simulator::Now(),
+// as long as deadlines are given in the same base.
+class TimerWheel {
+public:
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+
+    explicit TimerWheel(uint64_t tickMs);
+
+    // Sets the wheel's notion of "now" before the first timer is scheduled.
+    // Without it the first schedule() call picks a start time itself.
+    void start(uint64_t nowMs);
+    bool started() const { return isStarted; }
+
+    // Arms (or re-arms) the timer for key
+    void schedule(uint64_t key, uint64_t deadlineMs);
+    bool cancel(uint64_t key);
+    bool pending(uint64_t key) const { return index.count(key) != 0; }
+    size_t size() const { return index.size(); }
+
+    // Fires every timer whose deadline has been reached, in tick order.
+    // onExpire may schedule or cancel timers, including the one firing.
+    void advance(uint64_t nowMs, const std::function<void(uint64_t key)>& onExpire);
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Timer {
+        uint64_t key;
+        uint64_t deadlineTick;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t slot;
+    };
+
+    uint64_t tickMs;
+    uint64_t currentTick;
+    bool isStarted;
+
+    std::vector<Timer> timers;
+    std::vector<uint32_t> freeTimers;
+    std::vector<uint32_t> heads;             // LEVELS * SLOTS list heads
+    uint32_t levelCounts[LEVELS];
+    std::unordered_map<uint64_t, uint32_t> index;
+
+    void place(uint32_t timer, bool cascading);
+    void unlink(uint32_t timer);
+    void cascade(uint32_t level);
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_TIMER_WHEEL_H
@@ -0,0 +1,186 @@
+#include "trace-sink.h"
+#include "wire-format.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace vanet {
+namespace routing {
+
+// Entry width of each column, in layout order
+constexpr size_t COLUMN_WIDTHS[TraceSink::COLUMN_COUNT] = {8, 4, 4, 4, 4, 4, 2, 1, 1, 1};
+
+enum Column { TIME, NODE, PEER, SEQUENCE, X, Y, SIZE, EVENT, TYPE, REASON };
+
+static size_t align8(size_t value) {
+    return (value + 7) & ~size_t(7);
+}
+
+size_t TraceSink::segmentBytes(uint32_t capacity) {
+    size_t size = HEADER_SIZE;
+    for (size_t width : COLUMN_WIDTHS) {
+        size += align8(width * capacity);
+    }
+    return size;
+}
+
+TraceSink::TraceSink(const std::string& prefix, uint32_t recordsPerSegment, size_t ringDepth)
+    : prefix(prefix), capacity(recordsPerSegment ? recordsPerSegment : 1),
+      bytes(segmentBytes(capacity)), ring(ringDepth ? ringDepth : 1), current(0), nextIndex(0),
+      filled(0), captureMask((1u << MESSAGE_TYPE_COUNT) - 1), totalRecords(0), healthy(true) {
+    size_t offset = HEADER_SIZE;
+    for (size_t c = 0; c < COLUMN_COUNT; ++c) {
+        offsets[c] = static_cast<uint32_t>(offset);
+        offset += align8(COLUMN_WIDTHS[c] * capacity);
+    }
+
+    // Map the whole ring up front so the first records never wait on a file
+    for (auto& segment : ring) {
+        healthy = healthy && open(segment);
+    }
+}
+
+TraceSink::~TraceSink() {
+    close();
+}
+
+void TraceSink::capture(MessageType type, bool enabled) {
+    uint32_t bit = 1u << static_cast<unsigned>(type);
+    captureMask = enabled ? captureMask | bit : captureMask & ~bit;
+}
+
+uint32_t TraceSink::segments() const {
+    return filled + (!ring.empty() && ring[current].count > 0);
+}
+
+std::string TraceSink::pathOf(uint32_t index) const {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "-%06u.vtr", index);
+    return prefix + suffix;
+}
+
+bool TraceSink::open(Segment& segment) {
+    segment.index = nextIndex++;
+    segment.count = 0;
+#ifdef _WIN32
+    segment.buffer.assign(bytes, 0);
+    segment.base = segment.buffer.data();
+#else
+    // The file is sized once and left sparse; pages are only backed once
+    // written, so opening costs a few system calls whatever the segment size
+    segment.fd = ::open(pathOf(segment.index).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (segment.fd < 0) {
+        return false;
+    }
+    if (::ftruncate(segment.fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(segment.fd);
+        segment.fd = -1;
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+    if (mapped == MAP_FAILED) {
+        ::close(segment.fd);
+        segment.fd = -1;
+        return false;
+    }
+    segment.base = static_cast<uint8_t*>(mapped);
+    ::madvise(mapped, bytes, MADV_SEQUENTIAL);
+#endif
+
+    uint8_t* header = segment.base;
+    storeLE32(header, MAGIC);
+    header[4] = VERSION & 0xff;
+    header[5] = VERSION >> 8;
+    header[6] = COLUMN_COUNT & 0xff;
+    header[7] = 0;
+    storeLE32(header + 8, capacity);
+    storeLE32(header + 12, 0);
+    storeLE32(header + 16, segment.index);
+    storeLE32(header + 20, 0);
+    for (size_t c = 0; c < COLUMN_COUNT; ++c) {
+        storeLE32(header + 24 + 4 * c, offsets[c]);
+    }
+    return true;
+}
+
+void TraceSink::retire(Segment& segment, bool keep) {
+    if (!segment.base) {
+        return;
+    }
+#ifdef _WIN32
+    if (keep) {
+        std::ofstream out(pathOf(segment.index), std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(segment.base), static_cast<std::streamsize>(bytes));
+    }
+    segment.buffer.clear();
+    segment.buffer.shrink_to_fit();
+#else
+    ::munmap(segment.base, bytes);
+    ::close(segment.fd);
+    segment.fd = -1;
+    if (!keep) {
+        std::remove(pathOf(segment.index).c_str());
+    }
+#endif
+    segment.base = nullptr;
+}
+
+void TraceSink::rotate() {
+    ++filled;
+    retire(ring[current], true);
+    // The freed slot becomes the last of the ring; writing continues in the
+    // next one, mapped ahead. Retiring and reopening run here, in the record
+    // that filled the segment: an unmap, a close and a sparse open and map.
+    healthy = open(ring[current]);
+    current = (current + 1) % ring.size();
+    healthy = healthy && ring[current].base;
+}
+
+void TraceSink::record(const TraceRecord& record) {
+    bool packetRecord = record.event == TraceEvent::SEND || record.event == TraceEvent::RECEIVE;
+    if (!healthy || (packetRecord && !captures(static_cast<MessageType>(record.type)))) {
+        return;
+    }
+
+    Segment& segment = ring[current];
+    uint8_t* base = segment.base;
+    uint32_t i = segment.count;
+    storeLE64(base + offsets[TIME] + 8 * i, record.timeNs);
+    storeLE32(base + offsets[NODE] + 4 * i, record.node);
+    storeLE32(base + offsets[PEER] + 4 * i, record.peer);
+    storeLE32(base + offsets[SEQUENCE] + 4 * i, record.sequence);
+    storeFloatLE(base + offsets[X] + 4 * i, record.x);
+    storeFloatLE(base + offsets[Y] + 4 * i, record.y);
+    base[offsets[SIZE] + 2 * i] = record.size & 0xff;
+    base[offsets[SIZE] + 2 * i + 1] = record.size >> 8;
+    base[offsets[EVENT] + i] = static_cast<uint8_t>(record.event);
+    base[offsets[TYPE] + i] = record.type;
+    base[offsets[REASON] + i] = static_cast<uint8_t>(record.reason);
+
+    // Readers of a live or crashed run see every record counted here
+    segment.count = i + 1;
+    storeLE32(base + 12, segment.count);
+    ++totalRecords;
+
+    if (segment.count == capacity) {
+        rotate();
+    }
+}
+
+void TraceSink::close() {
+    // Empty segments, including the ones mapped ahead, leave no file behind
+    for (auto& segment : ring) {
+        retire(segment, segment.count > 0);
+    }
+    healthy = false;
+}
+
+} // namespace routing
+} // namespace vanet
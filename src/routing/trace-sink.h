@@ -0,0 +1,124 @@
+#ifndef VANET_TRACE_SINK_H
+#define VANET_TRACE_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "node-table.h"
+#include "routing-types.h"
+
+namespace vanet {
+namespace routing {
+
+enum class TraceEvent : uint8_t {
+    SEND,
+    RECEIVE,
+    REJECT,
+    ALERT
+};
+
+enum class TraceReason : uint8_t {
+    NONE,
+    MALFORMED,
+    STALE_OR_REPLAYED,
+    BAD_SIGNATURE,
+    SYBIL,
+    POSITION_FALSIFICATION,
+    BLACK_HOLE
+};
+
+struct TraceRecord {
+    uint64_t timeNs;
+    NodeId node;         // node that recorded the event
+    NodeId peer;         // other end of the packet, or the suspect of an alert
+    uint32_t sequence;
+    float x;             // recording node's position
+    float y;
+    uint16_t size;       // packet bytes
+    TraceEvent event;
+    uint8_t type;        // MessageType, or the raw type byte of a malformed packet
+    TraceReason reason;
+};
+
+// Binary packet and security event trace. Records are stored column-wise
+// in fixed-size segment files <prefix>-000000.vtr, <prefix>-000001.vtr, ...
+// which are memory-mapped in a ring of ringDepth segments, so recording is
+// a handful of stores into mapped pages and the kernel does the writing.
+// The record that fills a segment also retires it and maps a fresh sparse
+// file into its slot, which takes a few system calls.
+//
+// Segment layout, little-endian:
+//   0  u32 magic "VTRC"   4  u16 version   6  u16 column count
+//   8  u32 capacity      12  u32 records written
+//  16  u32 segment index 20  u32 reserved
+//  24  u32 byte offset of each column below, in order
+//  64  columns of `capacity` entries, each 8-byte aligned:
+//      time_ns u64, node u32, peer u32, sequence u32, x f32, y f32,
+//      size u16, event u8, type u8, reason u8
+// analysis/trace_reader.py loads segments without parsing.
+class TraceSink {
+public:
+    static constexpr uint32_t MAGIC = 0x43525456;  // "VTRC"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t COLUMN_COUNT = 10;
+
+    explicit TraceSink(const std::string& prefix, uint32_t recordsPerSegment = 1 << 16,
+                       size_t ringDepth = 2);
+    ~TraceSink();
+
+    TraceSink(const TraceSink&) = delete;
+    TraceSink& operator=(const TraceSink&) = delete;
+
+    bool ok() const { return healthy; }
+
+    // Selects the SEND and RECEIVE records kept; all types are captured until
+    // told otherwise. Rejections and alerts are always kept.
+    void capture(MessageType type, bool enabled);
+    void captureNone() { captureMask = 0; }
+    bool captures(MessageType type) const { return (captureMask >> static_cast<unsigned>(type)) & 1; }
+
+    void record(const TraceRecord& record);
+    // Writes out and unmaps every segment; later records are dropped
+    void close();
+
+    uint64_t recorded() const { return totalRecords; }
+    // Segments holding at least one record
+    uint32_t segments() const;
+    static size_t segmentBytes(uint32_t capacity);
+
+private:
+    struct Segment {
+        uint8_t* base = nullptr;
+        uint32_t index = 0;
+        uint32_t count = 0;
+#ifdef _WIN32
+        std::vector<uint8_t> buffer;
+#else
+        int fd = -1;
+#endif
+    };
+
+    std::string prefix;
+    uint32_t capacity;
+    size_t bytes;
+    uint32_t offsets[COLUMN_COUNT];
+    std::vector<Segment> ring;
+    size_t current;
+    uint32_t nextIndex;
+    uint32_t filled;
+    uint32_t captureMask;
+    uint64_t totalRecords;
+    bool healthy;
+
+    std::string pathOf(uint32_t index) const;
+    bool open(Segment& segment);
+    void retire(Segment& segment, bool keep);
+    void rotate();
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_TRACE_SINK_H
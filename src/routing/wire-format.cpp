@@ -0,0 +1,228 @@
+#include "wire-format.h"
+#include <cmath>
+
+namespace vanet {
+namespace routing {
+
+size_t encodeHeader(const MessageHeader& header, uint8_t* out, size_t capacity) {
+    if (capacity < HEADER_SIZE) {
+        return 0;
+    }
+
+    out[0] = WIRE_VERSION;
+    out[1] = static_cast<uint8_t>(header.type);
+    out[2] = header.ttl;
+    out[3] = 0;
+    storeLE32(out + 4, header.source);
+    storeLE32(out + 8, header.destination);
+    storeLE32(out + 12, header.sequence);
+    storeLE64(out + 16, header.timestamp);
+    storeFloatLE(out + 24, header.x);
+    storeFloatLE(out + 28, header.y);
+    storeFloatLE(out + 32, header.z);
+    return HEADER_SIZE;
+}
+
+size_t encodeBeacon(const MessageHeader& header, float speed, float direction,
+                    uint8_t* out, size_t capacity) {
+    if (capacity < BEACON_SIZE || header.type != MessageType::HELLO) {
+        return 0;
+    }
+
+    encodeHeader(header, out, capacity);
+    storeFloatLE(out + HEADER_SIZE, speed);
+    storeFloatLE(out + HEADER_SIZE + 4, direction);
+    return BEACON_SIZE;
+}
+
+size_t encodeRouteRequest(const MessageHeader& header, const RouteRequest& request,
+                          uint8_t* out, size_t capacity) {
+    if (capacity < ROUTE_REQUEST_SIZE || header.type != MessageType::ROUTE_REQUEST) {
+        return 0;
+    }
+
+    encodeHeader(header, out, capacity);
+    uint8_t* body = out + HEADER_SIZE;
+    storeLE32(body, request.originator);
+    storeLE32(body + 4, request.broadcastId);
+    storeLE32(body + 8, request.originatorSequence);
+    storeLE32(body + 12, request.destinationSequence);
+    body[16] = request.hopCount;
+    body[17] = body[18] = body[19] = 0;
+    return ROUTE_REQUEST_SIZE;
+}
+
+size_t encodeRouteReply(const MessageHeader& header, const RouteReply& reply,
+                        uint8_t* out, size_t capacity) {
+    if (capacity < ROUTE_REPLY_SIZE || header.type != MessageType::ROUTE_REPLY) {
+        return 0;
+    }
+
+    encodeHeader(header, out, capacity);
+    uint8_t* body = out + HEADER_SIZE;
+    storeLE32(body, reply.target);
+    storeLE32(body + 4, reply.targetSequence);
+    storeLE32(body + 8, reply.nextHop);
+    storeLE32(body + 12, reply.lifetimeMs);
+    body[16] = reply.hopCount;
+    body[17] = body[18] = body[19] = 0;
+    return ROUTE_REPLY_SIZE;
+}
+
+size_t encodeRouteError(const MessageHeader& header, const RouteError& error,
+                        uint8_t* out, size_t capacity) {
+    if (capacity < ROUTE_ERROR_SIZE || header.type != MessageType::ROUTE_ERROR) {
+        return 0;
+    }
+
+    encodeHeader(header, out, capacity);
+    storeLE32(out + HEADER_SIZE, error.unreachable);
+    storeLE32(out + HEADER_SIZE + 4, error.sequence);
+    return ROUTE_ERROR_SIZE;
+}
+
+size_t encodeDataHeader(const MessageHeader& header, const DataHop& hop,
+                        uint8_t* out, size_t capacity) {
+    if (capacity < DATA_HEADER_SIZE || header.type != MessageType::DATA) {
+        return 0;
+    }
+
+    encodeHeader(header, out, capacity);
+    storeLE32(out + HEADER_SIZE, hop.originator);
+    storeLE32(out + HEADER_SIZE + 4, hop.nextHop);
+    return DATA_HEADER_SIZE;
+}
+
+// Rounds value * scale into [low, high]; false if it falls outside
+static bool quantize(double value, double scale, double low, double high, int32_t& out) {
+    double scaled = std::round(value * scale);
+    if (!(scaled >= low && scaled <= high)) {
+        return false;
+    }
+    out = static_cast<int32_t>(scaled);
+    return true;
+}
+
+size_t encodeDeltaBeacon(const DeltaBeacon& beacon, uint8_t* out, size_t capacity) {
+    int32_t dx, dy, dz, speed, direction;
+    if (capacity < DELTA_BEACON_SIZE || beacon.elapsedMs > UINT16_MAX ||
+        !quantize(beacon.dx, 100.0, INT16_MIN, INT16_MAX, dx) ||
+        !quantize(beacon.dy, 100.0, INT16_MIN, INT16_MAX, dy) ||
+        !quantize(beacon.dz, 100.0, INT16_MIN, INT16_MAX, dz) ||
+        !quantize(beacon.speed, 100.0, 0, UINT16_MAX, speed) ||
+        !quantize(std::fmod(std::fmod(beacon.direction, 360.0) + 360.0, 360.0), 100.0, 0, 36000, direction)) {
+        return 0;
+    }
+    direction %= 36000;
+
+    out[0] = WIRE_VERSION;
+    out[1] = static_cast<uint8_t>(MessageType::HELLO);
+    out[2] = 1;
+    out[3] = FLAG_DELTA_BEACON;
+    storeLE32(out + 4, beacon.source);
+    storeLE32(out + 8, beacon.sequence);
+    storeLE32(out + 12, beacon.baseSequence);
+    const int32_t fields[] = {static_cast<int32_t>(beacon.elapsedMs), dx, dy, dz, speed, direction};
+    for (size_t i = 0; i < 6; ++i) {
+        uint16_t bits = static_cast<uint16_t>(fields[i]);
+        out[16 + 2 * i] = static_cast<uint8_t>(bits);
+        out[17 + 2 * i] = static_cast<uint8_t>(bits >> 8);
+    }
+    return DELTA_BEACON_SIZE;
+}
+
+bool decodeDeltaBeacon(crypto::ByteView bytes, DeltaBeacon& out) {
+    if (bytes.size() < DELTA_BEACON_SIZE || !isDeltaBeacon(bytes)) {
+        return false;
+    }
+    auto u16 = [&bytes](size_t offset) {
+        return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+    };
+    out.source = loadLE32(bytes.data() + 4);
+    out.sequence = loadLE32(bytes.data() + 8);
+    out.baseSequence = loadLE32(bytes.data() + 12);
+    out.elapsedMs = u16(16);
+    out.dx = static_cast<int16_t>(u16(18)) / 100.0;
+    out.dy = static_cast<int16_t>(u16(20)) / 100.0;
+    out.dz = static_cast<int16_t>(u16(22)) / 100.0;
+    out.speed = u16(24) / 100.0;
+    out.direction = u16(26) / 100.0;
+    return true;
+}
+
+bool MessageView::parse(crypto::ByteView message) {
+    bytes = crypto::ByteView();
+    if (message.size() < HEADER_SIZE || message[0] != WIRE_VERSION ||
+        message[1] > static_cast<uint8_t>(MessageType::DATA) || (message[3] & FLAG_DELTA_BEACON)) {
+        return false;
+    }
+    bytes = message;
+    return true;
+}
+
+Position MessageView::position() const {
+    Position pos;
+    pos.x = loadFloatLE(bytes.data() + 24);
+    pos.y = loadFloatLE(bytes.data() + 28);
+    pos.z = loadFloatLE(bytes.data() + 32);
+    pos.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(timestamp()));
+    return pos;
+}
+
+bool MessageView::isBeacon() const {
+    return type() == MessageType::HELLO && bytes.size() >= BEACON_SIZE;
+}
+
+bool MessageView::routeRequest(RouteRequest& out) const {
+    if (!valid() || type() != MessageType::ROUTE_REQUEST || bytes.size() < ROUTE_REQUEST_SIZE) {
+        return false;
+    }
+    const uint8_t* body = bytes.data() + HEADER_SIZE;
+    out.originator = loadLE32(body);
+    out.broadcastId = loadLE32(body + 4);
+    out.originatorSequence = loadLE32(body + 8);
+    out.destinationSequence = loadLE32(body + 12);
+    out.hopCount = body[16];
+    return true;
+}
+
+bool MessageView::routeReply(RouteReply& out) const {
+    if (!valid() || type() != MessageType::ROUTE_REPLY || bytes.size() < ROUTE_REPLY_SIZE) {
+        return false;
+    }
+    const uint8_t* body = bytes.data() + HEADER_SIZE;
+    out.target = loadLE32(body);
+    out.targetSequence = loadLE32(body + 4);
+    out.nextHop = loadLE32(body + 8);
+    out.lifetimeMs = loadLE32(body + 12);
+    out.hopCount = body[16];
+    return true;
+}
+
+bool MessageView::routeError(RouteError& out) const {
+    if (!valid() || type() != MessageType::ROUTE_ERROR || bytes.size() < ROUTE_ERROR_SIZE) {
+        return false;
+    }
+    out.unreachable = loadLE32(bytes.data() + HEADER_SIZE);
+    out.sequence = loadLE32(bytes.data() + HEADER_SIZE + 4);
+    return true;
+}
+
+bool MessageView::dataHop(DataHop& out) const {
+    if (!valid() || type() != MessageType::DATA || bytes.size() < DATA_HEADER_SIZE) {
+        return false;
+    }
+    out.originator = loadLE32(bytes.data() + HEADER_SIZE);
+    out.nextHop = loadLE32(bytes.data() + HEADER_SIZE + 4);
+    return true;
+}
+
+crypto::ByteView MessageView::dataBody() const {
+    if (!valid() || type() != MessageType::DATA || bytes.size() < DATA_HEADER_SIZE) {
+        return crypto::ByteView();
+    }
+    return bytes.subview(DATA_HEADER_SIZE, bytes.size() - DATA_HEADER_SIZE);
+}
+
+} // namespace routing
+} // namespace vanet
@@ -0,0 +1,217 @@
+#ifndef VANET_WIRE_FORMAT_H
+#define VANET_WIRE_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../crypto/byte-view.h"
+#include "routing-types.h"
+#include "node-table.h"
+
+namespace vanet {
+namespace routing {
+
+// Routing message layout, version 1. All fields little-endian:
+//
+//   offset  size  field
+//        0     1  version
+//        1     1  type (MessageType)
+//        2     1  ttl
+//        3     1  flags (FLAG_DELTA_BEACON, otherwise zero)
+//        4     4  source NodeId
+//        8     4  destination NodeId (BROADCAST_NODE for none)
+//       12     4  sequence
+//       16     8  timestamp, ms since epoch
+//       24    12  sender position x, y, z (float32, meters)
+//       36        payload
+//
+// HELLO payloads carry speed and direction as float32. Route discovery
+// payloads, all u32 unless noted:
+//
+//   ROUTE_REQUEST  originator, broadcast ID, originator sequence,
+//                  destination sequence (0 if unknown), u8 hop count, 3 reserved
+//   ROUTE_REPLY    target, target sequence, next hop, lifetime ms,
+//                  u8 hop count, 3 reserved
+//   ROUTE_ERROR    unreachable node, its sequence
+//   DATA           originator, next hop, then the application bytes
+//
+// The header source is always the hop that sent the packet, and receivers
+// hold it to the credential its first verified frame carried. The header
+// destination of a ROUTE_REPLY is the originator of the request, of DATA
+// its final destination. Requests and replies with hop count 0 must come
+// from their originator and target respectively. NodeIds are the
+// process-wide interned IDs, which every node in a simulation shares.
+//
+// Delta beacons are HELLOs with FLAG_DELTA_BEACON set and a short layout of
+// their own, relative to the full beacon with sequence base:
+//
+//   offset  size  field
+//        0     4  version, type (HELLO), ttl, flags
+//        4     4  source NodeId
+//        8     4  sequence
+//       12     4  base sequence
+//       16     2  u16 ms since the base's timestamp
+//       18     6  i16 x, y, z change since the base, centimeters
+//       24     2  u16 speed, cm/s
+//       26     2  u16 direction, hundredths of a degree
+//
+// They are not full messages: MessageView::parse rejects them.
+constexpr uint8_t WIRE_VERSION = 1;
+constexpr size_t HEADER_SIZE = 36;
+constexpr size_t BEACON_BODY_SIZE = 8;
+constexpr size_t BEACON_SIZE = HEADER_SIZE + BEACON_BODY_SIZE;
+constexpr size_t ROUTE_REQUEST_SIZE = HEADER_SIZE + 20;
+constexpr size_t ROUTE_REPLY_SIZE = HEADER_SIZE + 20;
+constexpr size_t ROUTE_ERROR_SIZE = HEADER_SIZE + 8;
+constexpr size_t DATA_HEADER_SIZE = HEADER_SIZE + 8;
+constexpr size_t DELTA_BEACON_SIZE = 28;
+constexpr uint8_t FLAG_DELTA_BEACON = 0x01;
+constexpr NodeId BROADCAST_NODE = INVALID_NODE;
+
+struct MessageHeader {
+    MessageType type;
+    uint8_t ttl;
+    NodeId source;
+    NodeId destination;
+    uint32_t sequence;
+    uint64_t timestamp;
+    float x;
+    float y;
+    float z;
+};
+
+struct RouteRequest {
+    NodeId originator;
+    uint32_t broadcastId;
+    uint32_t originatorSequence;
+    uint32_t destinationSequence;
+    uint8_t hopCount;
+};
+
+struct RouteReply {
+    NodeId target;
+    uint32_t targetSequence;
+    NodeId nextHop;      // the only node that acts on the reply
+    uint32_t lifetimeMs;
+    uint8_t hopCount;
+};
+
+struct RouteError {
+    NodeId unreachable;
+    uint32_t sequence;
+};
+
+struct DataHop {
+    NodeId originator;
+    NodeId nextHop;      // the only node that relays the packet
+};
+
+struct DeltaBeacon {
+    NodeId source;
+    uint32_t sequence;
+    uint32_t baseSequence;
+    uint32_t elapsedMs;     // since the base
+    double dx, dy, dz;      // meters since the base
+    double speed;           // m/s
+    double direction;       // degrees, [0, 360)
+};
+
+// Encoders write into caller-provided buffers and return the number of
+// bytes written, or 0 if the buffer is too small or the type does not match
+size_t encodeHeader(const MessageHeader& header, uint8_t* out, size_t capacity);
+size_t encodeBeacon(const MessageHeader& header, float speed, float direction,
+                    uint8_t* out, size_t capacity);
+size_t encodeRouteRequest(const MessageHeader& header, const RouteRequest& request,
+                          uint8_t* out, size_t capacity);
+size_t encodeRouteReply(const MessageHeader& header, const RouteReply& reply,
+                        uint8_t* out, size_t capacity);
+size_t encodeRouteError(const MessageHeader& header, const RouteError& error,
+                        uint8_t* out, size_t capacity);
+// Header and hop fields only; the application bytes go right after them
+size_t encodeDataHeader(const MessageHeader& header, const DataHop& hop,
+                        uint8_t* out, size_t capacity);
+// Also 0 if a field does not fit its quantized range; send a full beacon then
+size_t encodeDeltaBeacon(const DeltaBeacon& beacon, uint8_t* out, size_t capacity);
+bool decodeDeltaBeacon(crypto::ByteView bytes, DeltaBeacon& out);
+
+inline void storeLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void storeLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline uint32_t loadLE32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+inline uint64_t loadLE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+inline void storeFloatLE(uint8_t* p, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    storeLE32(p, bits);
+}
+
+inline float loadFloatLE(const uint8_t* p) {
+    uint32_t bits = loadLE32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+inline bool isDeltaBeacon(crypto::ByteView bytes) {
+    return bytes.size() >= 4 && bytes[0] == WIRE_VERSION &&
+           bytes[1] == static_cast<uint8_t>(MessageType::HELLO) && (bytes[3] & FLAG_DELTA_BEACON);
+}
+
+// Read-only view of an encoded routing message. Accessors decode straight
+// from the packet bytes, which must outlive the view; nothing is copied.
+class MessageView {
+public:
+    MessageView() = default;
+
+    // Validates version, type and length; false leaves the view invalid
+    bool parse(crypto::ByteView bytes);
+    bool valid() const { return !bytes.empty(); }
+
+    uint8_t version() const { return bytes[0]; }
+    MessageType type() const { return static_cast<MessageType>(bytes[1]); }
+    uint8_t ttl() const { return bytes[2]; }
+    NodeId source() const { return loadLE32(bytes.data() + 4); }
+    NodeId destination() const { return loadLE32(bytes.data() + 8); }
+    uint32_t sequence() const { return loadLE32(bytes.data() + 12); }
+    uint64_t timestamp() const { return loadLE64(bytes.data() + 16); }
+    Position position() const;
+
+    crypto::ByteView payload() const { return bytes.subview(HEADER_SIZE, bytes.size() - HEADER_SIZE); }
+    crypto::ByteView raw() const { return bytes; }
+
+    // HELLO body; only meaningful when isBeacon()
+    bool isBeacon() const;
+    float speed() const { return loadFloatLE(bytes.data() + HEADER_SIZE); }
+    float direction() const { return loadFloatLE(bytes.data() + HEADER_SIZE + 4); }
+
+    // Route discovery bodies; false if the message is not one or is too short
+    bool routeRequest(RouteRequest& out) const;
+    bool routeReply(RouteReply& out) const;
+    bool routeError(RouteError& out) const;
+    // DATA hop fields and application bytes; false/empty if not DATA or too short
+    bool dataHop(DataHop& out) const;
+    crypto::ByteView dataBody() const;
+
+private:
+    crypto::ByteView bytes;
+};
+
+} // namespace routing
+} // namespace vanet
+
+#endif // VANET_WIRE_FORMAT_H
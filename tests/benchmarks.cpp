@@ -0,0 +1,625 @@
+#include "../src/crypto/crypto-module.h"
+#include "../src/routing/secure-routing.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+
+using namespace vanet;
+
+namespace {
+
+crypto::CryptoModule::SecureMessage makeMessage(uint32_t sender, uint32_t sequence) {
+    crypto::CryptoModule::SecureMessage msg;
+    std::string id = "vehicle_" + std::to_string(sender);
+    msg.senderCert.assign(id.begin(), id.end());
+    msg.sequenceNumber = sequence;
+    msg.timestamp = 0;
+    return msg;
+}
+
+const char* hashName(crypto::HashAlgorithm algo) {
+    switch (algo) {
+        case crypto::HashAlgorithm::SHA256: return "SHA256";
+        case crypto::HashAlgorithm::MD5: return "MD5";
+        case crypto::HashAlgorithm::SHA1: return "SHA1";
+        case crypto::HashAlgorithm::BLAKE2B: return "BLAKE2B";
+        case crypto::HashAlgorithm::SHA3_256: return "SHA3_256";
+    }
+    return "?";
+}
+
+const char* signatureName(crypto::SignatureAlgorithm algo) {
+    switch (algo) {
+        case crypto::SignatureAlgorithm::RSA_PSS: return "RSA_PSS";
+        case crypto::SignatureAlgorithm::ECDSA: return "ECDSA";
+        case crypto::SignatureAlgorithm::ECDSA_P256: return "ECDSA_P256";
+        case crypto::SignatureAlgorithm::ED25519: return "ED25519";
+    }
+    return "?";
+}
+
+} // namespace
+
+// Digest of a beacon-sized and a 1 KiB payload per hash algorithm
+static void BM_HashMessage(benchmark::State& state) {
+    auto algo = static_cast<crypto::HashAlgorithm>(state.range(0));
+    crypto::CryptoModule crypto;
+    std::vector<uint8_t> message(static_cast<size_t>(state.range(1)), 0x5a);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(crypto.hashMessage(message, algo));
+    }
+    state.SetLabel(hashName(algo));
+    state.SetBytesProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_HashMessage)->ArgsProduct({{0, 1, 2, 3, 4}, {routing::BEACON_SIZE, 1024}});
+
+static void BM_SignMessage(benchmark::State& state) {
+    auto algo = static_cast<crypto::SignatureAlgorithm>(state.range(0));
+    crypto::CryptoModule crypto;
+    crypto.generateKeyPair(algo);
+    std::vector<uint8_t> message(routing::BEACON_SIZE, 0x5a);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(crypto.signMessage(message));
+    }
+    state.SetLabel(signatureName(algo));
+}
+BENCHMARK(BM_SignMessage)->DenseRange(0, 3);
+
+// Online half of an offline/online ECDSA signature: the nonce pool is
+// refilled outside the timed region, as it would be between beacons
+static void BM_SignPresigned(benchmark::State& state) {
+    auto algo = static_cast<crypto::SignatureAlgorithm>(state.range(0));
+    crypto::CryptoModule crypto;
+    crypto.generateKeyPair(algo);
+    crypto.enablePresigning(64);
+    std::vector<uint8_t> message(routing::BEACON_SIZE, 0x5a);
+    for (auto _ : state) {
+        if (crypto.getSigningPoolStats().depth == 0) {
+            state.PauseTiming();
+            crypto.refillSigningPool();
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(crypto.signMessage(message));
+    }
+    auto stats = crypto.getSigningPoolStats();
+    state.counters["misses"] = static_cast<double>(stats.misses);
+    state.counters["refill_ns"] = stats.precomputed ? static_cast<double>(stats.refillNanos) / stats.precomputed : 0.0;
+    state.SetLabel(signatureName(algo));
+}
+BENCHMARK(BM_SignPresigned)->DenseRange(1, 2);
+
+// Receive side: the sender's key is parsed once and then served from the
+// key cache, as for a neighbor heard repeatedly
+static void BM_VerifySignature(benchmark::State& state) {
+    auto algo = static_cast<crypto::SignatureAlgorithm>(state.range(0));
+    crypto::CryptoModule sender;
+    sender.generateKeyPair(algo);
+    std::vector<uint8_t> message(routing::BEACON_SIZE, 0x5a);
+    auto signature = sender.signMessage(message);
+    auto packaged = sender.createSecureMessage(message);
+    std::vector<uint8_t> publicKey(packaged.senderCert.begin(), packaged.senderCert.end());
+
+    crypto::CryptoModule receiver;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(receiver.verifySignature(message, signature, publicKey));
+    }
+    state.SetLabel(signatureName(algo));
+}
+BENCHMARK(BM_VerifySignature)->DenseRange(0, 3);
+
+// Replay lookup after `history` messages have been recorded from a fixed set
+// of 256 senders; cost should not depend on the history size
+static void BM_IsReplayMessage(benchmark::State& state) {
+    crypto::CryptoModule crypto;
+    const uint32_t senders = 256;
+    const uint32_t history = static_cast<uint32_t>(state.range(0));
+    for (uint32_t i = 0; i < history; ++i) {
+        crypto.updateMessageHistory(makeMessage(i % senders, i / senders + 1));
+    }
+
+    auto probe = makeMessage(senders / 2, history / senders + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(crypto.isReplayMessage(probe));
+    }
+}
+BENCHMARK(BM_IsReplayMessage)->RangeMultiplier(10)->Range(100, 100000);
+
+static void BM_UpdateMessageHistory(benchmark::State& state) {
+    crypto::CryptoModule crypto;
+    const uint32_t senders = static_cast<uint32_t>(state.range(0));
+    std::vector<crypto::CryptoModule::SecureMessage> messages;
+    for (uint32_t i = 0; i < senders; ++i) {
+        messages.push_back(makeMessage(i, 0));
+    }
+
+    uint32_t i = 0;
+    for (auto _ : state) {
+        auto& msg = messages[i % senders];
+        ++msg.sequenceNumber;
+        crypto.updateMessageHistory(msg);
+        ++i;
+    }
+}
+BENCHMARK(BM_UpdateMessageHistory)->RangeMultiplier(10)->Range(10, 1000);
+
+// Neighbor lookup: the string-keyed std::map the routing tables used to be,
+// against NodeTable behind interned IDs
+static void BM_StringMapLookup(benchmark::State& state) {
+    std::map<std::string, double> table;
+    const int neighbors = static_cast<int>(state.range(0));
+    for (int i = 0; i < neighbors; ++i) {
+        table["vehicle_" + std::to_string(i)] = 1.0;
+    }
+
+    std::string probe = "vehicle_" + std::to_string(neighbors / 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.find(probe));
+    }
+}
+BENCHMARK(BM_StringMapLookup)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_NodeTableLookup(benchmark::State& state) {
+    auto& registry = routing::NodeRegistry::instance();
+    routing::NodeTable table;
+    const int neighbors = static_cast<int>(state.range(0));
+    for (int i = 0; i < neighbors; ++i) {
+        uint32_t row = table.insert(registry.intern("vehicle_" + std::to_string(i)));
+        table.trustScore[row] = 1.0;
+        table.setField(row, routing::NodeTable::TRUST);
+    }
+
+    routing::NodeId probe = registry.find("vehicle_" + std::to_string(neighbors / 2));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.find(probe));
+    }
+}
+BENCHMARK(BM_NodeTableLookup)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_CalculateTrust(benchmark::State& state) {
+    routing::SecureRoutingProtocol router("bench_vehicle");
+    const int neighbors = static_cast<int>(state.range(0));
+    for (int i = 0; i < neighbors; ++i) {
+        router.updateTrustScore("vehicle_" + std::to_string(i), 1.0);
+    }
+
+    std::string probe = "vehicle_" + std::to_string(neighbors / 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(router.calculateTrust(probe));
+    }
+}
+BENCHMARK(BM_CalculateTrust)->RangeMultiplier(10)->Range(10, 10000);
+
+// Overhearing a DATA relay on the cheap path from a trusted neighbor that
+// we hand no packets to (0), the common case, and from our next hop towards
+// the packet's destination (1), where the relay is matched against our
+// route and counted for black-hole detection. Against BM_SendData, the
+// detection cost per packet routed is the difference between the two.
+static void BM_OverheardData(benchmark::State& state) {
+    crypto::ManualClock clock(std::chrono::system_clock::time_point(std::chrono::hours(24 * 20000)));
+    routing::SecureRoutingProtocol router("bench_vehicle");
+    router.setClock(clock);
+    routing::VehicleInfo info;
+    info.id = "bench_vehicle";
+    router.initializeVehicle(info);
+    for (int i = 0; i < 20; ++i) {
+        router.updateTrustScore("bench_relay", 1.0);
+    }
+    router.updateRoute("bench_far", routing::RouteEntry{"bench_relay", 2, clock.now(), 1.0});
+    const bool handedOff = state.range(0) != 0;
+    if (handedOff) {
+        router.sendData("bench_far", std::vector<uint8_t>(64, 0x5a));
+    }
+    
+    auto& registry = routing::NodeRegistry::instance();
+    routing::MessageHeader header{routing::MessageType::DATA, 9, registry.find("bench_relay"),
+                                  registry.find("bench_far"), 0, 0, 0.0f, 0.0f, 0.0f};
+    routing::DataHop hop{registry.intern("bench_origin"), registry.intern("bench_next")};
+    uint8_t packet[routing::DATA_HEADER_SIZE + 64] = {};
+    // Relays from a trusted neighbor only get the cheap checks, so the
+    // security fields are left empty
+    crypto::CryptoModule::SecureMessageView secure;
+    secure.payload = crypto::ByteView(packet, sizeof(packet));
+    std::vector<uint8_t> frame(routing::secureFrameSize(secure));
+    uint32_t sequence = 0;
+    for (auto _ : state) {
+        header.sequence = ++sequence;
+        header.timestamp = clock.nowMillis();
+        routing::encodeDataHeader(header, hop, packet, sizeof(packet));
+        routing::encodeSecureFrame(secure, frame.data(), frame.size());
+        benchmark::DoNotOptimize(router.receiveMessage(crypto::ByteView(frame)));
+    }
+    state.counters["suspect"] = router.detectBlackHole("bench_relay");
+}
+BENCHMARK(BM_OverheardData)->Arg(0)->Arg(1);
+
+// Originating a 64-byte DATA packet through a trusted next hop, signing included
+static void BM_SendData(benchmark::State& state) {
+    routing::SecureRoutingProtocol router("bench_vehicle");
+    routing::VehicleInfo info;
+    info.id = "bench_vehicle";
+    router.initializeVehicle(info);
+    for (int i = 0; i < 20; ++i) {
+        router.updateTrustScore("bench_relay", 1.0);
+    }
+    std::vector<uint8_t> payload(64, 0x5a);
+    for (auto _ : state) {
+        // Refreshed so the route neither expires nor the relay's verdict matters
+        router.updateRoute("bench_far", routing::RouteEntry{"bench_relay", 2, std::chrono::system_clock::now(), 1.0});
+        benchmark::DoNotOptimize(router.sendData("bench_far", payload));
+    }
+}
+BENCHMARK(BM_SendData);
+
+// One expiry pass per mobility update with `entries` live neighbors, a tenth
+// of which time out; cost should follow the expired count, not the table size
+static void BM_TimerWheelAdvance(benchmark::State& state) {
+    const int entries = static_cast<int>(state.range(0));
+    uint64_t now = 0;
+    routing::TimerWheel wheel(100);
+    wheel.start(now);
+    for (int i = 0; i < entries; ++i) {
+        wheel.schedule(i, now + 10000 + (i % 10) * 1000);
+    }
+
+    for (auto _ : state) {
+        now += 1000;
+        wheel.advance(now, [&](uint64_t expired) {
+            wheel.schedule(expired, now + 10000);
+        });
+        benchmark::DoNotOptimize(wheel.size());
+    }
+    state.SetItemsProcessed(state.iterations() * (entries / 10));
+}
+BENCHMARK(BM_TimerWheelAdvance)->RangeMultiplier(10)->Range(100, 100000);
+
+// The same through the protocol: `entries` routes with timestamps spread
+// over 61 s, one mobility update per simulated second. Each update expires
+// one second's worth of routes, which are then re-learned untimed.
+static void BM_PruneExpiredEntries(benchmark::State& state) {
+    constexpr int buckets = 61;
+    const int entries = static_cast<int>(state.range(0));
+    routing::SecureRoutingProtocol router("bench_vehicle");
+    auto base = std::chrono::system_clock::now();
+    routing::VehicleInfo info{"bench_vehicle", {0.0, 0.0, 0.0, base}, 0.0, 0.0, 1.0, {}};
+    router.initializeVehicle(info);
+
+    std::vector<std::string> destinations;
+    for (int i = 0; i < entries; ++i) {
+        destinations.push_back("route_" + std::to_string(i));
+        router.updateRoute(destinations.back(),
+                           {"bench_hop", 1, base + std::chrono::seconds(i % buckets), 1.0});
+    }
+
+    int64_t second = buckets;
+    for (auto _ : state) {
+        auto now = base + std::chrono::seconds(second);
+        benchmark::DoNotOptimize(router.updatePosition({0.0, 0.0, 0.0, now}));
+
+        state.PauseTiming();
+        for (int i = static_cast<int>((second - buckets) % buckets); i < entries; i += buckets) {
+            router.updateRoute(destinations[i], {"bench_hop", 1, now, 1.0});
+        }
+        ++second;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * (entries / buckets));
+}
+BENCHMARK(BM_PruneExpiredEntries)->RangeMultiplier(10)->Range(100, 100000);
+
+// One flood copy per call, a quarter of them duplicates, with the cache
+// evicting at its capacity
+static void BM_DuplicateCacheInsert(benchmark::State& state) {
+    routing::DuplicateCache cache(static_cast<size_t>(state.range(0)), 1000000);
+    uint32_t id = 0;
+    for (auto _ : state) {
+        uint32_t broadcastId = (id & 3) == 3 ? id - 1 : id;
+        benchmark::DoNotOptimize(cache.insert(broadcastId % 97, broadcastId, id / 64));
+        ++id;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DuplicateCacheInsert)->Arg(64)->Arg(1024)->Arg(16384);
+
+// Sybil-style sweep: one 1 m radius query per neighbor, against `neighbors`
+// vehicles spread over a 1 km square
+static void BM_SpatialGridSweep(benchmark::State& state) {
+    const int neighbors = static_cast<int>(state.range(0));
+    routing::SpatialGrid grid(50.0);
+    std::vector<routing::Position> positions;
+    auto now = std::chrono::system_clock::now();
+    uint32_t seed = 12345;
+    for (int i = 0; i < neighbors; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        double x = (seed >> 8) % 1000;
+        seed = seed * 1664525u + 1013904223u;
+        double y = (seed >> 8) % 1000;
+        positions.push_back({x, y, 0.0, now});
+        grid.update(i, positions.back());
+    }
+
+    std::vector<routing::NodeId> found;
+    for (auto _ : state) {
+        for (const auto& position : positions) {
+            found.clear();
+            grid.queryRadius(position, 1.0, found);
+        }
+        benchmark::DoNotOptimize(found.data());
+    }
+    state.SetItemsProcessed(state.iterations() * neighbors);
+}
+BENCHMARK(BM_SpatialGridSweep)->RangeMultiplier(10)->Range(100, 10000);
+
+// Plausibility sweep over `neighbors` consecutive beacon pairs: the scalar
+// per-neighbor rule on AoS positions (as isValidMovement) against the batch
+// kernel on SoA columns
+namespace {
+
+struct MovementFixture {
+    std::vector<routing::Position> from;
+    std::vector<routing::Position> to;
+    routing::PositionColumns fromColumns;
+    routing::PositionColumns toColumns;
+
+    explicit MovementFixture(int neighbors) {
+        auto base = std::chrono::system_clock::now();
+        uint32_t seed = 12345;
+        auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) % 1000; };
+        for (int i = 0; i < neighbors; ++i) {
+            routing::Position a{next() * 1.0, next() * 1.0, 0.0, base};
+            routing::Position b{a.x + next() * 0.1, a.y + next() * 0.1, 0.0,
+                                base + std::chrono::milliseconds(1000 + next() * 5)};
+            from.push_back(a);
+            to.push_back(b);
+            fromColumns.push_back(a);
+            toColumns.push_back(b);
+        }
+    }
+};
+
+bool scalarPlausible(const routing::Position& oldPos, const routing::Position& newPos) {
+    double timeElapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        newPos.timestamp - oldPos.timestamp).count();
+    if (timeElapsed <= 0) {
+        return false;
+    }
+    double dx = oldPos.x - newPos.x;
+    double dy = oldPos.y - newPos.y;
+    double dz = oldPos.z - newPos.z;
+    double speed = std::sqrt(dx * dx + dy * dy + dz * dz) / timeElapsed * 3.6;
+    return speed <= 200.0 && speed / timeElapsed <= 10.0;
+}
+
+} // namespace
+
+static void BM_MovementCheckScalar(benchmark::State& state) {
+    MovementFixture fixture(static_cast<int>(state.range(0)));
+    std::vector<uint8_t> implausible(fixture.from.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < fixture.from.size(); ++i) {
+            implausible[i] = !scalarPlausible(fixture.from[i], fixture.to[i]);
+        }
+        benchmark::DoNotOptimize(implausible.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MovementCheckScalar)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_ValidateMovementsBatch(benchmark::State& state) {
+    MovementFixture fixture(static_cast<int>(state.range(0)));
+    std::vector<uint8_t> implausible(fixture.from.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(routing::validateMovementsBatch(
+            fixture.fromColumns, fixture.toColumns, {200.0, 10.0}, implausible.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ValidateMovementsBatch)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_EncodeBeacon(benchmark::State& state) {
+    routing::MessageHeader header{routing::MessageType::HELLO, 1, 7, routing::BROADCAST_NODE,
+                                  0, 1700000000000ULL, 10.0f, 20.0f, 0.0f};
+    uint8_t buffer[routing::BEACON_SIZE];
+    for (auto _ : state) {
+        ++header.sequence;
+        benchmark::DoNotOptimize(routing::encodeBeacon(header, 13.9f, 90.0f, buffer, sizeof(buffer)));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_EncodeBeacon);
+
+static void BM_ParseBeacon(benchmark::State& state) {
+    routing::MessageHeader header{routing::MessageType::HELLO, 1, 7, routing::BROADCAST_NODE,
+                                  42, 1700000000000ULL, 10.0f, 20.0f, 0.0f};
+    uint8_t buffer[routing::BEACON_SIZE];
+    size_t length = routing::encodeBeacon(header, 13.9f, 90.0f, buffer, sizeof(buffer));
+    for (auto _ : state) {
+        routing::MessageView view;
+        view.parse(crypto::ByteView(buffer, length));
+        benchmark::DoNotOptimize(view.source() + view.sequence() + view.timestamp());
+        benchmark::DoNotOptimize(view.position());
+    }
+}
+BENCHMARK(BM_ParseBeacon);
+
+// Recording into mapped segments, rotation included
+static void BM_TraceRecord(benchmark::State& state) {
+    routing::TraceSink sink("bench-trace", 1 << 16, 2);
+    routing::TraceRecord record{0, 7, 9, 0, 10.0f, 20.0f, routing::BEACON_SIZE,
+                                routing::TraceEvent::SEND, 0, routing::TraceReason::NONE};
+    for (auto _ : state) {
+        ++record.timeNs;
+        ++record.sequence;
+        sink.record(record);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["segments"] = sink.segments();
+    sink.close();
+    for (uint32_t i = 0; i < sink.segments(); ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "bench-trace-%06u.vtr", i);
+        std::remove(name);
+    }
+}
+BENCHMARK(BM_TraceRecord);
+
+// Packaging a beacon-sized payload from the default heap (0) or from an
+// arena reset per packet (1)
+static void BM_CreateSecureMessage(benchmark::State& state) {
+    crypto::CryptoModule crypto;
+    crypto.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256);
+    std::vector<uint8_t> payload(routing::BEACON_SIZE, 0x5a);
+    crypto::MessageArena arena;
+    const bool useArena = state.range(0) != 0;
+
+    for (auto _ : state) {
+        arena.reset();
+        auto msg = useArena ? crypto.createSecureMessage(crypto::ByteView(payload), &arena)
+                            : crypto.createSecureMessage(crypto::ByteView(payload));
+        benchmark::DoNotOptimize(msg.signature.data());
+    }
+    state.counters["heap_blocks"] = static_cast<double>(arena.stats().upstreamAllocations);
+}
+BENCHMARK(BM_CreateSecureMessage)->Arg(0)->Arg(1);
+
+// Beacon authentication between neighbors with an open session: tagging
+// (0) and checking (1) a beacon, against BM_CreateSecureMessage and
+// BM_VerifySecureMessage for the signed path
+static void BM_SessionMessage(benchmark::State& state) {
+    crypto::CryptoModule sender;
+    crypto::CryptoModule receiver;
+    sender.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256);
+    receiver.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256);
+    sender.enableSessions(true);
+    receiver.enableSessions(true);
+    receiver.verifySecureMessage(sender.createSecureMessage(std::vector<uint8_t>{'h'}));
+    sender.verifySecureMessage(receiver.createSecureMessage(std::vector<uint8_t>{'h'}));
+
+    std::vector<uint8_t> payload(routing::BEACON_SIZE, 0x5a);
+    crypto::MessageArena arena;
+    auto msg = sender.createSessionMessage(crypto::ByteView(payload), &arena);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            arena.reset();
+            auto tagged = sender.createSessionMessage(crypto::ByteView(payload), &arena);
+            benchmark::DoNotOptimize(tagged.sessionTags.data());
+        } else {
+            benchmark::DoNotOptimize(receiver.verifySecureMessage(msg));
+        }
+    }
+    state.counters["signed"] = static_cast<double>(sender.getSessionStats().reauthenticated);
+}
+BENCHMARK(BM_SessionMessage)->Arg(0)->Arg(1);
+
+// Ten simulated seconds of beaconing among vehicles that all hear each
+// other: signed beacons at a fixed 10 Hz (0) against the adaptive rate
+// with delta beacons in between (1). Counters give the channel busy ratio
+// and what each vehicle sends and has to verify per second.
+static void BM_BeaconChannelLoad(benchmark::State& state) {
+    const bool adaptive = state.range(0) != 0;
+    const size_t vehicles = static_cast<size_t>(state.range(1));
+    constexpr uint64_t startMs = 1000, durationMs = 10000, tickMs = 100;
+
+    crypto::CryptoModule crypto;
+    crypto.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256);
+    std::vector<uint8_t> payload(routing::BEACON_SIZE, 0x5a);
+    const size_t fullSize = crypto::CryptoModule::SecureMessageView(
+        crypto.createSecureMessage(crypto::ByteView(payload))).wireSize();
+
+    double load = 0;
+    uint64_t bytes = 0, verifies = 0, ticks = 0;
+    for (auto _ : state) {
+        std::vector<routing::BeaconController> controllers(vehicles);
+        std::vector<routing::VehicleInfo> info(vehicles);
+        for (size_t i = 0; i < vehicles; ++i) {
+            info[i].position = {i * 7.0, (i % 4) * 3.5, 0.0, {}};
+            info[i].speed = 10.0 + i % 25;
+            info[i].direction = 90.0;
+        }
+
+        load = 0;
+        bytes = verifies = ticks = 0;
+        for (uint64_t now = startMs; now < startMs + durationMs; now += tickMs) {
+            for (size_t i = 0; i < vehicles; ++i) {
+                info[i].position.x += info[i].speed * tickMs / 1000.0;
+                auto kind = adaptive ? controllers[i].due(now, info[i]) : routing::BeaconKind::FULL;
+                if (kind == routing::BeaconKind::NONE) {
+                    continue;
+                }
+                size_t size = kind == routing::BeaconKind::FULL ? fullSize : routing::DELTA_BEACON_SIZE;
+                controllers[i].sent(now, kind, info[i], size);
+                bytes += size;
+                if (kind == routing::BeaconKind::FULL) {
+                    verifies += vehicles - 1;
+                }
+                for (size_t j = 0; j < vehicles; ++j) {
+                    if (j != i) {
+                        controllers[j].heard(now, size);
+                    }
+                }
+            }
+            load += controllers[0].channelLoad();
+            ++ticks;
+        }
+        benchmark::DoNotOptimize(load);
+    }
+
+    double vehicleSeconds = vehicles * durationMs / 1000.0;
+    state.counters["cbr"] = load / ticks;
+    state.counters["bytes/s"] = bytes / vehicleSeconds;
+    state.counters["verifies/s"] = verifies / vehicleSeconds;
+}
+BENCHMARK(BM_BeaconChannelLoad)->ArgsProduct({{0, 1}, {20, 100, 200}})->Unit(benchmark::kMillisecond);
+
+// Full receive-side check of a signed beacon: timestamp, replay window
+// lookup and signature, per signature algorithm. The message is re-signed
+// untimed now and then so it never ages past the acceptance window.
+static void BM_VerifySecureMessage(benchmark::State& state) {
+    auto algo = static_cast<crypto::SignatureAlgorithm>(state.range(0));
+    crypto::CryptoModule sender;
+    sender.generateKeyPair(algo);
+    std::vector<uint8_t> payload(routing::BEACON_SIZE, 0x5a);
+    auto msg = sender.createSecureMessage(crypto::ByteView(payload));
+
+    crypto::CryptoModule receiver;
+    size_t accepted = 0;
+    for (auto _ : state) {
+        if ((state.iterations() & 1023) == 1023) {
+            state.PauseTiming();
+            msg = sender.createSecureMessage(crypto::ByteView(payload));
+            state.ResumeTiming();
+        }
+        accepted += receiver.verifySecureMessage(msg);
+    }
+    benchmark::DoNotOptimize(accepted);
+    state.counters["accepted"] = benchmark::Counter(static_cast<double>(accepted),
+                                                    benchmark::Counter::kAvgIterations);
+    state.SetLabel(signatureName(algo));
+}
+BENCHMARK(BM_VerifySecureMessage)->DenseRange(0, 3);
+
+// Throughput of batches of 256 beacon signatures on `workers` threads
+// (0 signs inline on the calling thread)
+static void BM_CryptoEngineSign(benchmark::State& state) {
+    crypto::CryptoModule crypto;
+    crypto.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256);
+    crypto::CryptoEngine engine(static_cast<size_t>(state.range(0)));
+    std::vector<uint8_t> payload(routing::BEACON_SIZE, 0x5a);
+    size_t signedCount = 0;
+
+    for (auto _ : state) {
+        for (int i = 0; i < 256; ++i) {
+            crypto.createSecureMessageAsync(crypto::ByteView(payload), engine,
+                [&](bool ok, const crypto::CryptoModule::SecureMessageView&) { signedCount += ok; });
+        }
+        engine.drain();
+    }
+    benchmark::DoNotOptimize(signedCount);
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+BENCHMARK(BM_CryptoEngineSign)->Arg(0)->Arg(2)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -1,8 +1,14 @@
+#include "../src/crypto/key-provisioning.h"
 #include "../src/routing/secure-routing.h"
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <thread>
+#include <openssl/x509v3.h>
 
 using namespace vanet;
 using namespace std::chrono;
@@ -25,6 +31,84 @@ void testCryptoModule() {
     // Create and verify secure message
     auto secureMsg = crypto.createSecureMessage(message);
     assert(crypto.verifySecureMessage(secureMsg));
+    
+    // Batch verification flags only the tampered message
+    std::vector<crypto::CryptoModule::SecureMessage> batch;
+    for (int i = 0; i < 4; ++i) {
+        batch.push_back(crypto.createSecureMessage(message));
+    }
+    batch[2].payload[0] ^= 0xFF;
+    auto verdicts = crypto.verifySecureMessageBatch(batch);
+    assert(verdicts.size() == batch.size());
+    assert(verdicts[0] && verdicts[1] && !verdicts[2] && verdicts[3]);
+    
+    // Repeated credentials are served from the key cache
+    auto before = crypto.getKeyCacheStats();
+    assert(crypto.verifySecureMessage(crypto.createSecureMessage(message)));
+    assert(crypto.getKeyCacheStats().hits == before.hits + 1);
+    assert(crypto.getKeyCacheStats().misses == before.misses);
+    
+    // Replay window is per sender and tracks out-of-order sequence numbers
+    auto first = crypto.createSecureMessage(message);
+    auto second = crypto.createSecureMessage(message);
+    assert(!crypto.isReplayMessage(second));
+    crypto.updateMessageHistory(second);
+    assert(crypto.isReplayMessage(second));
+    assert(!crypto.isReplayMessage(first));
+    crypto.updateMessageHistory(first);
+    assert(crypto.isReplayMessage(first));
+    assert(!crypto.verifySecureMessage(first));
+    
+    // Signatures made and checked are counted
+    crypto::CryptoModule counted;
+    assert(counted.generateKeyPair());
+    assert(counted.verifySecureMessage(counted.createSecureMessage(message)));
+    assert(counted.getOperationStats().signatures == 1 && counted.getOperationStats().verifications == 1);
+}
+
+void testSignatureBackends() {
+    // Every algorithm round-trips through CryptoModule
+    for (auto algo : {crypto::SignatureAlgorithm::RSA_PSS, crypto::SignatureAlgorithm::ECDSA,
+                      crypto::SignatureAlgorithm::ECDSA_P256, crypto::SignatureAlgorithm::ED25519}) {
+        crypto::CryptoModule sender;
+        crypto::CryptoModule receiver;
+        assert(sender.generateKeyPair(algo));
+        auto msg = sender.createSecureMessage(std::vector<uint8_t>{'b', 'e', 'a', 'c', 'o', 'n'});
+        assert(receiver.verifySecureMessage(msg));
+        msg.payload[0] ^= 0xFF;
+        assert(!receiver.verifySecureMessage(msg));
+    }
+    
+    // Comparative throughput per backend
+    const int iterations = 200;
+    std::vector<uint8_t> payload(128, 0x5A);
+    crypto::ByteSegments input(payload);
+    for (const auto* backend : crypto::SignatureBackend::available()) {
+        EVP_PKEY* key = backend->generateKey();
+        assert(key);
+        auto signer = backend->makeSigner(key);
+        auto verifier = backend->makeVerifier(key);
+        assert(signer && verifier);
+        
+        std::vector<uint8_t> signature;
+        auto start = steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            assert(signer->sign(input, signature));
+        }
+        auto signTime = duration<double>(steady_clock::now() - start).count();
+        
+        start = steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            assert(verifier->verify(input, signature));
+        }
+        auto verifyTime = duration<double>(steady_clock::now() - start).count();
+        
+        std::cout << "  " << backend->name()
+                  << ": sign " << static_cast<int>(iterations / signTime) << " ops/s"
+                  << ", verify " << static_cast<int>(iterations / verifyTime) << " ops/s"
+                  << std::endl;
+        EVP_PKEY_free(key);
+    }
 }
 
 void testSecureRouting() {
@@ -63,6 +147,1258 @@ void testSecureRouting() {
     assert(!router.isVehicleTrusted("neighbor1"));
 }
 
+void testCryptoEngine() {
+    crypto::CryptoModule sender;
+    crypto::CryptoModule receiver;
+    assert(sender.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+    
+    for (size_t workers : {size_t(0), size_t(3)}) {
+        crypto::CryptoEngine engine(workers, 64);
+        std::vector<crypto::CryptoModule::SecureMessage> signedMessages;
+        std::vector<uint64_t> order;
+        
+        // More jobs than slots exercises backpressure; delivery stays in order
+        const int count = 200;
+        for (int i = 0; i < count; ++i) {
+            std::vector<uint8_t> payload = {'m', static_cast<uint8_t>(i)};
+            uint64_t ticket = sender.createSecureMessageAsync(payload, engine,
+                [&](bool ok, const crypto::CryptoModule::SecureMessageView& msg) {
+                    assert(ok);
+                    crypto::CryptoModule::SecureMessage copy;
+                    copy.payload.assign(msg.payload.begin(), msg.payload.end());
+                    copy.signature.assign(msg.signature.begin(), msg.signature.end());
+                    copy.timestamp = msg.timestamp;
+                    copy.sequenceNumber = msg.sequenceNumber;
+                    copy.senderCert.assign(msg.senderCert.begin(), msg.senderCert.end());
+                    signedMessages.push_back(copy);
+                    order.push_back(msg.payload[1]);
+                });
+            assert(ticket != 0);
+        }
+        engine.drain();
+        assert(signedMessages.size() == count && engine.inFlight() == 0);
+        for (int i = 0; i < count; ++i) {
+            assert(order[i] == static_cast<uint64_t>(i));
+        }
+        
+        // Verify them back on the engine, one of them tampered
+        signedMessages[7].payload[0] ^= 0xFF;
+        std::vector<bool> verdicts;
+        for (const auto& msg : signedMessages) {
+            receiver.verifySecureMessageAsync(msg, engine, [&](bool ok) { verdicts.push_back(ok); });
+        }
+        engine.drain();
+        assert(verdicts.size() == count);
+        for (int i = 0; i < count; ++i) {
+            assert(verdicts[i] == (i != 7));
+        }
+        assert(engine.stats().delivered == engine.stats().submitted);
+        
+        // Sizes reported before delivery never undercount the signed message
+        for (const auto& msg : signedMessages) {
+            size_t wireSize = crypto::CryptoModule::SecureMessageView(msg).wireSize();
+            assert(sender.signedWireSize(msg.payload.size()) >= wireSize);
+            assert(sender.signedWireSize(msg.payload.size()) <= wireSize + 8);
+        }
+    }
+}
+
+void testSigningPool() {
+    for (auto algo : {crypto::SignatureAlgorithm::ECDSA, crypto::SignatureAlgorithm::ECDSA_P256}) {
+        crypto::CryptoModule sender;
+        assert(sender.generateKeyPair(algo));
+        assert(sender.enablePresigning(4));
+        assert(sender.getSigningPoolStats().capacity == 4 && sender.getSigningPoolStats().depth == 0);
+        
+        // Refills stop at the pool capacity
+        assert(sender.refillSigningPool(3) == 3);
+        assert(sender.refillSigningPool() == 1);
+        assert(sender.refillSigningPool() == 0);
+        assert(sender.getSigningPoolStats().depth == 4);
+        
+        // Presigned and inline signatures are ordinary ECDSA; a nonce is never reused
+        crypto::CryptoModule receiver;
+        std::vector<crypto::CryptoModule::SecureMessage> messages;
+        for (int i = 0; i < 6; ++i) {
+            messages.push_back(sender.createSecureMessage(std::vector<uint8_t>{'b', 'e', 'a', 'c', 'o', 'n'}));
+            assert(receiver.verifySecureMessage(messages.back()));
+        }
+        for (size_t i = 1; i < messages.size(); ++i) {
+            assert(messages[i].signature != messages[i - 1].signature);
+        }
+        messages[0].payload[0] ^= 0xFF;
+        assert(!crypto::CryptoModule().verifySecureMessage(messages[0]));
+        
+        auto stats = sender.getSigningPoolStats();
+        assert(stats.depth == 0 && stats.precomputed == 4);
+        assert(stats.consumed == 4 && stats.misses == 2);
+        
+        // Two signatures over the same bytes differ in their nonce
+        std::vector<uint8_t> data(routing::BEACON_SIZE, 0x5a);
+        assert(sender.refillSigningPool() == 4);
+        assert(sender.signMessage(data) != sender.signMessage(data));
+        
+        // The pool is rebuilt, empty, for a new key
+        assert(sender.generateKeyPair(algo));
+        assert(sender.getSigningPoolStats().capacity == 4 && sender.getSigningPoolStats().depth == 0);
+        sender.refillSigningPool();
+        assert(crypto::CryptoModule().verifySecureMessage(sender.createSecureMessage(data)));
+        assert(sender.getSigningPoolStats().consumed == 1);
+    }
+    
+    // Other algorithms sign as before
+    crypto::CryptoModule ed25519;
+    assert(ed25519.generateKeyPair(crypto::SignatureAlgorithm::ED25519));
+    assert(!ed25519.enablePresigning(4));
+    assert(ed25519.refillSigningPool() == 0);
+    assert(crypto::CryptoModule().verifySecureMessage(ed25519.createSecureMessage(std::vector<uint8_t>{'x'})));
+    assert(ed25519.enablePresigning(0));
+}
+
+void testNeighborSessions() {
+    crypto::CryptoModule a;
+    crypto::CryptoModule b;
+    assert(a.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256) && a.enableSessions(true));
+    assert(b.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256) && b.enableSessions(true));
+    std::vector<uint8_t> beacon(routing::BEACON_SIZE, 0x5a);
+    
+    // Without a session everything is signed, and the signed offer opens one
+    auto first = a.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+    assert(!first.signature.empty() && first.sessionTags.empty());
+    assert(first.sessionOffer.size() == crypto::SessionTable::OFFER_SIZE);
+    assert(b.verifySecureMessage(first) && b.openSessions() == 1);
+    assert(a.verifySecureMessage(b.createSecureMessage(crypto::ByteView(beacon))) && a.openSessions() == 1);
+    
+    // Now a tag replaces the signature until re-authentication is due
+    auto tagged = a.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+    assert(tagged.signature.empty() && tagged.senderCert.empty());
+    assert(tagged.sessionTags.size() == crypto::SessionTable::ENTRY_SIZE);
+    assert(b.verifySecureMessage(tagged));
+    assert(b.getSessionStats().tagsVerified == 1 && a.getSessionStats().tagged == 1);
+    
+    // The tag is bound to the message, the pair and the direction
+    auto tampered = tagged;
+    tampered.payload[0] ^= 0xFF;
+    assert(!b.verifySecureMessage(tampered));
+    assert(!a.verifySecureMessage(tagged));
+    crypto::CryptoModule outsider;
+    assert(outsider.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256) && outsider.enableSessions(true));
+    assert(!outsider.verifySecureMessage(tagged));
+    assert(!crypto::CryptoModule().verifySecureMessage(tagged));
+    
+    // Tagged messages count against the sender's replay window
+    b.updateMessageHistory(tagged);
+    assert(!b.verifySecureMessage(tagged));
+    
+    // Attaching a credential does not buy a recorded tag a fresh window
+    auto relabeled = tagged;
+    relabeled.senderCert.assign(16, 0x42);
+    assert(!b.verifySecureMessage(relabeled));
+    relabeled.signature.assign(64, 0x42);
+    assert(!b.verifySecureMessage(relabeled));
+    assert(!b.verifySecureMessageBatch(std::vector<crypto::CryptoModule::SecureMessage>{relabeled})[0]);
+    
+    // Batches take tags too
+    auto batchTagged = a.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+    auto batch = b.verifySecureMessageBatch(std::vector<crypto::CryptoModule::SecureMessage>{batchTagged, tampered});
+    assert(batch[0] && !batch[1]);
+    
+    // A new key drops every session and goes back to signing
+    assert(a.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+    assert(a.openSessions() == 0);
+    auto rekeyed = a.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+    assert(!rekeyed.signature.empty() && rekeyed.sessionTags.empty());
+    assert(b.verifySecureMessage(rekeyed) && b.openSessions() == 2);
+    
+    // Sessions off: plain signed messages, no offer
+    assert(a.enableSessions(false));
+    auto plain = a.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+    assert(!plain.signature.empty() && plain.sessionOffer.empty() && plain.sessionTags.empty());
+    assert(crypto::CryptoModule().verifySecureMessage(plain));
+    
+    // Re-authentications renew the session even though their tags check,
+    // so peers keep on tagging past the first session's lifetime
+    crypto::ManualClock clock(system_clock::now());
+    crypto::CryptoModule c;
+    crypto::CryptoModule d;
+    for (auto* module : {&c, &d}) {
+        assert(module->generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256) && module->enableSessions(true));
+        module->setClock(&clock);
+    }
+    assert(d.verifySecureMessage(c.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource())));
+    assert(c.verifySecureMessage(d.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource())));
+    for (int i = 0; i < 15; ++i) {
+        clock.advance(milliseconds(crypto::CryptoModule::REAUTH_INTERVAL_MS));
+        auto fromC = c.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+        auto fromD = d.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+        assert(!fromC.signature.empty() && !fromC.sessionTags.empty());
+        assert(d.verifySecureMessage(fromC) && c.verifySecureMessage(fromD));
+    }
+    clock.advance(seconds(1));
+    auto late = c.createSessionMessage(crypto::ByteView(beacon), std::pmr::get_default_resource());
+    assert(late.signature.empty() && d.verifySecureMessage(late));
+}
+
+static X509* issueCertificate(const char* name, EVP_PKEY* key, X509* issuer, EVP_PKEY* issuerKey,
+                              bool ca, long fromSeconds, long untilSeconds) {
+    static long serial = 1;
+    X509* cert = X509_new();
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), serial++);
+    X509_gmtime_adj(X509_getm_notBefore(cert), fromSeconds);
+    X509_gmtime_adj(X509_getm_notAfter(cert), untilSeconds);
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>(name), -1, -1, 0);
+    X509_set_issuer_name(cert, issuer ? X509_get_subject_name(issuer) : X509_get_subject_name(cert));
+    X509_set_pubkey(cert, key);
+    if (ca) {
+        X509V3_CTX ctx;
+        X509V3_set_ctx_nodb(&ctx);
+        X509V3_set_ctx(&ctx, issuer ? issuer : cert, cert, nullptr, nullptr, 0);
+        X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &ctx, NID_basic_constraints, "critical,CA:TRUE");
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+    }
+    X509_sign(cert, issuerKey, EVP_sha256());
+    return cert;
+}
+
+static std::vector<uint8_t> derOf(X509* cert) {
+    unsigned char* buf = nullptr;
+    int len = i2d_X509(cert, &buf);
+    std::vector<uint8_t> der(buf, buf + len);
+    OPENSSL_free(buf);
+    return der;
+}
+
+void testCertificateChain() {
+    const long DAY = 86400;
+    const auto* backend = crypto::SignatureBackend::forAlgorithm(crypto::SignatureAlgorithm::ECDSA_P256);
+    EVP_PKEY* rootKey = backend->generateKey();
+    EVP_PKEY* caKey = backend->generateKey();
+    EVP_PKEY* subKey = backend->generateKey();
+    EVP_PKEY* vehicleKey = backend->generateKey();
+    EVP_PKEY* otherKey = backend->generateKey();
+    X509* root = issueCertificate("VANET Root CA", rootKey, nullptr, rootKey, true, -DAY, 365 * DAY);
+    X509* ca = issueCertificate("VANET Enrolment CA", caKey, root, rootKey, true, -DAY, 30 * DAY);
+    X509* leaf = issueCertificate("vehicle_0", vehicleKey, ca, caKey, false, -DAY, DAY);
+    
+    // The sender presents its leaf certificate as the message credential
+    std::vector<uint8_t> identity(4, 0);
+    unsigned char* keyDer = nullptr;
+    int keyLen = i2d_PrivateKey(vehicleKey, &keyDer);
+    identity.insert(identity.end(), keyDer, keyDer + keyLen);
+    OPENSSL_free(keyDer);
+    crypto::CryptoModule sender;
+    assert(sender.importIdentity(identity));
+    std::string certPath = (std::filesystem::temp_directory_path() / "vanet-leaf-test.pem").string();
+    FILE* file = fopen(certPath.c_str(), "wb");
+    PEM_write_X509(file, leaf);
+    fclose(file);
+    assert(sender.loadCertificate(certPath));
+    std::filesystem::remove(certPath);
+    std::vector<uint8_t> payload = {'c', 'e', 'r', 't'};
+    
+    // No anchor, or no path to it, fails closed. Every module here gets a
+    // store of its own, so the process-wide one is left as it was.
+    auto shared = std::make_shared<crypto::TrustStore>(3, 16, 64);
+    crypto::CryptoModule receiver;
+    receiver.setTrustStore(shared);
+    assert(!receiver.verifySecureMessage(sender.createSecureMessage(payload)));
+    assert(receiver.addTrustAnchor(derOf(root)));
+    assert(!receiver.verifySecureMessage(sender.createSecureMessage(payload)));
+    assert(receiver.addIntermediateCertificate(derOf(ca)));
+    assert(receiver.verifySecureMessage(sender.createSecureMessage(payload)));
+    assert(receiver.getTrustStoreStats().chainsBuilt == 3 && receiver.getTrustStoreStats().rejected == 2);
+
+    // Modules share the process-wide store unless given one; anchors are
+    // seen by every module on a store and by no other
+    crypto::CryptoModule defaulted;
+    assert(&defaulted.getTrustStoreStats() == &crypto::CryptoModule::sharedTrustStore()->stats());
+    crypto::CryptoModule peer;
+    peer.setTrustStore(shared);
+    assert(peer.verifySecureMessage(sender.createSecureMessage(payload)));
+    crypto::CryptoModule isolated;
+    isolated.setTrustStore(std::make_shared<crypto::TrustStore>(3, 16, 64));
+    assert(!isolated.verifySecureMessage(sender.createSecureMessage(payload)));
+    crypto::CryptoModule separate;
+    separate.setTrustStore(std::make_shared<crypto::TrustStore>(3, 16, 64));
+    assert(separate.addTrustAnchor(derOf(root)) && separate.addIntermediateCertificate(derOf(ca)));
+    assert(separate.verifySecureMessage(sender.createSecureMessage(payload)));
+    
+    // A bare public key has no chain, so it only passes a store without anchors
+    crypto::CryptoModule bareKey;
+    assert(bareKey.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+    assert(!receiver.verifySecureMessage(bareKey.createSecureMessage(payload)));
+    assert(!separate.verifySecureMessage(bareKey.createSecureMessage(payload)));
+    assert(!isolated.verifySecureMessage(sender.createSecureMessage(payload)) &&
+           isolated.verifySecureMessage(bareKey.createSecureMessage(payload)));
+
+    // Revoking the CA takes its leaves down with it, in every module on the
+    // store, whatever verdicts they had cached; other stores are unaffected
+    receiver.revokeCertificate(derOf(ca));
+    assert(!receiver.verifySecureMessage(sender.createSecureMessage(payload)));
+    assert(!peer.verifySecureMessage(sender.createSecureMessage(payload)));
+    assert(separate.verifySecureMessage(sender.createSecureMessage(payload)));
+    
+    // Validated chains are remembered; siblings only need their own signature checked
+    time_t now = time(nullptr);
+    crypto::TrustStore store(3, 16, 64);
+    assert(store.addTrustAnchor(derOf(root)) && store.addIntermediate(derOf(ca)));
+    assert(store.verify(derOf(leaf), now) && store.stats().chainsBuilt == 1);
+    assert(store.verify(derOf(leaf), now) && store.stats().cacheHits == 1);
+    X509* sibling = issueCertificate("vehicle_1", otherKey, ca, caKey, false, -DAY, DAY);
+    assert(store.verify(derOf(sibling), now));
+    assert(store.stats().issuerShortcuts == 1 && store.stats().chainsBuilt == 1);
+    
+    // Cached results end with the chain's validity
+    assert(!store.verify(derOf(leaf), now + 2 * DAY));
+    
+    // Wrong issuer key, not yet valid, or a chain longer than allowed
+    X509* forged = issueCertificate("vehicle_2", otherKey, ca, otherKey, false, -DAY, DAY);
+    assert(!store.verify(derOf(forged), now));
+    X509* early = issueCertificate("vehicle_3", otherKey, ca, caKey, false, DAY, 2 * DAY);
+    assert(!store.verify(derOf(early), now));
+    X509* sub = issueCertificate("VANET Pseudonym CA", subKey, ca, caKey, true, -DAY, 30 * DAY);
+    X509* deep = issueCertificate("vehicle_4", otherKey, sub, subKey, false, -DAY, DAY);
+    assert(store.addIntermediate(derOf(sub)));
+    assert(!store.verify(derOf(deep), now));
+    crypto::TrustStore deeper(4, 16, 64);
+    assert(deeper.addTrustAnchor(derOf(root)) && deeper.addIntermediate(derOf(ca)) &&
+           deeper.addIntermediate(derOf(sub)));
+    assert(deeper.verify(derOf(deep), now));
+    
+    // Revocation filter: no false negatives, few false positives
+    crypto::RevocationFilter filter(1000, 1e-4);
+    auto fingerprintOf = [](uint32_t i) { return crypto::TrustStore::fingerprint(crypto::ByteView::of(i)); };
+    for (uint32_t i = 0; i < 1000; ++i) {
+        filter.add(fingerprintOf(i));
+    }
+    size_t falsePositives = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        assert(filter.mayContain(fingerprintOf(i)));
+    }
+    for (uint32_t i = 1000; i < 21000; ++i) {
+        falsePositives += filter.mayContain(fingerprintOf(i));
+    }
+    assert(falsePositives < 20);
+    
+    for (X509* cert : {root, ca, leaf, sibling, forged, early, sub, deep}) {
+        X509_free(cert);
+    }
+    for (EVP_PKEY* key : {rootKey, caKey, subKey, vehicleKey, otherKey}) {
+        EVP_PKEY_free(key);
+    }
+}
+
+void testKeyProvisioning() {
+    // Every index is visited exactly once
+    std::vector<int> visits(100, 0);
+    crypto::parallelFor(visits.size(), 4, [&](size_t i) { ++visits[i]; });
+    assert(std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; }));
+    
+    crypto::FleetKeys keys;
+    assert(keys.generate(8, crypto::SignatureAlgorithm::ECDSA, 4) && keys.size() == 8);
+    std::string keyPath = (std::filesystem::temp_directory_path() / "vanet-fleet-test.keys").string();
+    assert(keys.save(keyPath));
+    crypto::FleetKeys loaded;
+    assert(loaded.load(keyPath) && loaded.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        assert(std::equal(keys.identity(i).begin(), keys.identity(i).end(),
+                          loaded.identity(i).begin(), loaded.identity(i).end()));
+    }
+    
+    // Truncated files are rejected whole
+    std::filesystem::resize_file(keyPath, std::filesystem::file_size(keyPath) - 1);
+    assert(!loaded.load(keyPath) && loaded.size() == keys.size());
+    std::filesystem::remove(keyPath);
+    
+    // A provisioned vehicle signs with its own distinct key
+    routing::SecureRoutingProtocol router("vehicle_0");
+    routing::VehicleInfo info;
+    info.id = "vehicle_0";
+    assert(router.initializeVehicle(info, loaded.identity(0)));
+    assert(!router.initializeVehicle(info, crypto::ByteView()));
+    crypto::CryptoModule first, second, verifier;
+    assert(first.importIdentity(keys.identity(0)) && second.importIdentity(keys.identity(1)));
+    std::vector<uint8_t> payload = {'k', 'e', 'y'};
+    auto message = first.createSecureMessage(payload);
+    assert(verifier.verifySecureMessage(message));
+    assert(message.senderCert != second.createSecureMessage(payload).senderCert);
+}
+
+void testMessageArena() {
+    crypto::MessageArena arena(1024);
+    std::pmr::vector<uint8_t> small(100, 1, &arena);
+    std::pmr::vector<uint8_t> large(4096, 2, &arena);  // bigger than a block
+    assert(arena.stats().allocations == 2);
+    assert(arena.upstreamSinceReset() == 2);
+    
+    // After a reset the same working set is served from retained blocks
+    arena.reset();
+    std::pmr::vector<uint8_t> again(100, 3, &arena);
+    std::pmr::vector<uint8_t> againLarge(4096, 4, &arena);
+    assert(arena.allocationsSinceReset() == 2 && arena.upstreamSinceReset() == 0);
+    
+    // Steady-state sends cost a fixed number of arena allocations and no heap blocks
+    routing::SecureRoutingProtocol router("arena_vehicle");
+    routing::VehicleInfo info;
+    info.id = "arena_vehicle";
+    info.position = {0.0, 0.0, 0.0, system_clock::now()};
+    assert(router.initializeVehicle(info));
+    
+    router.sendBeacon();
+    for (int i = 0; i < 10; ++i) {
+        router.sendBeacon();
+        const auto& stats = router.getAllocationStats();
+        assert(stats.lastPacketHeapAllocations == 0);
+        assert(stats.lastPacketAllocations == 3);  // payload, signature, credential
+    }
+    assert(router.getAllocationStats().packets == 11);
+}
+
+void testInstrumentation() {
+    // Small values are exact, larger ones land in a bucket within ~3%
+    using Histogram = crypto::LatencyHistogram;
+    for (uint64_t value : {0ULL, 31ULL, 32ULL, 1000ULL, 123456789ULL}) {
+        size_t bucket = Histogram::bucketOf(value);
+        assert(Histogram::bucketLow(bucket) <= value && value <= Histogram::bucketHigh(bucket));
+        assert(Histogram::bucketHigh(bucket) - Histogram::bucketLow(bucket) <= value / 32);
+    }
+    assert(Histogram::bucketOf(UINT64_MAX) == Histogram::BUCKETS - 1);
+    
+    Histogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+    assert(histogram.count() == 1000 && histogram.min() == 1000 && histogram.max() == 1000000);
+    uint64_t median = histogram.valueAtQuantile(0.5);
+    assert(median >= 500000 && median <= 500000 + 500000 / 32);
+    assert(histogram.valueAtQuantile(1.0) == 1000000);
+    
+    Histogram other;
+    other.record(5);
+    histogram.merge(other);
+    assert(histogram.count() == 1001 && histogram.min() == 5);
+    
+    // The protocol times its own stages and those of its crypto module
+    routing::SecureRoutingProtocol router("instrumented_vehicle");
+    routing::VehicleInfo info;
+    info.id = "instrumented_vehicle";
+    info.position = {0.0, 0.0, 0.0, system_clock::now()};
+    assert(router.initializeVehicle(info));
+    router.sendBeacon();
+    router.calculateTrust("instrumented_vehicle");
+    
+    const auto& recorded = router.getInstrumentation();
+    uint64_t expected = crypto::INSTRUMENTATION_ENABLED ? 1 : 0;
+    assert(recorded.calls(crypto::Stage::SIGN) == expected);
+    assert(recorded.calls(crypto::Stage::TRUST) == expected);
+}
+
+void testTimerWheel() {
+    // Driven by plain millisecond counts, as a simulator clock would be
+    routing::TimerWheel wheel(100);
+    wheel.start(1000);
+    
+    std::vector<uint64_t> fired;
+    auto collect = [&](uint64_t key) { fired.push_back(key); };
+    
+    wheel.schedule(1, 1500);
+    wheel.schedule(2, 11000);      // beyond the first level
+    wheel.schedule(3, 3600000);    // an hour out
+    wheel.schedule(4, 2000);
+    assert(wheel.size() == 4);
+    
+    wheel.advance(1400, collect);
+    assert(fired.empty());
+    wheel.advance(1500, collect);
+    assert(fired.size() == 1 && fired[0] == 1);
+    
+    // Rescheduling moves the deadline, cancelling drops the timer
+    wheel.schedule(4, 12000);
+    assert(wheel.cancel(2));
+    assert(!wheel.cancel(2));
+    wheel.advance(11500, collect);
+    assert(fired.size() == 1);
+    wheel.advance(12000, collect);
+    assert(fired.size() == 2 && fired[1] == 4);
+    
+    // A large jump still fires far timers exactly once
+    wheel.advance(3600000, collect);
+    assert(fired.size() == 3 && fired[2] == 3);
+    assert(wheel.size() == 0);
+    
+    // Callbacks may re-arm the timer that is firing
+    wheel.schedule(5, 3600100);
+    int rearmed = 0;
+    wheel.advance(3600100, [&](uint64_t key) {
+        if (rearmed++ == 0) {
+            wheel.schedule(key, 3600100);
+        }
+    });
+    assert(rearmed == 1 && wheel.pending(5));
+    wheel.advance(3600200, [&](uint64_t) { ++rearmed; });
+    assert(rearmed == 2 && !wheel.pending(5));
+}
+
+void testSpatialGrid() {
+    routing::SpatialGrid grid(50.0);
+    auto now = system_clock::now();
+    
+    // Vehicles every 10 m along x, two lanes apart in y
+    for (uint32_t i = 0; i < 100; ++i) {
+        grid.update(i, {i * 10.0, (i % 2) * 4.0, 0.0, now});
+    }
+    assert(grid.size() == 100);
+    
+    std::vector<routing::NodeId> found;
+    grid.queryRadius({500.0, 0.0, 0.0, now}, 25.0, found);
+    assert(found.size() == 5);  // 48 through 52
+    
+    found.clear();
+    grid.nearest({-3.0, 0.0, 0.0, now}, 3, found);
+    assert((found == std::vector<routing::NodeId>{0, 1, 2}));
+    
+    // Moving a node across cells and removing one keep both queries exact
+    grid.update(0, {2000.0, 0.0, 0.0, now});
+    assert(grid.remove(1));
+    assert(!grid.remove(1));
+    found.clear();
+    grid.nearest({-3.0, 0.0, 0.0, now}, 2, found);
+    assert((found == std::vector<routing::NodeId>{2, 3}));
+    found.clear();
+    grid.queryRadius({2000.0, 0.0, 0.0, now}, 1.0, found);
+    assert(found.size() == 1 && found[0] == 0);
+    
+    // k larger than the grid returns everything
+    found.clear();
+    grid.nearest({0.0, 0.0, 0.0, now}, 500, found);
+    assert(found.size() == grid.size());
+}
+
+void testMovementCheck() {
+    // Same verdicts as the scalar rule, including the tail past the last full vector
+    routing::PositionColumns from, to;
+    auto base = system_clock::now();
+    std::vector<bool> expected;
+    uint32_t seed = 7;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) % 1000; };
+    for (int i = 0; i < 1003; ++i) {
+        routing::Position a{next() * 1.0, next() * 1.0, 0.0, base};
+        routing::Position b{a.x + next() * 0.2, a.y, 0.0, base + milliseconds(next() * 20)};
+        from.push_back(a);
+        to.push_back(b);
+        
+        double elapsed = duration_cast<seconds>(b.timestamp - a.timestamp).count();
+        double speed = std::hypot(b.x - a.x, b.y - a.y) / elapsed * 3.6;
+        expected.push_back(!(elapsed > 0 && speed <= 200.0 && speed / elapsed <= 10.0));
+    }
+    
+    std::vector<uint8_t> implausible(from.size());
+    size_t flagged = routing::validateMovementsBatch(from, to, {200.0, 10.0}, implausible.data());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        mismatches += implausible[i] != expected[i];
+    }
+    assert(mismatches == 0);
+    assert(flagged == static_cast<size_t>(std::count(expected.begin(), expected.end(), true)));
+    assert(flagged > 0 && flagged < expected.size());
+}
+
+void testTraceSink() {
+    std::string prefix = (std::filesystem::temp_directory_path() / "vanet-trace-test").string();
+    auto segmentPath = [](const std::string& prefix, int index) {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "-%06d.vtr", index);
+        return prefix + suffix;
+    };
+    
+    routing::TraceSink sink(prefix, 4, 2);
+    assert(sink.ok());
+    sink.captureNone();
+    sink.capture(routing::MessageType::DATA, true);
+    
+    routing::TraceRecord record{};
+    record.node = 3;
+    record.peer = 9;
+    record.size = 300;
+    for (uint32_t i = 0; i < 10; ++i) {
+        record.timeNs = 1000 + i;
+        record.sequence = i;
+        record.x = i * 0.5f;
+        record.event = i % 2 ? routing::TraceEvent::RECEIVE : routing::TraceEvent::SEND;
+        record.type = static_cast<uint8_t>(i < 6 ? routing::MessageType::DATA : routing::MessageType::HELLO);
+        sink.record(record);
+    }
+    // Rejections are kept whatever their type
+    record.event = routing::TraceEvent::REJECT;
+    record.reason = routing::TraceReason::BAD_SIGNATURE;
+    sink.record(record);
+    assert(sink.recorded() == 7 && sink.segments() == 2);
+    sink.close();
+    
+    // Two segments: four records, then three; the one mapped ahead is removed
+    std::ifstream in(segmentPath(prefix, 1), std::ios::binary);
+    std::vector<uint8_t> segment((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(segment.size() == routing::TraceSink::segmentBytes(4));
+    assert(routing::loadLE32(segment.data()) == routing::TraceSink::MAGIC);
+    assert(routing::loadLE32(segment.data() + 8) == 4 && routing::loadLE32(segment.data() + 12) == 3);
+    assert(routing::loadLE32(segment.data() + 16) == 1);
+    
+    uint32_t sequenceColumn = routing::loadLE32(segment.data() + 24 + 3 * 4);
+    uint32_t reasonColumn = routing::loadLE32(segment.data() + 24 + 9 * 4);
+    assert(sequenceColumn % 8 == 0);
+    assert(routing::loadLE32(segment.data() + sequenceColumn) == 4);
+    assert(routing::loadLE32(segment.data() + sequenceColumn + 8) == 9);
+    assert(segment[reasonColumn + 2] == static_cast<uint8_t>(routing::TraceReason::BAD_SIGNATURE));
+    assert(std::filesystem::exists(segmentPath(prefix, 0)) && !std::filesystem::exists(segmentPath(prefix, 2)));
+    
+    // The protocol traces what it sends and what it turns away
+    std::string protocolPrefix = prefix + "-protocol";
+    routing::TraceSink protocolSink(protocolPrefix, 16, 1);
+    routing::SecureRoutingProtocol router("trace_vehicle");
+    routing::VehicleInfo info;
+    info.id = "trace_vehicle";
+    info.position = {0.0, 0.0, 0.0, system_clock::now()};
+    assert(router.initializeVehicle(info));
+    router.setTraceSink(&protocolSink);
+    router.sendBeacon();
+    router.receiveMessage(std::vector<uint8_t>{1, 2, 3});
+    assert(protocolSink.recorded() == 2);
+    protocolSink.close();
+    
+    std::ifstream protocolIn(segmentPath(protocolPrefix, 0), std::ios::binary);
+    std::vector<uint8_t> traced((std::istreambuf_iterator<char>(protocolIn)), std::istreambuf_iterator<char>());
+    uint32_t eventColumn = routing::loadLE32(traced.data() + 24 + 7 * 4);
+    uint32_t typeColumn = routing::loadLE32(traced.data() + 24 + 8 * 4);
+    reasonColumn = routing::loadLE32(traced.data() + 24 + 9 * 4);
+    assert(traced[eventColumn] == static_cast<uint8_t>(routing::TraceEvent::SEND));
+    assert(traced[typeColumn] == static_cast<uint8_t>(routing::MessageType::HELLO));
+    assert(traced[eventColumn + 1] == static_cast<uint8_t>(routing::TraceEvent::REJECT));
+    assert(traced[reasonColumn + 1] == static_cast<uint8_t>(routing::TraceReason::MALFORMED));
+    
+    std::filesystem::remove(segmentPath(prefix, 0));
+    std::filesystem::remove(segmentPath(prefix, 1));
+    std::filesystem::remove(segmentPath(protocolPrefix, 0));
+}
+
+void testWireFormat() {
+    routing::MessageHeader header;
+    header.type = routing::MessageType::HELLO;
+    header.ttl = 1;
+    header.source = 7;
+    header.destination = routing::BROADCAST_NODE;
+    header.sequence = 0x01020304;
+    header.timestamp = 1700000000123ULL;
+    header.x = 12.5f;
+    header.y = -3.25f;
+    header.z = 0.0f;
+    
+    uint8_t buffer[routing::BEACON_SIZE];
+    assert(routing::encodeBeacon(header, 13.9f, 90.0f, buffer, sizeof(buffer) - 1) == 0);
+    size_t length = routing::encodeBeacon(header, 13.9f, 90.0f, buffer, sizeof(buffer));
+    assert(length == routing::BEACON_SIZE);
+    
+    // Multi-byte fields are little-endian regardless of host order
+    assert(buffer[12] == 0x04 && buffer[15] == 0x01);
+    
+    routing::MessageView view;
+    assert(view.parse(crypto::ByteView(buffer, length)));
+    assert(view.type() == routing::MessageType::HELLO && view.ttl() == 1);
+    assert(view.source() == 7 && view.destination() == routing::BROADCAST_NODE);
+    assert(view.sequence() == 0x01020304 && view.timestamp() == 1700000000123ULL);
+    assert(view.isBeacon() && view.speed() == 13.9f && view.direction() == 90.0f);
+    auto pos = view.position();
+    assert(pos.x == 12.5 && pos.y == -3.25);
+    assert(duration_cast<milliseconds>(pos.timestamp.time_since_epoch()).count() == 1700000000123LL);
+    
+    // Truncated, unknown version and unknown type are rejected
+    assert(!view.parse(crypto::ByteView(buffer, routing::HEADER_SIZE - 1)) && !view.valid());
+    buffer[0] = routing::WIRE_VERSION + 1;
+    assert(!view.parse(crypto::ByteView(buffer, length)));
+    buffer[0] = routing::WIRE_VERSION;
+    buffer[1] = 0xff;
+    assert(!view.parse(crypto::ByteView(buffer, length)));
+    
+    // Route discovery bodies round-trip and need their full length
+    header.type = routing::MessageType::ROUTE_REQUEST;
+    uint8_t rreq[routing::ROUTE_REQUEST_SIZE];
+    routing::RouteRequest request{7, 41, 5, 0, 3};
+    length = routing::encodeRouteRequest(header, request, rreq, sizeof(rreq));
+    assert(length == routing::ROUTE_REQUEST_SIZE);
+    assert(view.parse(crypto::ByteView(rreq, length)));
+    routing::RouteRequest decoded;
+    routing::RouteReply notReply;
+    assert(view.routeRequest(decoded) && !view.routeReply(notReply));
+    assert(decoded.originator == 7 && decoded.broadcastId == 41 && decoded.originatorSequence == 5 &&
+           decoded.destinationSequence == 0 && decoded.hopCount == 3);
+    assert(view.parse(crypto::ByteView(rreq, length - 1)) && !view.routeRequest(decoded));
+    
+    header.type = routing::MessageType::ROUTE_REPLY;
+    uint8_t rrep[routing::ROUTE_REPLY_SIZE];
+    length = routing::encodeRouteReply(header, routing::RouteReply{9, 12, 4, 60000, 2}, rrep, sizeof(rrep));
+    routing::RouteReply reply;
+    assert(view.parse(crypto::ByteView(rrep, length)) && view.routeReply(reply));
+    assert(reply.target == 9 && reply.targetSequence == 12 && reply.nextHop == 4 &&
+           reply.lifetimeMs == 60000 && reply.hopCount == 2);
+
+    // DATA carries its hop fields ahead of the application bytes
+    header.type = routing::MessageType::DATA;
+    uint8_t data[routing::DATA_HEADER_SIZE + 2];
+    assert(routing::encodeDataHeader(header, routing::DataHop{7, 4}, data, sizeof(data)) == routing::DATA_HEADER_SIZE);
+    data[routing::DATA_HEADER_SIZE] = 'o';
+    data[routing::DATA_HEADER_SIZE + 1] = 'k';
+    routing::DataHop hop;
+    assert(view.parse(crypto::ByteView(data, sizeof(data))) && view.dataHop(hop) && !view.routeReply(reply));
+    assert(hop.originator == 7 && hop.nextHop == 4);
+    assert(view.dataBody().size() == 2 && view.dataBody()[0] == 'o');
+    
+    // Secure frames carry the security fields around the routing message
+    crypto::CryptoModule signer;
+    assert(signer.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+    auto secure = signer.createSecureMessage(crypto::ByteView(data, sizeof(data)));
+    std::vector<uint8_t> frame(routing::secureFrameSize(secure));
+    assert(routing::encodeSecureFrame(secure, frame.data(), frame.size() - 1) == 0);
+    assert(routing::encodeSecureFrame(secure, frame.data(), frame.size()) == frame.size());
+    crypto::CryptoModule::SecureMessageView parsed;
+    assert(routing::isSecureFrame(frame) && !routing::isSecureFrame(crypto::ByteView(data, sizeof(data))));
+    assert(routing::parseSecureFrame(frame, parsed));
+    assert(parsed.payload == crypto::ByteView(data, sizeof(data)) && parsed.signature == secure.signature);
+    assert(parsed.timestamp == secure.timestamp && parsed.sequenceNumber == secure.sequenceNumber);
+    assert(parsed.senderCert == secure.senderCert && parsed.sessionTags.empty());
+    crypto::CryptoModule verifier;
+    assert(verifier.verifySecureMessage(parsed));
+    assert(!routing::parseSecureFrame(crypto::ByteView(frame.data(), frame.size() - 1), parsed));
+    frame.push_back(0);
+    assert(!routing::parseSecureFrame(frame, parsed));
+}
+
+void testRouteDiscovery() {
+    // Duplicates are dropped within the lifetime; the oldest pair goes first when full
+    routing::DuplicateCache cache(4, 1000);
+    assert(cache.insert(1, 1, 0) && !cache.insert(1, 1, 10) && cache.contains(1, 1, 999));
+    assert(!cache.contains(1, 1, 1000) && cache.insert(1, 1, 1000));
+    for (uint32_t id = 2; id <= 5; ++id) {
+        assert(cache.insert(1, id, 1000));
+    }
+    assert(cache.size() == 4 && !cache.contains(1, 1, 1001) && cache.contains(1, 2, 1001));
+    for (uint32_t id = 0; id < 1000; ++id) {
+        cache.insert(id % 7, id, 2000);
+    }
+    assert(cache.size() == 4);
+    assert(cache.contains(999 % 7, 999, 2000) && !cache.contains(995 % 7, 995, 2000));
+    
+    // Expanding ring: 1, 3, 5, 7, then the diameter until the retries run out
+    routing::RouteDiscovery discovery(10);
+    uint64_t now = 0;
+    assert(discovery.begin(42, now) == 1 && discovery.begin(42, now) == 0 && discovery.pending(42));
+    std::vector<uint8_t> ttls;
+    std::vector<routing::RouteDiscovery::Retry> retries;
+    while (discovery.pending(42)) {
+        now += routing::RouteDiscovery::ringTraversalMs(10);
+        retries.clear();
+        discovery.expire(now, retries);
+        for (const auto& retry : retries) {
+            ttls.push_back(retry.ttl);
+        }
+    }
+    assert((ttls == std::vector<uint8_t>{3, 5, 7, 10, 10, 10, 0}));
+    
+    // A failed destination is held off, and longer after each failure
+    assert(discovery.begin(42, now + 999) == 0);
+    assert(discovery.begin(42, now + 1000) == 1);
+    discovery.complete(42);
+    assert(!discovery.pending(42) && discovery.inFlight() == 0);
+    // At most one discovery per destination per second, success or not
+    assert(discovery.begin(42, now + 1500) == 0 && discovery.begin(43, now + 1500) == 1);
+    assert(discovery.begin(42, now + 2000, 4) == 6);
+    
+    // The protocol throttles repeated discoveries and retries on its clock
+    crypto::ManualClock clock(system_clock::now());
+    routing::SecureRoutingProtocol router("discovery_vehicle");
+    router.setClock(clock);
+    routing::VehicleInfo info;
+    info.id = "discovery_vehicle";
+    info.position = {0.0, 0.0, 0.0, clock.now()};
+    assert(router.initializeVehicle(info));
+    assert(router.findRoute("unreachable_vehicle"));
+    assert(!router.findRoute("unreachable_vehicle"));
+    const auto& stats = router.getRouteDiscoveryStats();
+    assert(stats.requestsSent == 1 && stats.requestsThrottled == 1);
+    
+    clock.advance(seconds(1));
+    routing::Position later = info.position;
+    later.timestamp = clock.now();
+    assert(router.updatePosition(later));
+    assert(stats.requestsSent == 2);
+}
+
+static std::vector<uint8_t> signedFrame(crypto::CryptoModule& signer, crypto::ByteView message) {
+    auto signedMessage = signer.createSecureMessage(message);
+    crypto::CryptoModule::SecureMessageView secure = signedMessage;
+    std::vector<uint8_t> frame(routing::secureFrameSize(secure));
+    routing::encodeSecureFrame(secure, frame.data(), frame.size());
+    return frame;
+}
+
+void testSecureExchange() {
+    // Three vehicles in a row, each in range of the next only. Frames are
+    // queued as they are sent and then delivered, like a shared channel.
+    crypto::ManualClock clock(system_clock::time_point(hours(24 * 20000)));
+    const char* names[] = {"chain_a", "chain_b", "chain_c"};
+    std::vector<std::unique_ptr<routing::SecureRoutingProtocol>> routers;
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> air;
+    for (size_t i = 0; i < 3; ++i) {
+        routers.push_back(std::make_unique<routing::SecureRoutingProtocol>(names[i]));
+        routers[i]->setClock(clock);
+        routing::VehicleInfo info;
+        info.id = names[i];
+        info.position = {100.0 * i, 0.0, 0.0, clock.now()};
+        assert(routers[i]->initializeVehicle(info));
+        routers[i]->setTransmitter([&air, i](crypto::ByteView frame) { air.emplace_back(i, frame.toVector()); });
+    }
+    auto deliver = [&] {
+        for (size_t next = 0; next < air.size(); ++next) {
+            auto [from, frame] = air[next];
+            for (size_t to = 0; to < routers.size(); ++to) {
+                if (to + 1 == from || from + 1 == to) {
+                    routers[to]->receiveMessage(frame);
+                }
+            }
+        }
+        air.clear();
+    };
+    auto& a = *routers[0];
+    auto& b = *routers[1];
+    auto& c = *routers[2];
+    
+    // Signed beacons make the neighbors known and trusted
+    for (int round = 0; round < 2; ++round) {
+        for (auto& router : routers) {
+            router->sendBeacon();
+        }
+        deliver();
+        clock.advance(seconds(1));
+    }
+    assert(a.isVehicleTrusted("chain_b") && b.isVehicleTrusted("chain_c") && !a.isVehicleTrusted("chain_c"));
+    
+    // A route request flooded through b and answered by c. The first ring
+    // ends at b; the retry once it has timed out gets to c.
+    std::vector<uint8_t> payload = {'h', 'i'};
+    assert(!a.sendData("chain_c", payload));
+    deliver();
+    clock.advance(milliseconds(routing::RouteDiscovery::ringTraversalMs(1)));
+    a.updatePosition({0.0, 0.0, 0.0, clock.now()});
+    deliver();
+    assert(b.getRouteDiscoveryStats().requestsForwarded == 1 && c.getRouteDiscoveryStats().repliesSent == 1);
+    assert(b.getRouteDiscoveryStats().repliesForwarded == 1);
+    
+    // DATA goes through b, which a hears relaying it
+    uint64_t verifiedAtC = c.getVerificationStats().fullVerifications;
+    uint16_t handoffs = a.getForwardingMonitor().getConfig().minHandoffs;
+    for (uint16_t i = 0; i < handoffs; ++i) {
+        assert(a.sendData("chain_c", payload));
+        deliver();
+        clock.advance(milliseconds(10));
+    }
+    assert(c.getVerificationStats().fullVerifications == verifiedAtC + handoffs);
+    assert(!a.detectBlackHole("chain_b") && a.isVehicleTrusted("chain_b"));
+    for (auto& router : routers) {
+        assert(router->getVerificationStats().rejected == 0);
+    }
+    
+    // A frame changed on the way no longer verifies
+    a.sendBeacon();
+    air[0].second[3 + 24] ^= 0x01;
+    assert(!b.receiveMessage(air[0].second));
+    assert(b.getVerificationStats().rejected == 1);
+    air.clear();
+    
+    // Nor does one that claims a's source under another key, however well
+    // signed, and a's sequence window stays where it was
+    crypto::CryptoModule forger;
+    assert(forger.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+    forger.setClock(&clock);
+    routing::MessageHeader header{routing::MessageType::HELLO, 1, routing::NodeRegistry::instance().find("chain_a"),
+                                  routing::BROADCAST_NODE, 1u << 20, clock.nowMillis(), 0.0f, 0.0f, 0.0f};
+    uint8_t beacon[routing::BEACON_SIZE];
+    assert(routing::encodeBeacon(header, 0.0f, 0.0f, beacon, sizeof(beacon)) == sizeof(beacon));
+    assert(!b.receiveMessage(signedFrame(forger, crypto::ByteView(beacon, sizeof(beacon)))));
+    assert(b.getVerificationStats().rejected == 2);
+    a.sendBeacon();
+    assert(b.receiveMessage(air[0].second));
+    air.clear();
+    
+    // A newcomer may sign for itself, but not open a flood or answer one
+    // in the name of the nodes it claims as originator or target
+    header.source = routing::NodeRegistry::instance().intern("chain_rogue");
+    header.type = routing::MessageType::ROUTE_REQUEST;
+    header.destination = routing::NodeRegistry::instance().find("chain_a");
+    header.sequence = 1;
+    routing::RouteRequest request{routing::NodeRegistry::instance().find("chain_c"), 1000, 1000, 0, 0};
+    uint8_t rreq[routing::ROUTE_REQUEST_SIZE];
+    assert(routing::encodeRouteRequest(header, request, rreq, sizeof(rreq)) == sizeof(rreq));
+    assert(!a.receiveMessage(signedFrame(forger, crypto::ByteView(rreq, sizeof(rreq)))));
+    header.type = routing::MessageType::ROUTE_REPLY;
+    header.sequence = 2;
+    routing::RouteReply reply{routing::NodeRegistry::instance().find("chain_c"), 1000,
+                              routing::NodeRegistry::instance().find("chain_a"), 1000, 0};
+    uint8_t rrep[routing::ROUTE_REPLY_SIZE];
+    assert(routing::encodeRouteReply(header, reply, rrep, sizeof(rrep)) == sizeof(rrep));
+    assert(!a.receiveMessage(signedFrame(forger, crypto::ByteView(rrep, sizeof(rrep)))));
+    assert(a.getRouteDiscoveryStats().repliesSent == 0);
+    air.clear();
+}
+
+void testSimulatedClock() {
+    // Timestamps, freshness and replay windows follow the injected clock
+    crypto::ManualClock clock(system_clock::time_point(hours(24 * 20000)));
+    crypto::CryptoModule sender;
+    crypto::CryptoModule receiver;
+    sender.setClock(&clock);
+    receiver.setClock(&clock);
+    assert(sender.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+    auto message = sender.createSecureMessage(crypto::ByteView(std::vector<uint8_t>{'t', 'i', 'c', 'k'}));
+    assert(message.timestamp == clock.nowMillis());
+    clock.advance(milliseconds(5000));
+    assert(receiver.verifySecureMessage(message));
+    clock.advance(milliseconds(1));
+    assert(!receiver.verifySecureMessage(message));
+    
+    // A message recorded at the end of a replay bucket stays a replay for
+    // as long as its timestamp is accepted
+    clock.advance(milliseconds(998));
+    auto late = sender.createSecureMessage(crypto::ByteView(std::vector<uint8_t>{'l', 'a', 't', 'e'}));
+    assert(receiver.verifySecureMessage(late));
+    receiver.updateMessageHistory(late);
+    for (int ms : {1, 4000, 999}) {
+        clock.advance(milliseconds(ms));
+        assert(!receiver.verifySecureMessage(late));
+    }
+    
+    // Senders colliding on more slots than are probed grow the table
+    // instead of evicting one another while still live
+    crypto::ReplayWindow window(16, 1000, 5);
+    uint64_t nowMs = clock.nowMillis();
+    for (uint64_t sender = 1; sender <= 12; ++sender) {
+        window.record(sender << 4, 100, nowMs);
+    }
+    assert(window.capacity() > 16 && window.activeSenders(nowMs) == 12);
+    for (uint64_t sender = 1; sender <= 12; ++sender) {
+        assert(window.isReplay(sender << 4, 100, nowMs));
+    }
+    
+    // An event clock holds its reading until refreshed
+    crypto::EventClock event(clock);
+    auto start = event.now();
+    clock.advance(hours(1));
+    assert(event.now() == start && event.refresh() == clock.now() && event.now() == clock.now());
+    
+    // Routes expire after their timeout in clock time, however fast it runs
+    routing::SecureRoutingProtocol router("clocked_vehicle");
+    router.setClock(clock);
+    routing::VehicleInfo info;
+    info.id = "clocked_vehicle";
+    info.position = {0.0, 0.0, 0.0, clock.now()};
+    assert(router.initializeVehicle(info));
+    routing::RouteEntry entry;
+    entry.nextHop = "clocked_relay";
+    entry.hopCount = 1;
+    entry.timestamp = clock.now();
+    entry.trustScore = 1.0;
+    assert(router.updateRoute("clocked_destination", entry));
+    
+    const auto& stats = router.getRouteDiscoveryStats();
+    for (int step = 1; step <= 60; ++step) {
+        clock.advance(seconds(1));
+        assert(router.updatePosition({0.0, 0.0, 0.0, clock.now()}));
+    }
+    assert(router.findRoute("clocked_destination") && stats.requestsSent == 0);
+    clock.advance(seconds(1));
+    assert(router.updatePosition({0.0, 0.0, 0.0, clock.now()}));
+    assert(router.findRoute("clocked_destination") && stats.requestsSent == 1);
+}
+
+void testBeaconControl() {
+    // Delta beacons round-trip within their quantization
+    routing::DeltaBeacon delta{7, 12, 10, 250, 3.5, -1.25, 0.0, 13.9, 359.5};
+    uint8_t buffer[routing::DELTA_BEACON_SIZE];
+    assert(routing::encodeDeltaBeacon(delta, buffer, sizeof(buffer)) == routing::DELTA_BEACON_SIZE);
+    crypto::ByteView frame(buffer, sizeof(buffer));
+    routing::DeltaBeacon decoded;
+    assert(routing::isDeltaBeacon(frame) && routing::decodeDeltaBeacon(frame, decoded));
+    assert(decoded.source == 7 && decoded.sequence == 12 && decoded.baseSequence == 10);
+    assert(decoded.elapsedMs == 250 && std::fabs(decoded.dx - 3.5) < 0.01 && std::fabs(decoded.dy + 1.25) < 0.01);
+    assert(std::fabs(decoded.speed - 13.9) < 0.01 && std::fabs(decoded.direction - 359.5) < 0.01);
+    routing::MessageView view;
+    assert(!view.parse(frame));
+    routing::DeltaBeacon far = delta;
+    far.dx = 400.0;
+    assert(routing::encodeDeltaBeacon(far, buffer, sizeof(buffer)) == 0);
+
+    // Kinematic triggers: a moving vehicle beacons by distance, a parked one by the maximum interval
+    routing::BeaconController moving, parked;
+    routing::VehicleInfo self;
+    self.position = {0.0, 0.0, 0.0, {}};
+    self.speed = 20.0;
+    self.direction = 90.0;
+    assert(moving.due(1000, self) == routing::BeaconKind::FULL);
+    moving.sent(1000, routing::BeaconKind::FULL, self, 200);
+    assert(moving.due(1100, self) == routing::BeaconKind::NONE);
+    self.position.x = 6.0;
+    assert(moving.due(1300, self) == routing::BeaconKind::DELTA);
+    moving.sent(1300, routing::BeaconKind::DELTA, self, routing::DELTA_BEACON_SIZE);
+    self.position.x = 20.0;
+    assert(moving.due(2000, self) == routing::BeaconKind::FULL);
+
+    self.position = {0.0, 0.0, 0.0, {}};
+    self.speed = 0.0;
+    parked.sent(1000, routing::BeaconKind::FULL, self, 200);
+    assert(parked.due(1900, self) == routing::BeaconKind::NONE);
+    assert(parked.due(2000, self) == routing::BeaconKind::FULL);
+
+    // A saturated channel lowers the duty cycle and stretches the gap
+    routing::BeaconController congested;
+    uint64_t idleInterval = congested.intervalMs();
+    congested.sent(1000, routing::BeaconKind::FULL, self, 300);
+    for (uint64_t now = 1000; now < 21000; ++now) {
+        congested.heard(now, 300);
+        congested.heard(now, 300);
+    }
+    assert(congested.channelLoad() > 0.9);
+    assert(congested.dutyCycle() < 0.03 && congested.intervalMs() > idleInterval);
+
+    // The protocol follows its controller in clock time
+    crypto::ManualClock clock(system_clock::time_point(hours(24 * 20000)));
+    routing::SecureRoutingProtocol router("beaconing_vehicle");
+    router.setClock(clock);
+    routing::VehicleInfo info;
+    info.id = "beaconing_vehicle";
+    info.position = {0.0, 0.0, 0.0, clock.now()};
+    assert(router.initializeVehicle(info));
+    const auto& stats = router.getBeaconStats();
+    assert(router.sendBeaconIfDue() && stats.fullBeacons == 1 && stats.bytesSent > 0);
+    clock.advance(milliseconds(router.beaconCheckIntervalMs()));
+    assert(!router.sendBeaconIfDue() && stats.suppressed == 1);
+    clock.advance(seconds(1));
+    assert(router.sendBeaconIfDue() && stats.fullBeacons == 2 && stats.deltaBeacons == 0);
+
+    // Deltas without an accepted full beacon to build on are dropped
+    routing::encodeDeltaBeacon(delta, buffer, sizeof(buffer));
+    assert(!router.receiveMessage(crypto::ByteView(buffer, sizeof(buffer))));
+    assert(stats.deltasDropped == 1 && stats.deltasApplied == 0);
+    
+    // Deltas from the send path are applied on top of the full beacon.
+    // Without sessions they go out bare; with sessions they carry a tag,
+    // and bare ones are dropped.
+    for (bool sessions : {false, true}) {
+        std::string mode = sessions ? "_session" : "_bare";
+        routing::SecureRoutingProtocol sender("delta_sender" + mode);
+        routing::SecureRoutingProtocol receiver("delta_receiver" + mode);
+        std::vector<std::vector<uint8_t>> fromSender, fromReceiver;
+        sender.setTransmitter([&fromSender](crypto::ByteView frame) { fromSender.push_back(frame.toVector()); });
+        receiver.setTransmitter([&fromReceiver](crypto::ByteView frame) { fromReceiver.push_back(frame.toVector()); });
+        // Fixes stamped a while ago, so that the next one is a plausible move
+        routing::VehicleInfo senderInfo{}, receiverInfo{};
+        senderInfo.id = "delta_sender" + mode;
+        senderInfo.position = {0.0, 0.0, 0.0, clock.now() - seconds(10)};
+        receiverInfo.id = "delta_receiver" + mode;
+        receiverInfo.position = {50.0, 0.0, 0.0, clock.now() - seconds(10)};
+        for (auto* node : {&sender, &receiver}) {
+            node->setClock(clock);
+            assert(node->initializeVehicle(node == &sender ? senderInfo : receiverInfo));
+            node->setSessionMode(sessions);
+        }
+        
+        assert(sender.sendBeaconIfDue() && receiver.sendBeaconIfDue());
+        assert(receiver.receiveMessage(fromSender.back()) && sender.receiveMessage(fromReceiver.back()));
+        clock.advance(milliseconds(200));
+        assert(sender.updatePosition({5.0, 0.0, 0.0, clock.now()}));
+        assert(sender.sendBeaconIfDue() && sender.getBeaconStats().deltaBeacons == 1);
+        std::vector<uint8_t> deltaFrame = fromSender.back();
+        assert(routing::isSecureFrame(deltaFrame) == sessions);
+        
+        const auto& received = receiver.getBeaconStats();
+        assert(receiver.receiveMessage(deltaFrame) && received.deltasApplied == 1);
+        assert(receiver.neighborsWithin({5.0, 0.0, 0.0, {}}, 0.5).size() == 1);
+        assert(!receiver.receiveMessage(deltaFrame) && received.deltasDropped == 1);
+        
+        // The next delta anyone could send, and one far past its base
+        crypto::CryptoModule::SecureMessageView secure;
+        crypto::ByteView bare = deltaFrame;
+        if (sessions) {
+            assert(routing::parseSecureFrame(deltaFrame, secure));
+            bare = secure.payload;
+        }
+        routing::DeltaBeacon forged;
+        assert(routing::decodeDeltaBeacon(bare, forged));
+        forged.sequence = forged.baseSequence + 1000;
+        assert(routing::encodeDeltaBeacon(forged, buffer, sizeof(buffer)) == routing::DELTA_BEACON_SIZE);
+        assert(!receiver.receiveMessage(crypto::ByteView(buffer, sizeof(buffer))));
+        forged.sequence = forged.baseSequence + 2;
+        assert(routing::encodeDeltaBeacon(forged, buffer, sizeof(buffer)) == routing::DELTA_BEACON_SIZE);
+        assert(receiver.receiveMessage(crypto::ByteView(buffer, sizeof(buffer))) == !sessions);
+        assert(received.deltasApplied == (sessions ? 1u : 2u) && received.deltasDropped == (sessions ? 3u : 2u));
+        
+        // Secured deltas are only taken under the sender's own credential
+        crypto::CryptoModule forger;
+        assert(forger.generateKeyPair(crypto::SignatureAlgorithm::ECDSA_P256));
+        forger.setClock(&clock);
+        forged.sequence = forged.baseSequence + 3;
+        assert(routing::encodeDeltaBeacon(forged, buffer, sizeof(buffer)) == routing::DELTA_BEACON_SIZE);
+        assert(!receiver.receiveMessage(signedFrame(forger, crypto::ByteView(buffer, sizeof(buffer)))));
+        assert(received.deltasApplied == (sessions ? 1u : 2u) && received.deltasDropped == (sessions ? 4u : 3u));
+    }
+}
+
+void testStateMigration() {
+    routing::SecureRoutingProtocol origin("migrating_vehicle");
+    routing::VehicleInfo info;
+    info.id = "migrating_vehicle";
+    info.position = {250.0, 500.0, 0.0, system_clock::now()};
+    info.speed = 40.0;
+    assert(origin.initializeVehicle(info));
+    
+    routing::RouteEntry entry;
+    entry.nextHop = "relay_vehicle";
+    entry.hopCount = 2;
+    entry.timestamp = system_clock::now();
+    entry.trustScore = 0.9;
+    assert(origin.updateRoute("far_vehicle", entry));
+    origin.updateTrustScore("relay_vehicle", 1.0);
+    origin.updateTrustScore("shady_vehicle", 0.1);
+    
+    std::vector<uint8_t> state;
+    assert(origin.exportState(state));
+    
+    // The receiving side rebuilds an identical snapshot
+    routing::SecureRoutingProtocol migrated("migrating_vehicle");
+    assert(migrated.importState(state));
+    std::vector<uint8_t> again;
+    assert(migrated.exportState(again));
+    assert(again == state);
+    assert(migrated.calculateTrust("relay_vehicle") == origin.calculateTrust("relay_vehicle"));
+    assert(migrated.calculateTrust("shady_vehicle") == origin.calculateTrust("shady_vehicle"));
+    
+    // Wrong vehicle and truncated snapshots are refused
+    routing::SecureRoutingProtocol other("other_vehicle");
+    assert(!other.importState(state));
+    assert(!migrated.importState(crypto::ByteView(state.data(), state.size() - 1)));
+}
+
+// Frame for messages that only get the cheap checks, security fields left empty
+static std::vector<uint8_t> unsignedFrame(crypto::ByteView message) {
+    crypto::CryptoModule::SecureMessageView secure;
+    secure.payload = message;
+    std::vector<uint8_t> frame(routing::secureFrameSize(secure));
+    routing::encodeSecureFrame(secure, frame.data(), frame.size());
+    return frame;
+}
+
+void testTrustCache() {
+    routing::SecureRoutingProtocol router("trusting_vehicle");
+    router.updateTrustScore("peer_vehicle", 1.0);
+    double first = router.calculateTrust("peer_vehicle");
+    assert(first > 0.29 && first < 0.31);
+    assert(router.calculateTrust("peer_vehicle") == first);
+    assert(!router.isVehicleTrusted("peer_vehicle"));
+    
+    // A new observation invalidates the memoized score
+    router.updateTrustScore("peer_vehicle", 1.0);
+    double second = router.calculateTrust("peer_vehicle");
+    assert(second > 0.50 && second < 0.52);
+    assert(router.isVehicleTrusted("peer_vehicle"));
+    assert(router.calculateTrust("unknown_vehicle") == 0.0);
+    
+    // Frames from a trusted sender skip the signature, so their sequence
+    // must not move the sender's window: a forged one far ahead would
+    // otherwise lock the real sender out
+    for (int i = 0; i < 20; ++i) {
+        router.updateTrustScore("peer_vehicle", 1.0);
+    }
+    auto& registry = routing::NodeRegistry::instance();
+    routing::MessageHeader header{routing::MessageType::DATA, 9, registry.find("peer_vehicle"),
+                                  registry.intern("far_vehicle"), 1u << 31,
+                                  crypto::Clock::system().nowMillis(), 0.0f, 0.0f, 0.0f};
+    routing::DataHop hop{registry.find("peer_vehicle"), registry.intern("next_vehicle")};
+    uint8_t frame[routing::DATA_HEADER_SIZE];
+    assert(routing::encodeDataHeader(header, hop, frame, sizeof(frame)) == routing::DATA_HEADER_SIZE);
+    assert(router.receiveMessage(unsignedFrame(crypto::ByteView(frame, sizeof(frame)))));
+    header.sequence = 2;
+    assert(routing::encodeDataHeader(header, hop, frame, sizeof(frame)) == routing::DATA_HEADER_SIZE);
+    assert(router.receiveMessage(unsignedFrame(crypto::ByteView(frame, sizeof(frame)))));
+    
+    // Routing messages outside a secure frame are never accepted
+    assert(!router.receiveMessage(crypto::ByteView(frame, sizeof(frame))));
+}
+
+void testBlackHoleDetection() {
+    // Handoffs without overheard relays are suspect once there are enough of them
+    routing::ForwardingMonitor monitor;
+    const auto& config = monitor.getConfig();
+    routing::ForwardingCounters hole{}, relay{};
+    uint64_t now = 100 * config.windowMs;
+    bool flagged = false;
+    for (uint16_t i = 0; i < config.minHandoffs; ++i) {
+        assert(!monitor.suspicious(hole, now));
+        flagged = monitor.record(hole, routing::ForwardingEvent::HANDED_OFF, now);
+        monitor.record(relay, routing::ForwardingEvent::HANDED_OFF, now);
+        monitor.record(relay, routing::ForwardingEvent::OVERHEARD, now);
+    }
+    assert(flagged && monitor.suspicious(hole, now) && !monitor.suspicious(relay, now));
+    
+    // Counts halve every window, which eventually clears the verdict
+    assert(monitor.suspicious(hole, now + config.windowMs - 1));
+    assert(!monitor.suspicious(hole, now + config.windowMs));
+    assert(monitor.record(hole, routing::ForwardingEvent::OVERHEARD, now + 20 * config.windowMs));
+    assert(hole.handedOff == 0 && hole.overheard == 1);
+    
+    // A neighbor advertising routes out of proportion is judged sooner
+    routing::ForwardingCounters advertiser{};
+    for (uint16_t i = 0; i < config.minHandoffs; ++i) {
+        monitor.record(advertiser, routing::ForwardingEvent::ADVERTISED, now);
+    }
+    for (uint16_t i = 0; i < config.minHandoffs / 2; ++i) {
+        monitor.record(advertiser, routing::ForwardingEvent::HANDED_OFF, now);
+    }
+    assert(monitor.suspicious(advertiser, now));
+    
+    // The protocol counts its own handoffs and the relays it overhears
+    crypto::ManualClock clock(system_clock::time_point(hours(24 * 20000)));
+    routing::SecureRoutingProtocol router("bh_source");
+    router.setClock(clock);
+    routing::VehicleInfo info;
+    info.id = "bh_source";
+    info.position = {0.0, 0.0, 0.0, clock.now()};
+    assert(router.initializeVehicle(info));
+    for (int i = 0; i < 20; ++i) {
+        router.updateTrustScore("bh_relay", 1.0);
+        router.updateTrustScore("bh_hole", 1.0);
+    }
+    routing::RouteEntry viaRelay{"bh_relay", 2, clock.now(), 1.0};
+    routing::RouteEntry viaHole{"bh_hole", 2, clock.now(), 1.0};
+    assert(router.updateRoute("bh_far", viaRelay) && router.updateRoute("bh_other", viaHole));
+    
+    auto& registry = routing::NodeRegistry::instance();
+    std::vector<uint8_t> payload = {'d', 'a', 't', 'a'};
+    uint8_t relayed[routing::DATA_HEADER_SIZE + 4];
+    for (uint32_t i = 0; i < config.minHandoffs; ++i) {
+        assert(router.sendData("bh_far", payload) && router.sendData("bh_other", payload));
+        routing::MessageHeader header{routing::MessageType::DATA, 9, registry.find("bh_relay"),
+                                      registry.find("bh_far"), i + 1, clock.nowMillis(), 0.0f, 0.0f, 0.0f};
+        routing::DataHop hop{registry.find("bh_source"), registry.intern("bh_next")};
+        assert(routing::encodeDataHeader(header, hop, relayed, sizeof(relayed)) == routing::DATA_HEADER_SIZE);
+        std::copy(payload.begin(), payload.end(), relayed + routing::DATA_HEADER_SIZE);
+        assert(router.receiveMessage(unsignedFrame(crypto::ByteView(relayed, sizeof(relayed)))));
+        clock.advance(milliseconds(10));
+    }
+    assert(router.detectBlackHole("bh_hole") && !router.isVehicleTrusted("bh_hole"));
+    assert(!router.detectBlackHole("bh_relay") && router.isVehicleTrusted("bh_relay"));
+    // Routes through the black hole are no longer used
+    assert(!router.sendData("bh_other", payload));
+}
+
 void testAttackDetection() {
     routing::SecureRoutingProtocol router("test_vehicle");
     
@@ -94,6 +1430,86 @@ int main() {
         testCryptoModule();
         std::cout << "Crypto module tests passed!" << std::endl;
         
+        std::cout << "Running signature backend tests..." << std::endl;
+        testSignatureBackends();
+        std::cout << "Signature backend tests passed!" << std::endl;
+        
+        std::cout << "Running crypto engine tests..." << std::endl;
+        testCryptoEngine();
+        std::cout << "Crypto engine tests passed!" << std::endl;
+        
+        std::cout << "Running signing pool tests..." << std::endl;
+        testSigningPool();
+        std::cout << "Signing pool tests passed!" << std::endl;
+        
+        std::cout << "Running neighbor session tests..." << std::endl;
+        testNeighborSessions();
+        std::cout << "Neighbor session tests passed!" << std::endl;
+        
+        std::cout << "Running certificate chain tests..." << std::endl;
+        testCertificateChain();
+        std::cout << "Certificate chain tests passed!" << std::endl;
+        
+        std::cout << "Running key provisioning tests..." << std::endl;
+        testKeyProvisioning();
+        std::cout << "Key provisioning tests passed!" << std::endl;
+        
+        std::cout << "Running message arena tests..." << std::endl;
+        testMessageArena();
+        std::cout << "Message arena tests passed!" << std::endl;
+        
+        std::cout << "Running instrumentation tests..." << std::endl;
+        testInstrumentation();
+        std::cout << "Instrumentation tests passed!" << std::endl;
+        
+        std::cout << "Running timer wheel tests..." << std::endl;
+        testTimerWheel();
+        std::cout << "Timer wheel tests passed!" << std::endl;
+        
+        std::cout << "Running spatial grid tests..." << std::endl;
+        testSpatialGrid();
+        std::cout << "Spatial grid tests passed!" << std::endl;
+        
+        std::cout << "Running movement check tests..." << std::endl;
+        testMovementCheck();
+        std::cout << "Movement check tests passed!" << std::endl;
+        
+        std::cout << "Running trace sink tests..." << std::endl;
+        testTraceSink();
+        std::cout << "Trace sink tests passed!" << std::endl;
+        
+        std::cout << "Running wire format tests..." << std::endl;
+        testWireFormat();
+        std::cout << "Wire format tests passed!" << std::endl;
+        
+        std::cout << "Running route discovery tests..." << std::endl;
+        testRouteDiscovery();
+        std::cout << "Route discovery tests passed!" << std::endl;
+        
+        std::cout << "Running secure exchange tests..." << std::endl;
+        testSecureExchange();
+        std::cout << "Secure exchange tests passed!" << std::endl;
+        
+        std::cout << "Running simulated clock tests..." << std::endl;
+        testSimulatedClock();
+        std::cout << "Simulated clock tests passed!" << std::endl;
+        
+        std::cout << "Running beacon control tests..." << std::endl;
+        testBeaconControl();
+        std::cout << "Beacon control tests passed!" << std::endl;
+        
+        std::cout << "Running state migration tests..." << std::endl;
+        testStateMigration();
+        std::cout << "State migration tests passed!" << std::endl;
+        
+        std::cout << "Running trust cache tests..." << std::endl;
+        testTrustCache();
+        std::cout << "Trust cache tests passed!" << std::endl;
+        
+        std::cout << "Running black hole detection tests..." << std::endl;
+        testBlackHoleDetection();
+        std::cout << "Black hole detection tests passed!" << std::endl;
+        
         std::cout << "Running secure routing tests..." << std::endl;
         testSecureRouting();
         std::cout << "Secure routing tests passed!" << std::endl;